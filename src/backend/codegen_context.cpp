@@ -10,12 +10,32 @@ CodeGenContext::CodeGenContext(
 
 	m_context { std::make_unique<llvm::LLVMContext>() },
 	m_module{std::make_unique<llvm::Module>("toycc.expr", *m_context)},
-	m_builder{m_module->getContext()},
+	m_builder{m_module->getContext(),
+			  llvm::InstSimplifyFolder { m_module->getDataLayout() }},
 	m_type_mgr{std::make_unique<TypeMgr>(m_module->getContext(), tm.get())},
-	m_cvt_helper { std::make_unique<ConversionHelper>(cvt_config, *m_context) },
+	m_cvt_config { cvt_config },
+	m_cvt_helper { std::make_unique<ConversionHelper>(
+		cvt_config, *m_context,
+		m_type_mgr->get_info(TypeId::ty_slong).bit_width) },
 	m_src_mgr{src_mgr}, m_target_machine{tm}, m_logger{logger},
-	m_global_table { std::make_unique<GlobalSymbolTable>() }
-{}
+	m_global_table { std::make_unique<GlobalSymbolTable>() },
+	m_diag_mutex { std::make_shared<std::mutex>() }
+{
+	// 折叠器持有模块DataLayout的引用, 之后的修改对其可见
+	if (tm != nullptr)
+	{
+		m_module->setDataLayout(tm->createDataLayout());
+		m_module->setTargetTriple(tm->getTargetTriple().str());
+	}
+}
+
+auto CodeGenContext::fork() const -> std::shared_ptr<CodeGenContext>
+{
+	auto result = std::make_shared<CodeGenContext>(m_cvt_config, m_src_mgr,
+												   m_target_machine, m_logger);
+	result->m_diag_mutex = m_diag_mutex;
+	return result;
+}
 
 #define CGI_GETTER(func_name, return_type)                                     \
 	auto CGContextInterface::func_name() -> return_type                        \
@@ -25,12 +45,13 @@ CodeGenContext::CodeGenContext(
 
 CGI_GETTER(get_llvm_context, llvm::LLVMContext&)
 CGI_GETTER(get_module, llvm::Module*)
-CGI_GETTER(get_builder, llvm::IRBuilder<>&)
+CGI_GETTER(get_builder, Builder&)
 CGI_GETTER(get_cvt_helper, ConversionHelper&)
 CGI_GETTER(get_src_mgr, llvm::SourceMgr&)
 CGI_GETTER(get_logger, spdlog::async_logger&)
 CGI_GETTER(get_result, std::unique_ptr<llvm::Module>)
 CGI_GETTER(get_type_mgr, TypeMgr&)
 CGI_GETTER(get_global_table, GlobalSymbolTable*)
+CGI_GETTER(get_diag_mutex, std::mutex&)
 
 }	//namespace toycc
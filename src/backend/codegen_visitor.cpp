@@ -1,10 +1,17 @@
 #include "codegen_visitor.hpp"
 
+#include <algorithm>
 #include <format>
+#include <limits>
 #include <print>
 
+#include <llvm/Analysis/ValueTracking.h>
 #include <llvm/Bitcode/BitcodeWriter.h>
 #include <llvm/CodeGen/CommandFlags.h>
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/STLExtras.h>
+#include <llvm/IR/CFG.h>
+#include <llvm/IR/InstIterator.h>
 #include <llvm/IR/IRPrintingPasses.h>
 #include <llvm/IR/Instructions.h>
 #include <llvm/IR/LegacyPassManager.h>
@@ -12,14 +19,31 @@
 #include <llvm/Support/Casting.h>
 #include <llvm/Support/FileSystem.h>
 #include <llvm/Transforms/Scalar.h>
+#include <llvm/Transforms/Utils/BasicBlockUtils.h>
 #include <llvm/IR/Constant.h>
+#include <llvm/IR/MDBuilder.h>
+#include <llvm/IR/Metadata.h>
+#include <llvm/Support/MathExtras.h>
+#include "value_range.hpp"
 
 namespace toycc
 {
 
 CodeGenVisitor::CodeGenVisitor(std::shared_ptr<CodeGenContext> cg_context):
 	CGContextInterface { cg_context },
-	m_success { true }
+	m_success { true },
+	m_return_type { TypeId::ty_void },
+	m_body_begin { 0 },
+	m_body_end { std::numeric_limits<std::size_t>::max() },
+	m_func_def_count { 0 },
+	m_direct_ssa { false },
+	m_define_globals { true },
+	m_alloca_insert_pt { nullptr },
+	m_has_labels { false },
+	m_func_def { nullptr },
+	m_label_table { nullptr },
+	m_quiet_warnings { false },
+	m_const_evaluator { cg_context }
 {}
 
 auto CodeGenVisitor::visit(BaseAST* ast) -> bool
@@ -45,89 +69,322 @@ auto CodeGenVisitor::visit(BaseAST* ast) -> bool
 
 void CodeGenVisitor::handle(const CompUnit& node)
 {
-	
-	handle(node.get_module());
-	
+	std::vector<const FuncDef*> func_defs;
+	std::vector<const VarDecl*> var_decls;
+	std::vector<const StructDef*> struct_defs;
+	collect_definitions(node.get_module(), func_defs, var_decls, struct_defs);
+	m_func_def_count = func_defs.size();
+
+	// 并行生成的任务重复声明阶段, 其中的警告已经由声明阶段的visitor报告;
+	// 声明阶段有错误时不会生成函数体
+	m_quiet_warnings = !m_define_globals;
+	// 结构体先于所有变量和函数定义, 与其在源代码中的位置无关
+	for (const auto* struct_def : struct_defs)
+		declare(*struct_def);
+	for (const auto* struct_def : struct_defs)
+		handle(*struct_def);
+	// 声明阶段, 函数体中可以访问任意位置的全局变量;
+	// 函数先于全局变量声明, 全局变量的初始值可以调用eval函数
+	std::vector<llvm::Function*> funcs;
+	funcs.reserve(func_defs.size());
+	for (const auto* func_def : func_defs)
+		funcs.push_back(declare(*func_def));
+	for (const auto* var_decl : var_decls)
+		declare(*var_decl);
+	m_quiet_warnings = false;
+
+	// 之后只进行查询
+	get_global_table()->freeze();
+
+	// 函数体生成阶段, 每个函数相互独立
+	auto end = std::min(m_body_end, func_defs.size());
+	for (std::size_t i = m_body_begin; i < end; ++i)
+	{
+		if (funcs[i] == nullptr)
+			continue;
+		handle(*func_defs[i], funcs[i]);
+	}
 }
 
-void CodeGenVisitor::handle(const Module& node)
+void CodeGenVisitor::collect_definitions(const Module& node,
+										 std::vector<const FuncDef*>& func_defs,
+										 std::vector<const VarDecl*>& var_decls,
+										 std::vector<const StructDef*>& struct_defs)
 {
-	
+	if (node.has_next_module())
+		collect_definitions(node.get_module(), func_defs, var_decls,
+							struct_defs);
+
 	switch(node.get_type())
 	{
 	case Module::extern_func:
-		if (node.has_next_module())
-			handle(node.get_module());
-		handle(node.get_func_def());
+		func_defs.push_back(&node.get_func_def());
 		break;
 	case Module::extern_global_variable:
-		if (node.has_next_module())
-			handle(node.get_module());
-		handle(node.get_module());
+		var_decls.push_back(&node.get_var_decl());
+		break;
+	case Module::struct_def:
+		struct_defs.push_back(&node.get_struct_def());
 		break;
 	default:
 		assert(false && "Unsupport");
 	}
-	
 }
 
-void CodeGenVisitor::handle(const FuncDef& node)
+void CodeGenVisitor::declare(const StructDef& node)
+{
+	auto name = handle(node.get_ident());
+	if (get_type_mgr().find_struct(name))
+	{
+		report_in_ast(node.get_ident(), Location::dk_error,
+					  std::format("Redefinition of 'struct {}'", name));
+		return;
+	}
+	get_type_mgr().create_struct(name);
+}
+
+void CodeGenVisitor::handle(const StructDef& node)
+{
+	auto& type_mgr = get_type_mgr();
+	auto struct_type = *type_mgr.find_struct(handle(node.get_ident()));
+	// 重复定义的结构体已经在声明时报错
+	if (type_mgr.is_complete(struct_type))
+		return;
+
+	// 成员数组的大小只能引用全局作用域中的符号
+	LocalSymbolTable table { nullptr, get_global_table() };
+	std::vector<StructField> fields;
+	auto add_field = [&](const VarDef& var_def, TypeId type) {
+		auto name = handle(var_def.get_ident());
+		if (var_def.is_pointer())
+			type = handle(var_def.get_pointer(), type);
+		if (var_def.is_array())
+		{
+			auto array_type = handle(var_def.get_dims(), type, false, table);
+			if (!array_type)
+				return;
+			type = *array_type;
+		}
+		if (!type_mgr.is_complete(type))
+		{
+			report_in_ast(var_def, Location::dk_error,
+				std::format("Field has incomplete type '{}'",
+							type_mgr.get_name(type)));
+			return;
+		}
+		if (std::ranges::find(fields, name, &StructField::name) != fields.end())
+		{
+			report_in_ast(var_def, Location::dk_error,
+						  std::format("Duplicate member '{}'", name));
+			return;
+		}
+		if (var_def.is_initialized())
+		{
+			report_in_ast(var_def.get_init_val(), Location::dk_error,
+				std::format("Field '{}' cannot have an initializer", name));
+			return;
+		}
+		if (var_def.has_attribute())
+		{
+			report_in_ast(var_def.get_attribute(), Location::dk_warning,
+				std::format("Attribute on field '{}' ignored", name));
+		}
+		fields.push_back({ .name = std::string { name }, .type = type });
+	};
+	for (const auto& var_decl : node.get_fields())
+	{
+		auto type = handle(var_decl->get_scalar_type());
+		if (type == TypeId::ty_void)
+			continue;
+		add_field(var_decl->get_var_def(), type);
+		for (const auto& var_def : var_decl->get_var_def_list())
+			add_field(*var_def, type);
+	}
+
+	bool packed = false;
+	bool reorder = false;
+	for (const auto& attribute : node.get_attributes())
+	{
+		auto name = handle(attribute->get_name());
+		if (name == "packed")
+			packed = true;
+		else if (name == "reorder")
+			reorder = true;
+		else
+			report_in_ast(*attribute, Location::dk_warning,
+						  std::format("Unknown attribute '{}' ignored", name));
+	}
+	type_mgr.set_struct_body(struct_type, std::move(fields), packed, reorder);
+}
+
+auto CodeGenVisitor::declare(const FuncDef& node) -> llvm::Function*
 {
 	auto return_type = handle(node.get_type());
+	if (return_type == TypeId::ty_void && node.get_type().is_struct())
+		return nullptr;
+	if (node.returns_pointer())
+		return_type = handle(node.get_return_pointer(), return_type);
+	else if (get_type_mgr().is_struct(return_type))
+	{
+		report_in_ast(node.get_type(), Location::dk_error,
+					  "Returning a structure by value is not supported");
+		return nullptr;
+	}
 	auto func_name = handle(node.get_ident());
-	auto [ param_names, param_types ] = handle(node.get_paramlist());
+	// 参数中数组的大小只能引用全局作用域中的符号
+	LocalSymbolTable table { nullptr, get_global_table() };
+	auto [ param_names, param_types ] = handle(node.get_paramlist(), table);
+	if (std::ranges::find(param_types, TypeId::ty_void) != param_types.end())
+		return nullptr;
+	// eval函数在编译期以APInt解释执行, 只能使用整数标量
+	if (node.is_eval())
+	{
+		auto is_integer = [](TypeId type) {
+			return type == TypeId::ty_sint || type == TypeId::ty_uint;
+		};
+		if (!is_integer(return_type))
+		{
+			report_in_ast(node.get_type(), Location::dk_error,
+				std::format("Eval function cannot return '{}'",
+							get_type_mgr().get_name(return_type)));
+			return nullptr;
+		}
+		for (std::size_t i = 0; const auto& param : node.get_paramlist())
+		{
+			if (!is_integer(param_types[i++]))
+			{
+				report_in_ast(*param, Location::dk_error,
+					"Parameters of an eval function must have integer type");
+				return nullptr;
+			}
+		}
+	}
+	std::vector<llvm::Type*> param_llvm_types;
+	param_llvm_types.reserve(param_types.size());
+	for (auto type : param_types)
+		param_llvm_types.push_back(get_type_mgr().get_llvm_type(type));
+
+	if (get_global_table()->find_ptr(func_name) != nullptr)
+	{
+		report_in_ast(node, Location::dk_error,
+					  std::format("Function {} has been defined", func_name));
+		return nullptr;
+	}
 																	/* 不是可变类型 */
-	auto func_type = llvm::FunctionType::get(return_type, param_types, false);
+	auto func_type = llvm::FunctionType::get(
+		get_type_mgr().get_llvm_type(return_type), param_llvm_types, false);
 
 	auto func =
 		llvm::Function::Create(func_type, llvm::GlobalValue::ExternalLinkage,
 							   func_name, get_module());
 
-	create_basic_block(node.get_block(), func, "entry", param_names);
+	for (std::size_t i = 0; i < param_names.size(); ++i)
+		func->getArg(i)->setName(param_names[i]);
+	// 数组参数的restrict作用于元素, 不修饰参数本身
+	for (unsigned i = 0; const auto& param : node.get_paramlist())
+	{
+		if (param->is_pointer() && !param->is_array()
+			&& param->get_pointer().is_restrict())
+			func->addParamAttr(i, llvm::Attribute::NoAlias);
+		++i;
+	}
+
+	auto entry = std::make_shared<SymbolEntry>(SymbolEntry::func_value, func);
+	entry->type_id = return_type;
+	entry->param_type_ids = std::move(param_types);
+	auto success = get_global_table()->insert(func_name, entry);
+	assert(success);
+	(void)success;
+	if (node.is_eval())
+		m_const_evaluator.add_eval_function(func_name, node);
+
+	return func;
+}
 
+void CodeGenVisitor::handle(const FuncDef& node, llvm::Function* func)
+{
+	// 参数类型在声明阶段已经求出, 不再重复报告数组大小的错误
+	std::vector<std::string_view> param_names;
+	for (const auto& param : node.get_paramlist())
+		param_names.push_back(handle(param->get_ident()));
+	auto func_entry = get_global_table()->find_ptr(handle(node.get_ident()));
+	m_return_type = func_entry->type_id;
+	m_has_labels = node.has_labels();
+	m_func_def = &node;
+	create_basic_block(node.get_block(), func, "entry", param_names,
+					   func_entry->param_type_ids);
+	m_func_def = nullptr;
 }
 
-auto CodeGenVisitor::handle(const BuiltinType& node) -> llvm::Type*
+auto CodeGenVisitor::handle(const BuiltinType& node) -> TypeId
 {
-	llvm::Type* ret;
+	TypeId ret;
 	switch(node.get_type())
 	{
 	case toycc::BuiltinTypeEnum::ty_signed_int:
-		ret = get_type_mgr().get_signed_int();
+		ret = TypeId::ty_sint;
 		break;
 	case toycc::BuiltinTypeEnum::ty_unsigned_int:
-		ret = get_type_mgr().get_unsigned_int();
+		ret = TypeId::ty_uint;
 		break;
 	case toycc::BuiltinTypeEnum::ty_void:
-		ret = get_type_mgr().get_void();
+		ret = TypeId::ty_void;
 		break;
+	case toycc::BuiltinTypeEnum::ty_struct:
+		return find_struct(node.get_struct_name(), node);
 	default:
-		assert(false &&"toycc::Type to llvm::Type*");
+		assert(false &&"toycc::Type to TypeId");
 	}
 
+	if (node.is_vector())
+		ret = get_type_mgr().get_vector(ret, node.get_lanes());
 	return ret;
 }
 
-auto CodeGenVisitor::handle(const ScalarType& node) -> llvm::Type*
+auto CodeGenVisitor::handle(const ScalarType& node) -> TypeId
 {
 	
-	llvm::Type* ret;
+	TypeId ret;
 	switch(node.get_type())
 	{
 	case toycc::BuiltinTypeEnum::ty_signed_int:
-		ret = get_type_mgr().get_signed_int();
+		ret = TypeId::ty_sint;
 		break;
 	case toycc::BuiltinTypeEnum::ty_unsigned_int:
-		ret = get_type_mgr().get_unsigned_int();
+		ret = TypeId::ty_uint;
 		break;
+	case toycc::BuiltinTypeEnum::ty_struct:
+		return find_struct(node.get_struct_name(), node);
 	default:
 		assert(false && "Unkown TypeEnum int toycc::Type when handling "
-			  "toycc::Type to llvm::Type*");
+			  "toycc::Type to TypeId");
 	}
 	
+	if (node.is_vector())
+		ret = get_type_mgr().get_vector(ret, node.get_lanes());
 	return ret;
 }
 
+auto CodeGenVisitor::find_struct(std::string_view name, const BaseAST& node)
+	-> TypeId
+{
+	auto type = get_type_mgr().find_struct(name);
+	if (!type)
+	{
+		report_in_ast(node, Location::dk_error,
+					  std::format("Unknown type 'struct {}'", name));
+		return TypeId::ty_void;
+	}
+	return *type;
+}
+
+
+auto CodeGenVisitor::handle(const Pointer& node, TypeId pointee) -> TypeId
+{
+	for (std::size_t i = 0; i < node.get_depth(); ++i)
+		pointee = get_type_mgr().get_pointer(pointee);
+	return pointee;
+}
 
 auto CodeGenVisitor::handle(const Ident& node) -> std::string_view
 {
@@ -135,11 +392,11 @@ auto CodeGenVisitor::handle(const Ident& node) -> std::string_view
 	return name;
 }
 
-auto CodeGenVisitor::handle(const ParamList& node)
-		-> std::pair<std::vector<std::string_view>, std::vector<llvm::Type*>>
+auto CodeGenVisitor::handle(const ParamList& node, LocalSymbolTable& table)
+		-> std::pair<std::vector<std::string_view>, std::vector<TypeId>>
 {
 	std::vector<std::string_view> names;
-	std::vector<llvm::Type*> type_list;
+	std::vector<TypeId> type_list;
 
 	type_list.reserve(node.get_params().size());
 	names.reserve(node.get_params().size());
@@ -147,7 +404,7 @@ auto CodeGenVisitor::handle(const ParamList& node)
 	for (const auto& param : node)
 	{
 		assert(param != nullptr);
-		auto [name, type] = handle(*param);
+		auto [name, type] = handle(*param, table);
 		names.push_back(name);
 		type_list.push_back(type);
 	}
@@ -157,7 +414,8 @@ auto CodeGenVisitor::handle(const ParamList& node)
 
 auto CodeGenVisitor::create_basic_block(const Block& node, llvm::Function* func,
 										std::string_view block_name,
-										std::span<std::string_view> param_names)
+										std::span<std::string_view> param_names,
+										std::span<const TypeId> param_types)
 	-> llvm::BasicBlock*
 {
 	auto basic_block =
@@ -175,16 +433,23 @@ auto CodeGenVisitor::create_basic_block(const Block& node, llvm::Function* func,
 	assert(args_itr == func->arg_end());
 	
 	get_builder().SetInsertPoint(basic_block);
+	// 所有alloca集中在入口块, 循环中声明的变量不会成为动态alloca,
+	// 也能被mem2reg/SROA提升
+	auto undef = llvm::UndefValue::get(get_builder().getInt32Ty());
+	m_alloca_insert_pt = new llvm::BitCastInst(undef, undef->getType(),
+											   "allocapt", basic_block);
+	if (m_direct_ssa)
+		m_ssa_builder = std::make_unique<SSABuilder>();
+	// 入口块没有前驱
+	seal_block(basic_block);
 
 	// 局部符号表
 	LocalSymbolTable table(func, get_global_table());
 
 	for (std::size_t i = 0; i < param_names.size(); ++i)
 	{
-		llvm::Type* type = arg_values[i]->getType();
-		llvm::AllocaInst* alloca = get_builder().CreateAlloca(type);
-		get_builder().CreateStore(arg_values[i], alloca);
-		auto entry = std::make_shared<SymbolEntry>(alloca);
+		auto entry = create_local(param_types[i], param_names[i]);
+		write_local(*entry, arg_values[i]);
 		table.insert(param_names[i], entry);
 	}
 
@@ -198,31 +463,145 @@ auto CodeGenVisitor::create_basic_block(const Block& node, llvm::Function* func,
 		{
 			get_builder().CreateRetVoid();
 		}
-		else if (func->getReturnType() == get_type_mgr().get_signed_int())
+		else
 		{
-			llvm::Value* default_ret = llvm::Constant::getNullValue(get_type_mgr().get_signed_int());
+			llvm::Value* default_ret =
+				llvm::Constant::getNullValue(func->getReturnType());
 			get_builder().CreateRet(default_ret);
 		}
-		else
+	}
+	finish_labels(func);
+
+	m_alloca_insert_pt->eraseFromParent();
+	m_alloca_insert_pt = nullptr;
+	// 函数作用域的变量在返回时自然结束, 不需要lifetime.end
+	m_scope_allocas.clear();
+
+	if (m_ssa_builder)
+	{
+		// 出错提前返回时可能留下未封闭的基本块
+		m_ssa_builder->seal_remaining(func);
+		m_ssa_builder.reset();
+	}
+	// 静态不可达的代码生成在没有前驱的块中, 只用于报告其中的错误
+	llvm::EliminateUnreachableBlocks(*func);
+	set_alias_scopes(func);
+
+	return basic_block;
+}
+
+void CodeGenVisitor::set_alias_scopes(llvm::Function* func)
+{
+	std::vector<llvm::Argument*> params;
+	for (auto& arg : func->args())
+	{
+		if (arg.hasNoAliasAttr())
+			params.push_back(&arg);
+	}
+	if (params.empty())
+		return;
+
+	// 与clang内联noalias参数时相同, 每个函数一个域, 每个参数一个作用域
+	llvm::MDBuilder md_builder { get_llvm_context() };
+	auto domain = md_builder.createAnonymousAliasScopeDomain(func->getName());
+	std::vector<llvm::Metadata*> scopes;
+	scopes.reserve(params.size());
+	for (auto param : params)
+	{
+		auto name = (func->getName() + ": %" + param->getName()).str();
+		scopes.push_back(md_builder.createAnonymousAliasScope(domain, name));
+	}
+
+	// 以访问地址的基对象为键, 值为alias.scope和noalias
+	llvm::DenseMap<const llvm::Value*, std::pair<llvm::MDNode*, llvm::MDNode*>>
+		bases;
+	for (std::size_t i = 0; i < params.size(); ++i)
+	{
+		std::vector<llvm::Metadata*> others;
+		others.reserve(scopes.size() - 1);
+		for (std::size_t j = 0; j < scopes.size(); ++j)
+		{
+			if (j != i)
+				others.push_back(scopes[j]);
+		}
+		std::pair scope_lists {
+			llvm::MDNode::get(get_llvm_context(), scopes[i]),
+			others.empty() ? nullptr
+						   : llvm::MDNode::get(get_llvm_context(), others)
+		};
+		bases[params[i]] = scope_lists;
+
+		// 非SSA模式下参数保存在alloca中, 只写入过参数本身时读出的值就是参数
+		for (auto user : params[i]->users())
 		{
-			assert(false && "Unsupport return type");
+			auto store = llvm::dyn_cast<llvm::StoreInst>(user);
+			if (store == nullptr || store->getValueOperand() != params[i])
+				continue;
+			auto alloca_inst =
+				llvm::dyn_cast<llvm::AllocaInst>(store->getPointerOperand());
+			if (alloca_inst == nullptr)
+				continue;
+			auto only_loaded = llvm::all_of(alloca_inst->users(),
+				[&](const llvm::User* alloca_user) {
+					return alloca_user == store
+						|| llvm::isa<llvm::LoadInst>(alloca_user);
+				});
+			if (!only_loaded)
+				continue;
+			for (auto alloca_user : alloca_inst->users())
+			{
+				if (alloca_user != store)
+					bases[alloca_user] = scope_lists;
+			}
 		}
 	}
 
-	return basic_block;
+	for (auto& inst : llvm::instructions(func))
+	{
+		auto address = llvm::getLoadStorePointerOperand(&inst);
+		if (address == nullptr)
+			continue;
+		auto itr = bases.find(llvm::getUnderlyingObject(address));
+		if (itr == bases.end())
+			continue;
+		inst.setMetadata(llvm::LLVMContext::MD_alias_scope, itr->second.first);
+		if (itr->second.second != nullptr)
+			inst.setMetadata(llvm::LLVMContext::MD_noalias, itr->second.second);
+	}
 }
 
 void CodeGenVisitor::handle(const Block& node, LocalSymbolTable& upper_table)
 {
 	LocalSymbolTable table { &upper_table };
+	auto scope_begin = m_scope_allocas.size();
 	handle(node.get_block_item_list(), table);
+	end_lifetimes(scope_begin);
 }
 
 void CodeGenVisitor::handle(const BlockItemList& node, LocalSymbolTable& table)
 {
+	bool warned = false;
 	for (const auto& block_item : node)
 	{
 		assert(block_item != nullptr);
+		// 带标号的语句可以从switch跳转到达
+		if (is_terminated() && !is_labeled(*block_item))
+		{
+			if (!warned)
+			{
+				report_in_ast(*block_item, Location::dk_warning,
+							  "Code will never be executed");
+				warned = true;
+			}
+			// 之后的语句没有前驱, 仍然在没有前驱的块中生成以报告其中的错误,
+			// 其中也可能嵌套case标号, 函数结束时删除
+			auto unreachable = llvm::BasicBlock::Create(get_llvm_context(),
+				"unreachable", get_builder().GetInsertBlock()->getParent());
+			seal_block(unreachable);
+			get_builder().SetInsertPoint(unreachable);
+		}
+		else if (!is_terminated())
+			warned = false;
 		handle(*block_item, table);
 	}
 }
@@ -248,34 +627,62 @@ void CodeGenVisitor::handle(const SimpleStmt& node, LocalSymbolTable& table)
 	{
 	case SimpleStmt::assign:
 	{
-		auto left_entry = handle(node.get_lval(), table);
-		if (!left_entry)
+		const auto& lval = node.get_lval();
+		std::shared_ptr<SymbolEntry> left_entry;
+		if (lval.is_named())
 		{
-			get_logger().info("Error happens in Lval");
-			return;
+			left_entry = handle(lval, table);
+			if (!left_entry)
+			{
+				get_logger().info("Error happens in Lval");
+				return;
+			}
+			if (left_entry->type == SymbolEntry::eval_value
+				&& (!lval.has_indices()
+					|| is_vector_lane(lval, left_entry.get()))) [[unlikely]]
+			{
+				report_in_ast(node, Location::DiagKind::dk_error,
+							  "An eval value cannot be assigned");
+				break;
+			}
+			if (is_vector_lane(lval, left_entry.get()))
+			{
+				emit_lane_write(lval, *left_entry, node.get_expr(), table);
+				break;
+			}
 		}
 
-		llvm::Value* right_value = handle(node.get_expr(), table);
-
-		if (left_entry->type != SymbolEntry::alloca_value) [[unlikely]]
+		// 数组元素, 成员, 解引用和全局变量通过地址写入
+		TypedValue address;
+		if (is_in_memory(lval, left_entry.get()))
 		{
-			report_in_ast(node, Location::DiagKind::dk_error,
-						  "An eval value cannot be assigned");
-			break;
+			address = emit_address(lval, left_entry.get(), table);
+			if (address == nullptr)
+				break;
 		}
-
-		if (left_entry == nullptr) [[unlikely]]
+		auto left_type = address ? address.type : left_entry->type_id;
+		if (get_type_mgr().is_array(left_type)) [[unlikely]]
 		{
-			get_logger().info("User Error occured in Stmt::assign left value");
+			report_in_ast(node, Location::DiagKind::dk_error,
+				std::format("Array type '{}' is not assignable",
+							get_type_mgr().get_name(left_type)));
 			break;
 		}
+
+		auto right_value = handle(node.get_expr(), table);
 		if (right_value == nullptr) [[unlikely]]
 		{
 			get_logger().info("User Error occured in Stmt::assign right value");
 			break;
 		}
 
-		get_builder().CreateStore(right_value, left_entry->alloca);
+		right_value = convert_to(right_value, left_type, node);
+		if (right_value == nullptr)
+			break;
+		if (address)
+			create_store(left_type, right_value.value, address.value);
+		else
+			write_local(*left_entry, right_value.value);
 		
 		break;
 	}
@@ -311,8 +718,43 @@ void CodeGenVisitor::handle(const SimpleStmt& node, LocalSymbolTable& table)
 		if (value == nullptr)
 		{
 			get_logger().info("User Error occured in Stmt::func_return");
+			break;
+		}
+		value = convert_to(value, m_return_type, node);
+		if (value == nullptr)
+			break;
+		get_builder().CreateRet(value.value);
+		break;
+	}
+	case SimpleStmt::jump_goto:
+		get_builder().CreateBr(
+			get_label(node.get_label().get_value(), node).block);
+		break;
+	case SimpleStmt::computed_goto:
+		emit_computed_goto(node.get_expr(), table);
+		break;
+	case SimpleStmt::loop_break:
+	case SimpleStmt::loop_continue:
+	{
+		auto is_break = node.get_type() == SimpleStmt::loop_break;
+		// break跳出最内层的循环或switch, continue跳过其中的switch
+		auto target_it = is_break ? m_jump_targets.rbegin()
+			: std::ranges::find_if(m_jump_targets.rbegin(),
+				m_jump_targets.rend(), [](const JumpTarget& target) {
+					return target.continue_block != nullptr;
+				});
+		if (target_it == m_jump_targets.rend())
+		{
+			report_in_ast(node, Location::DiagKind::dk_error,
+						  is_break ? "'break' statement not in loop or switch statement"
+								   : "'continue' statement not in loop statement");
+			break;
 		}
-		get_builder().CreateRet(value);
+		const auto& target = *target_it;
+		// 跳出的作用域中声明的变量不再存活
+		emit_lifetime_ends(target.scope_begin);
+		get_builder().CreateBr(is_break ? target.break_block
+										: target.continue_block);
 		break;
 	}
 	default:
@@ -325,78 +767,108 @@ template <typename OpenOrClosedStmt>
 auto CodeGenVisitor::handle_branch_stmt(
 	const BranchStmt<OpenOrClosedStmt>& node, LocalSymbolTable& table) -> llvm::BasicBlock*
 {
-	auto create_br_to_next = [this](llvm::BasicBlock* next) {
-		auto* curr_block = get_builder().GetInsertBlock();
-		if (!curr_block->getTerminator())
-		{
-			get_builder().CreateBr(next);
-		}
-	};
+	auto func = table.get_func();
 	switch(node.get_type())
 	{
 	case BranchType::if_stmt: 
 		assert(node.get_kind() == BaseAST::ast_open_stmt);
 	case BranchType::if_else_stmt:  {
 		llvm::BasicBlock* if_then = llvm::BasicBlock::Create(
-			get_module()->getContext(), "if_then", table.get_func());
-		llvm::BasicBlock* if_end = llvm::BasicBlock::Create(
-			get_module()->getContext(), "if_end", table.get_func());
+			get_module()->getContext(), "if_then", func);
+		llvm::BasicBlock* if_end = nullptr;
+		// 不可达的分支同样生成以报告错误, 没有可达的分支落空时不创建if_end
+		auto emit_arm = [&](llvm::BasicBlock* block, auto&& emit_stmt) {
+			auto reachable = begin_block(block);
+			emit_stmt();
+			if (is_terminated())
+				return;
+			if (!reachable)
+			{
+				get_builder().CreateUnreachable();
+				return;
+			}
+			if (if_end == nullptr)
+			{
+				if_end = llvm::BasicBlock::Create(get_module()->getContext(),
+												  "if_end", func);
+			}
+			get_builder().CreateBr(if_end);
+		};
 
-		llvm::Value* cmp = handle(node.get_expr(), table);
-		// 检测变量类型是否能够转换为bool
-		if (!get_cvt_helper().convert_to_bool(cmp->getType()))
-		{
-			report_in_ast(node, Location::DiagKind::dk_error, "Cannot convert to bool");
-			return nullptr;
-		}
 		if (node.get_type() == BranchType::if_stmt)
 		{
-			get_builder().CreateCondBr(cmp, if_then, if_end);
-			get_builder().SetInsertPoint(if_then);
-				auto* open_stmt = llvm::cast<OpenStmt>(&node);
+			if_end = llvm::BasicBlock::Create(get_module()->getContext(),
+											  "if_end", func);
+			if (!emit_cond_branch(node.get_expr(), if_then, if_end, table))
+				return nullptr;
+			auto* open_stmt = llvm::cast<OpenStmt>(&node);
 			static_assert(std::is_same_v<decltype(open_stmt), const OpenStmt*>);
-			handle(open_stmt->get_stmt(), table);
+			emit_arm(if_then, [&] { handle(open_stmt->get_stmt(), table); });
 		}
 		else
 		{
 			llvm::BasicBlock* if_else = llvm::BasicBlock::Create(
-				get_module()->getContext(), "else", table.get_func());
-			get_builder().CreateCondBr(cmp, if_then, if_else);
-			get_builder().SetInsertPoint(if_then);
-			handle_branch_stmt(node.get_first_stmt(), table);
-			if (!get_builder().GetInsertBlock()->getTerminator())
-				get_builder().CreateBr(if_end);
-			get_builder().SetInsertPoint(if_else);
-			handle_branch_stmt(node.get_last_stmt(), table);
-
-		}
-		create_br_to_next(if_end);
-		get_builder().SetInsertPoint(if_end);
+				get_module()->getContext(), "else", func);
+			if (!emit_cond_branch(node.get_expr(), if_then, if_else, table))
+				return nullptr;
+			emit_arm(if_then, [&] {
+				handle_branch_stmt(node.get_first_stmt(), table);
+			});
+			emit_arm(if_else, [&] {
+				handle_branch_stmt(node.get_last_stmt(), table);
+			});
+		}
+
+		// 两个分支都不落空时, 之后的代码不可达
+		if (if_end == nullptr || !enter_block(if_end))
+			return nullptr;
 		return if_end;
 									}
 	case BranchType::while_stmt:
+		return emit_loop("while", &node.get_expr(), true,
+			node.get_loop_hints(),
+			[&] { handle_branch_stmt(node.get_last_stmt(), table); }, [] {},
+			table);
+	case BranchType::for_stmt:
 									{
-		llvm::BasicBlock* cond = llvm::BasicBlock::Create(
-			get_module()->getContext(), "while_cond", table.get_func());
-		llvm::BasicBlock* body = llvm::BasicBlock::Create(
-			get_module()->getContext(), "while_body", table.get_func());
-		llvm::BasicBlock* end = llvm::BasicBlock::Create(
-			get_module()->getContext(), "while_end", table.get_func());
-
-		get_builder().CreateBr(cond);
-		// 条件判断 begin
-		get_builder().SetInsertPoint(cond);
-		llvm::Value* value = handle(node.get_expr(), table);
-		get_builder().CreateCondBr(value, body, end);
-		// 条件判断 end
-		// 循环体
-		get_builder().SetInsertPoint(body);
-		handle_branch_stmt(node.get_last_stmt(), table);
-		get_builder().CreateBr(cond);
-		// 循环体 end
-		get_builder().SetInsertPoint(end);
-		break;
+		const auto& clause = node.get_for_clause();
+		// 初始化部分声明的变量只在循环中可见
+		LocalSymbolTable for_table { &table };
+		auto scope_begin = m_scope_allocas.size();
+		if (clause.has_decl())
+			handle(clause.get_decl(), for_table);
+		else
+			handle(clause.get_init(), for_table);
+		auto next = emit_loop("for",
+			clause.has_cond() ? &clause.get_cond() : nullptr, true,
+			node.get_loop_hints(),
+			[&] { handle_branch_stmt(node.get_last_stmt(), for_table); },
+			[&] { handle(clause.get_step(), for_table); }, for_table);
+		end_lifetimes(scope_begin);
+		return next;
 									}
+	case BranchType::do_while_stmt:
+									{
+		assert(node.get_kind() == BaseAST::ast_closed_stmt);
+		auto* do_stmt = llvm::cast<ClosedStmt>(&node);
+		return emit_loop("do", &node.get_expr(), false,
+			node.get_loop_hints(),
+			[&] { handle(do_stmt->get_stmt(), table); }, [] {}, table);
+									}
+	case BranchType::switch_stmt:
+		return emit_switch(node, table);
+	case BranchType::case_stmt:
+	case BranchType::default_stmt:
+		if (!emit_case_label(node.get_type() == BranchType::case_stmt
+								 ? &node.get_expr() : nullptr,
+							 node, table)
+			&& is_terminated())
+			return nullptr;
+		return handle_branch_stmt(node.get_last_stmt(), table);
+	case BranchType::label_stmt:
+		if (!emit_label(node.get_label(), node) && is_terminated())
+			return nullptr;
+		return handle_branch_stmt(node.get_last_stmt(), table);
 	case BranchType::simple_stmt:
 									{
 		assert(node.get_kind() == BaseAST::ast_closed_stmt);
@@ -428,7 +900,7 @@ void CodeGenVisitor::handle(const Stmt& node, LocalSymbolTable& table)
 }
 
 auto CodeGenVisitor::handle(const Expr& node, LocalSymbolTable& table)
-	-> llvm::Value*
+	-> TypedValue
 {
 	
 	auto ret = handle(node.get_low_expr(), table);
@@ -437,30 +909,364 @@ auto CodeGenVisitor::handle(const Expr& node, LocalSymbolTable& table)
 	return ret;
 }
 
-auto CodeGenVisitor::handle(const PrimaryExpr& node, LocalSymbolTable& table)
+auto CodeGenVisitor::handle(const LOrExpr& node, LocalSymbolTable& table)
+	-> TypedValue
+{
+	if (node.has_higher_expr())
+		return handle(node.get_higher_expr(), table);
+
+	auto [left_expr, op, right_expr] = node.get_combined_expr();
+	// 左操作数为常量时, 结果为真或者只取决于右操作数
+	if (auto left = m_const_evaluator.evaluate(left_expr.get(), table))
+	{
+		if (!llvm::cast<llvm::ConstantInt>(left.value)->isZero())
+		{
+			emit_dead_code([&] {
+				(void)create_logical_operand(right_expr.get(), table);
+			});
+			return { get_builder().getTrue(), TypeId::ty_sint };
+		}
+		return create_logical_operand(right_expr.get(), table);
+	}
+
+	auto func = table.get_func();
+	auto rhs_block =
+		llvm::BasicBlock::Create(get_llvm_context(), "lor_rhs", func);
+	auto end_block =
+		llvm::BasicBlock::Create(get_llvm_context(), "lor_end", func);
+
+	// 左操作数为真时直接跳转到汇合块
+	if (!emit_cond_branch(left_expr.get(), end_block, rhs_block, table))
+		return nullptr;
+	seal_block(rhs_block);
+	get_builder().SetInsertPoint(rhs_block);
+
+	auto right = handle(right_expr.get(), table);
+	if (right == nullptr)
+		return nullptr;
+	auto right_bool = create_bool(right.value, right_expr.get());
+	if (right_bool == nullptr)
+		return nullptr;
+
+	return create_logical_phi(end_block, true, right_bool,
+							  get_builder().GetInsertBlock());
+}
+
+auto CodeGenVisitor::handle(const LAndExpr& node, LocalSymbolTable& table)
+	-> TypedValue
+{
+	if (node.has_higher_expr())
+		return handle(node.get_higher_expr(), table);
+
+	auto [left_expr, op, right_expr] = node.get_combined_expr();
+	if (auto left = m_const_evaluator.evaluate(left_expr.get(), table))
+	{
+		if (llvm::cast<llvm::ConstantInt>(left.value)->isZero())
+		{
+			emit_dead_code([&] {
+				(void)create_logical_operand(right_expr.get(), table);
+			});
+			return { get_builder().getFalse(), TypeId::ty_sint };
+		}
+		return create_logical_operand(right_expr.get(), table);
+	}
+
+	auto func = table.get_func();
+	auto rhs_block =
+		llvm::BasicBlock::Create(get_llvm_context(), "land_rhs", func);
+	auto end_block =
+		llvm::BasicBlock::Create(get_llvm_context(), "land_end", func);
+
+	// 左操作数为假时直接跳转到汇合块
+	if (!emit_cond_branch(left_expr.get(), rhs_block, end_block, table))
+		return nullptr;
+	seal_block(rhs_block);
+	get_builder().SetInsertPoint(rhs_block);
+
+	auto right = handle(right_expr.get(), table);
+	if (right == nullptr)
+		return nullptr;
+	auto right_bool = create_bool(right.value, right_expr.get());
+	if (right_bool == nullptr)
+		return nullptr;
+
+	return create_logical_phi(end_block, false, right_bool,
+							  get_builder().GetInsertBlock());
+}
+
+template <typename TExpr>
+auto CodeGenVisitor::create_logical_operand(const TExpr& node,
+											LocalSymbolTable& table)
+	-> TypedValue
+{
+	auto value = handle(node, table);
+	if (value == nullptr)
+		return nullptr;
+	auto cond = create_bool(value.value, node);
+	if (cond == nullptr)
+		return nullptr;
+	return { cond, TypeId::ty_sint };
+}
+
+auto CodeGenVisitor::create_logical_phi(llvm::BasicBlock* end_block,
+										bool short_circuit, llvm::Value* right,
+										llvm::BasicBlock* right_block)
+	-> TypedValue
+{
+	get_builder().CreateBr(end_block);
+	seal_block(end_block);
+	get_builder().SetInsertPoint(end_block);
+
+	// 除右操作数所在块外, 其余前驱都来自左操作数的短路跳转
+	auto short_value = get_builder().getInt1(short_circuit);
+	auto phi = get_builder().CreatePHI(get_builder().getInt1Ty(),
+									   llvm::pred_size(end_block));
+	for (auto pred : llvm::predecessors(end_block))
+		phi->addIncoming(pred == right_block ? right : short_value, pred);
+
+	return { phi, TypeId::ty_sint };
+}
+
+auto CodeGenVisitor::emit_cond_branch(const Expr& node,
+									  llvm::BasicBlock* true_block,
+									  llvm::BasicBlock* false_block,
+									  LocalSymbolTable& table) -> bool
+{
+	return emit_cond_branch(node.get_low_expr(), true_block, false_block,
+							table);
+}
+
+auto CodeGenVisitor::emit_cond_branch(const LOrExpr& node,
+									  llvm::BasicBlock* true_block,
+									  llvm::BasicBlock* false_block,
+									  LocalSymbolTable& table) -> bool
+{
+	if (node.has_higher_expr())
+	{
+		return emit_cond_branch(node.get_higher_expr(), true_block,
+								false_block, table);
+	}
+
+	auto [left_expr, op, right_expr] = node.get_combined_expr();
+	if (auto left = m_const_evaluator.evaluate(left_expr.get(), table))
+	{
+		if (llvm::cast<llvm::ConstantInt>(left.value)->isZero())
+			return emit_cond_branch(right_expr.get(), true_block, false_block,
+									table);
+		emit_dead_code([&] {
+			(void)create_logical_operand(right_expr.get(), table);
+		});
+		get_builder().CreateBr(true_block);
+		return true;
+	}
+
+	auto rhs_block = llvm::BasicBlock::Create(get_llvm_context(), "lor_rhs",
+											  table.get_func());
+	if (!emit_cond_branch(left_expr.get(), true_block, rhs_block, table))
+		return false;
+	seal_block(rhs_block);
+	get_builder().SetInsertPoint(rhs_block);
+	return emit_cond_branch(right_expr.get(), true_block, false_block, table);
+}
+
+auto CodeGenVisitor::emit_cond_branch(const LAndExpr& node,
+									  llvm::BasicBlock* true_block,
+									  llvm::BasicBlock* false_block,
+									  LocalSymbolTable& table) -> bool
+{
+	if (node.has_higher_expr())
+	{
+		return emit_cond_branch(node.get_higher_expr(), true_block,
+								false_block, table);
+	}
+
+	auto [left_expr, op, right_expr] = node.get_combined_expr();
+	if (auto left = m_const_evaluator.evaluate(left_expr.get(), table))
+	{
+		if (!llvm::cast<llvm::ConstantInt>(left.value)->isZero())
+			return emit_cond_branch(right_expr.get(), true_block, false_block,
+									table);
+		emit_dead_code([&] {
+			(void)create_logical_operand(right_expr.get(), table);
+		});
+		get_builder().CreateBr(false_block);
+		return true;
+	}
+
+	auto rhs_block = llvm::BasicBlock::Create(get_llvm_context(), "land_rhs",
+											  table.get_func());
+	if (!emit_cond_branch(left_expr.get(), rhs_block, false_block, table))
+		return false;
+	seal_block(rhs_block);
+	get_builder().SetInsertPoint(rhs_block);
+	return emit_cond_branch(right_expr.get(), true_block, false_block, table);
+}
+
+auto CodeGenVisitor::emit_cond_branch(const L7Expr& node,
+									  llvm::BasicBlock* true_block,
+									  llvm::BasicBlock* false_block,
+									  LocalSymbolTable& table) -> bool
+{
+	auto value = handle(node, table);
+	if (value == nullptr)
+		return false;
+	auto cond = create_bool(value.value, node);
+	if (cond == nullptr)
+		return false;
+
+	// 条件被折叠为常量时, 未选择的目标块不会获得前驱
+	if (auto constant = llvm::dyn_cast<llvm::ConstantInt>(cond))
+		get_builder().CreateBr(constant->isZero() ? false_block : true_block);
+	else
+		get_builder().CreateCondBr(cond, true_block, false_block);
+	return true;
+}
+
+auto CodeGenVisitor::create_bool(llvm::Value* value, const BaseAST& node)
 	-> llvm::Value*
 {
-	
+	auto type = value->getType();
+	// 检测变量类型是否能够转换为bool
+	if (!get_cvt_helper().convert_to_bool(type))
+	{
+		report_in_ast(node, Location::DiagKind::dk_error,
+					  "Cannot convert to bool");
+		return nullptr;
+	}
 
-	llvm::Value* result = nullptr;
-	if (node.has_expr())
+	if (type->isIntegerTy(1))
+		return value;
+	if (type->isFloatingPointTy())
 	{
-		result = handle(node.get_expr(), table);	
+		return get_builder().CreateFCmpUNE(value,
+										   llvm::ConstantFP::get(type, 0.0));
 	}
-	else if (node.has_ident())
+	// 数组退化得到的指针与空指针比较
+	return get_builder().CreateICmpNE(value, llvm::Constant::getNullValue(type));
+}
+
+auto CodeGenVisitor::to_integer(TypedValue value) -> TypedValue
+{
+	auto type = value->getType();
+	if (type->isVectorTy() && type->getScalarType()->isIntegerTy(1))
 	{
-		auto entry = handle(node.get_lval(), table);
+		return { get_builder().CreateSExt(
+					 value.value, get_type_mgr().get_llvm_type(value.type)),
+				 value.type };
+	}
+	if (!type->isIntegerTy(1))
+		return value;
+	// 比较和逻辑运算的结果为int
+	auto int_type = get_type_mgr().get_signed_int();
+	return { get_builder().CreateZExt(value.value, int_type), TypeId::ty_sint,
+			 get_range(value)->zeroExtend(int_type->getIntegerBitWidth()) };
+}
 
-		if (entry == nullptr)
+auto CodeGenVisitor::convert_to(TypedValue value, TypeId type,
+								const BaseAST& node) -> TypedValue
+{
+	value = to_integer(value);
+	// 指针和向量不在转换表中, 只能在相同类型之间传递
+	if (!is_builtin(value.type) || !is_builtin(type))
+	{
+		if (value.type == type)
+			return value;
+		if (get_type_mgr().is_vector(type) && is_builtin(value.type))
 		{
-			get_logger().info("User Error Occured in LVal");
+			const auto& info = get_type_mgr().get_info(type);
+			auto scalar = convert_to(value, info.element, node);
+			if (scalar == nullptr)
+				return nullptr;
+			return { get_builder().CreateVectorSplat(
+						 static_cast<unsigned>(info.count), scalar.value),
+					 type };
 		}
-		else
+		// 值为0的整数常量可以转换为任意指针
+		if (get_type_mgr().is_pointer(type) && is_null_pointer_constant(value))
 		{
-			result = entry->type == SymbolEntry::eval_value ?
-				entry->value :
-				get_builder().CreateLoad(entry->alloca->getAllocatedType(), entry->alloca);
+			auto llvm_type = get_type_mgr().get_llvm_type(type);
+			return { llvm::ConstantPointerNull::get(
+						 llvm::cast<llvm::PointerType>(llvm_type)),
+					 type };
 		}
+		report_in_ast(node, Location::dk_error,
+			std::format("Incompatible conversion from '{}' to '{}'",
+						get_type_mgr().get_name(value.type),
+						get_type_mgr().get_name(type)));
+		return nullptr;
+	}
+
+	auto range = get_range(value);
+	auto cvt_result = range
+		? get_cvt_helper().value_conversion(type, value.type, *range)
+		: get_cvt_helper().value_conversion(type, value.type);
+	if (!report_conversion_result(cvt_result, node))
+		return nullptr;
+
+	auto& builder = get_builder();
+	auto src_type = value->getType();
+	auto dest_type = get_type_mgr().get_llvm_type(type);
+	if (src_type == dest_type)
+		return { value.value, type, std::move(range) };
+
+	auto src_signed = get_type_mgr().is_signed(value.type);
+	if (!src_type->isIntegerTy())
+	{
+		if (dest_type->isFloatingPointTy())
+			return { builder.CreateFPCast(value.value, dest_type), type };
+		return { get_type_mgr().is_signed(type)
+					 ? builder.CreateFPToSI(value.value, dest_type)
+					 : builder.CreateFPToUI(value.value, dest_type),
+				 type };
+	}
+	if (dest_type->isFloatingPointTy())
+	{
+		return { src_signed ? builder.CreateSIToFP(value.value, dest_type)
+							: builder.CreateUIToFP(value.value, dest_type),
+				 type };
+	}
+
+	auto dest_width = dest_type->getIntegerBitWidth();
+	if (type == TypeId::ty_bool)
+	{
+		auto cond = create_bool(value.value, node);
+		if (cond == nullptr)
+			return nullptr;
+		return { builder.CreateZExt(cond, dest_type), type,
+				 llvm::ConstantRange { llvm::APInt(dest_width, 0),
+									   llvm::APInt(dest_width, 2) } };
+	}
+	if (dest_width < src_type->getIntegerBitWidth())
+	{
+		auto is_nuw = range->getUnsignedMax().isIntN(dest_width);
+		auto is_nsw = range->getSignedMin().isSignedIntN(dest_width)
+			&& range->getSignedMax().isSignedIntN(dest_width);
+		return { builder.CreateTrunc(value.value, dest_type, "", is_nuw, is_nsw),
+				 type, range->truncate(dest_width) };
+	}
+	// 非负值的符号扩展与零扩展相同, 省去sext
+	if (!src_signed || range->isAllNonNegative())
+	{
+		return { builder.CreateZExt(value.value, dest_type, "", src_signed),
+				 type, range->zeroExtend(dest_width) };
+	}
+	return { builder.CreateSExt(value.value, dest_type), type,
+			 range->signExtend(dest_width) };
+}
+
+auto CodeGenVisitor::handle(const PrimaryExpr& node, LocalSymbolTable& table)
+	-> TypedValue
+{
+	
+
+	TypedValue result;
+	if (node.has_expr())
+	{
+		result = handle(node.get_expr(), table);	
+	}
+	else if (node.has_ident())
+	{
+		result = emit_lval_read(node.get_lval(), table);
 	}
 	else if (node.has_number())
 	{
@@ -477,12 +1283,12 @@ auto CodeGenVisitor::handle(const PrimaryExpr& node, LocalSymbolTable& table)
 }
 
 auto CodeGenVisitor::handle(const UnaryExpr& node, LocalSymbolTable& table)
-	-> llvm::Value*
+	-> TypedValue
 {
-	static auto handle_func = [this](const UnaryExpr& node) -> llvm::Function*
+	auto handle_func = [this](const UnaryExpr& node) -> const SymbolEntry*
 	{
 		auto func_name = handle(node.get_ident());
-		auto entry = get_global_table()->find(func_name);
+		auto entry = get_global_table()->find_ptr(func_name);
 		if (!entry)
 		{
 			report_in_ast(node, Location::dk_error,
@@ -494,14 +1300,14 @@ auto CodeGenVisitor::handle(const UnaryExpr& node, LocalSymbolTable& table)
 			report_in_ast(
 				node, Location::dk_error,
 				std::format("Value {} is not a function type", func_name));
+			return nullptr;
 		}
-		llvm::Function* func = llvm::cast<llvm::Function>(entry->value);
-		return func;
+		return entry;
 	};
 
 	
 	
-	llvm::Value* result = nullptr;
+	TypedValue result;
 	switch(node.get_unary_type())
 	{
 	case UnaryExpr::primary_expr:
@@ -509,23 +1315,43 @@ auto CodeGenVisitor::handle(const UnaryExpr& node, LocalSymbolTable& table)
 		break;
 	case UnaryExpr::unary_op:
 		result = handle(node.get_unary_expr(), table);
+		if (result == nullptr)
+			return nullptr;
+		// !p与p == 0相同
+		if (node.get_unary_op().get_type() == UnaryOp::op_not
+			&& get_type_mgr().is_pointer(result.type))
+		{
+			result = { get_builder().CreateIsNull(result.value),
+					   TypeId::ty_sint };
+			break;
+		}
+		if (!is_builtin(result.type) && !get_type_mgr().is_vector(result.type))
+		{
+			report_in_ast(node, Location::dk_error,
+				std::format("Invalid argument type '{}' to unary expression",
+							get_type_mgr().get_name(result.type)));
+			return nullptr;
+		}
 		result = unary_operate(node.get_unary_op(), result);
 		break;
-	case UnaryExpr::call_with_params: {
-		auto func = handle_func(node);
-		if (!func)
-			return nullptr;
-		auto passing_list = handle(node.get_passing_params(), table);
-
-		get_builder().CreateCall(func, passing_list);
+	case UnaryExpr::label_address:
+		result = emit_label_address(node.get_ident(), node);
 		break;
-	}
-	case UnaryExpr::call: {
-		auto func = handle_func(node);
-		if (!func)
+	case UnaryExpr::address_of:
+		result = emit_address_of(node.get_lval(), table);
+		break;
+	case UnaryExpr::call:
+	case UnaryExpr::call_with_params: {
+		// 内建函数不在符号表中, 同名的用户函数被屏蔽
+		if (auto builtin = find_vector_builtin(handle(node.get_ident())))
+		{
+			result = handle_vector_builtin(node, *builtin, table);
+			break;
+		}
+		auto func_entry = handle_func(node);
+		if (!func_entry)
 			return nullptr;
-
-		get_builder().CreateCall(func);
+		result = handle_call(node, *func_entry, table);
 		break;
 	}
 	default:
@@ -537,11 +1363,280 @@ auto CodeGenVisitor::handle(const UnaryExpr& node, LocalSymbolTable& table)
 	return result;
 }
 
+auto CodeGenVisitor::handle_call(const UnaryExpr& node,
+								 const SymbolEntry& func_entry,
+								 LocalSymbolTable& table) -> TypedValue
+{
+	auto func = llvm::cast<llvm::Function>(func_entry.value);
+	std::vector<TypedValue> args;
+	if (node.get_unary_type() == UnaryExpr::call_with_params)
+	{
+		args = handle(node.get_passing_params(), table);
+		if (std::ranges::find(args, nullptr, &TypedValue::value) != args.end())
+		{
+			get_logger().info("Error happens in PassingParams");
+			return nullptr;
+		}
+	}
+
+	auto func_type = func->getFunctionType();
+	if (args.size() != func_type->getNumParams())
+	{
+		report_in_ast(node, Location::dk_error,
+			std::format("Function {} expects {} arguments, but {} provided",
+						func->getName().str(), func_type->getNumParams(),
+						args.size()));
+		return nullptr;
+	}
+
+	std::vector<llvm::Value*> arg_values;
+	arg_values.reserve(args.size());
+	for (std::size_t i = 0; i < args.size(); ++i)
+	{
+		args[i] = convert_to(args[i], func_entry.param_type_ids[i], node);
+		if (args[i] == nullptr)
+			return nullptr;
+		arg_values.push_back(args[i].value);
+	}
+
+	// 实参都是常量时在编译期求值eval函数, 求值失败时在运行时调用;
+	// 因超出上限而放弃时给出remark, 其他失败(如除以0)留到运行时
+	auto name = handle(node.get_ident());
+	if (m_const_evaluator.is_eval_function(name)
+		&& std::ranges::all_of(arg_values, [](llvm::Value* value) {
+			   return llvm::isa<llvm::ConstantInt>(value);
+		   }))
+	{
+		if (auto result = m_const_evaluator.try_fold(name, args, node))
+			return result;
+		auto failure = m_const_evaluator.take_failure();
+		if (failure && failure->limit_exceeded)
+		{
+			report_in_ast(node, Location::dk_remark,
+				std::format("Call to eval function '{}' is not folded: {}",
+							name, failure->message));
+		}
+	}
+
+	return { get_builder().CreateCall(func, arg_values), func_entry.type_id };
+}
+
+auto CodeGenVisitor::find_vector_builtin(std::string_view name)
+	-> std::optional<VectorBuiltin>
+{
+#define VECTOR_BUILTIN(id, builtin_name)                                      \
+	if (name == builtin_name)                                                  \
+		return VectorBuiltin::id;
+#include "builtin.def"
+	return std::nullopt;
+}
+
+auto CodeGenVisitor::handle_vector_builtin(const UnaryExpr& node,
+										   VectorBuiltin builtin,
+										   LocalSymbolTable& table)
+	-> TypedValue
+{
+	auto& type_mgr = get_type_mgr();
+	auto& builder = get_builder();
+	auto name = handle(node.get_ident());
+	std::vector<TypedValue> args;
+	if (node.get_unary_type() == UnaryExpr::call_with_params)
+	{
+		args = handle(node.get_passing_params(), table);
+		if (std::ranges::find(args, nullptr, &TypedValue::value) != args.end())
+		{
+			get_logger().info("Error happens in PassingParams");
+			return nullptr;
+		}
+	}
+
+	auto check_arg_count = [&](std::size_t count) {
+		if (args.size() == count)
+			return true;
+		report_in_ast(node, Location::dk_error,
+			std::format("Builtin {} expects {} arguments, but {} provided",
+						name, count, args.size()));
+		return false;
+	};
+	auto check_vector = [&](const TypedValue& arg) {
+		if (type_mgr.is_vector(arg.type))
+			return true;
+		report_in_ast(node, Location::dk_error,
+			std::format("Builtin {} requires a vector operand ('{}' invalid)",
+						name, type_mgr.get_name(arg.type)));
+		return false;
+	};
+	// 通道数和shufflevector的下标需要在编译期确定
+	auto get_constant = [&](TypedValue arg) -> std::optional<std::int64_t> {
+		arg = to_integer(arg);
+		auto constant = llvm::dyn_cast<llvm::ConstantInt>(arg.value);
+		if (is_builtin(arg.type) && constant != nullptr)
+			return constant->getSExtValue();
+		report_in_ast(node, Location::dk_error,
+			std::format("Argument to builtin {} must be an integer constant",
+						name));
+		return std::nullopt;
+	};
+	auto is_valid_lanes = [](std::int64_t lanes) {
+		return lanes == 2 || lanes == 4 || lanes == 8 || lanes == 16;
+	};
+
+	switch (builtin)
+	{
+	case VectorBuiltin::vb_splat:
+	{
+		if (!check_arg_count(2))
+			return nullptr;
+		auto lanes = get_constant(args[1]);
+		if (!lanes)
+			return nullptr;
+		if (!is_valid_lanes(*lanes))
+		{
+			report_in_ast(node, Location::dk_error,
+				std::format("Invalid lane count {}, expected 2, 4, 8 or 16",
+							*lanes));
+			return nullptr;
+		}
+		auto scalar = to_integer(args[0]);
+		if (!is_builtin(scalar.type) || !type_mgr.is_integer(scalar.type))
+		{
+			report_in_ast(node, Location::dk_error,
+				std::format("Cannot splat a value of type '{}'",
+							type_mgr.get_name(scalar.type)));
+			return nullptr;
+		}
+		auto element = type_mgr.is_signed(scalar.type) ? TypeId::ty_sint
+													   : TypeId::ty_uint;
+		return convert_to(scalar, type_mgr.get_vector(element, *lanes), node);
+	}
+	case VectorBuiltin::vb_shuffle:
+	{
+		if (args.size() < 3)
+		{
+			report_in_ast(node, Location::dk_error,
+				std::format("Builtin {} expects at least 3 arguments, but {} "
+							"provided", name, args.size()));
+			return nullptr;
+		}
+		if (!check_vector(args[0]) || !check_vector(args[1]))
+			return nullptr;
+		if (args[0].type != args[1].type)
+		{
+			report_in_ast(node, Location::dk_error,
+				std::format("Builtin {} requires operands of the same type "
+							"('{}' and '{}')", name,
+							type_mgr.get_name(args[0].type),
+							type_mgr.get_name(args[1].type)));
+			return nullptr;
+		}
+		auto lanes = static_cast<std::int64_t>(
+			type_mgr.get_info(args[0].type).count);
+		if (!is_valid_lanes(static_cast<std::int64_t>(args.size() - 2)))
+		{
+			report_in_ast(node, Location::dk_error,
+				std::format("Invalid lane count {}, expected 2, 4, 8 or 16",
+							args.size() - 2));
+			return nullptr;
+		}
+		std::vector<int> mask;
+		mask.reserve(args.size() - 2);
+		for (auto itr = args.begin() + 2; itr != args.end(); ++itr)
+		{
+			auto index = get_constant(*itr);
+			if (!index)
+				return nullptr;
+			if (*index < -1 || *index >= 2 * lanes)
+			{
+				report_in_ast(node, Location::dk_error,
+					std::format("Index {} for builtin {} is out of bounds "
+								"(the operands contain {} lanes)",
+								*index, name, 2 * lanes));
+				return nullptr;
+			}
+			// -1即llvm中不关心取值的通道(poison)
+			mask.push_back(static_cast<int>(*index));
+		}
+		auto left = to_integer(args[0]);
+		auto right = to_integer(args[1]);
+		auto element = type_mgr.get_info(args[0].type).element;
+		return { builder.CreateShuffleVector(left.value, right.value, mask),
+				 type_mgr.get_vector(element, mask.size()) };
+	}
+	case VectorBuiltin::vb_select:
+	{
+		if (!check_arg_count(3) || !check_vector(args[0]))
+			return nullptr;
+		// 其中一个操作数可以是标量, 广播到每个通道
+		const auto& operand = type_mgr.is_vector(args[1].type) ? args[1]
+															   : args[2];
+		if (!check_vector(operand))
+			return nullptr;
+		auto type = operand.type;
+		if (type_mgr.get_info(args[0].type).count
+			!= type_mgr.get_info(type).count)
+		{
+			report_in_ast(node, Location::dk_error,
+				std::format("Mask '{}' of builtin {} does not match the "
+							"operand type '{}'", type_mgr.get_name(args[0].type),
+							name, type_mgr.get_name(type)));
+			return nullptr;
+		}
+		auto true_value = convert_to(args[1], type, node);
+		auto false_value = convert_to(args[2], type, node);
+		if (true_value == nullptr || false_value == nullptr)
+			return nullptr;
+		// 比较得到的i1向量直接作为条件, 省去扩展后再比较
+		auto mask = args[0].value;
+		if (!mask->getType()->getScalarType()->isIntegerTy(1))
+			mask = builder.CreateICmpNE(
+				mask, llvm::Constant::getNullValue(mask->getType()));
+		return { builder.CreateSelect(mask, true_value.value,
+									  false_value.value),
+				 type };
+	}
+	default:
+		break;
+	}
+
+	if (!check_arg_count(1) || !check_vector(args[0]))
+		return nullptr;
+	auto vector = to_integer(args[0]);
+	auto is_signed = type_mgr.is_signed(vector.type);
+	llvm::Value* result = nullptr;
+	switch (builtin)
+	{
+	case VectorBuiltin::vb_reduce_add:
+		result = builder.CreateAddReduce(vector.value);
+		break;
+	case VectorBuiltin::vb_reduce_mul:
+		result = builder.CreateMulReduce(vector.value);
+		break;
+	case VectorBuiltin::vb_reduce_and:
+		result = builder.CreateAndReduce(vector.value);
+		break;
+	case VectorBuiltin::vb_reduce_or:
+		result = builder.CreateOrReduce(vector.value);
+		break;
+	case VectorBuiltin::vb_reduce_xor:
+		result = builder.CreateXorReduce(vector.value);
+		break;
+	case VectorBuiltin::vb_reduce_max:
+		result = builder.CreateIntMaxReduce(vector.value, is_signed);
+		break;
+	case VectorBuiltin::vb_reduce_min:
+		result = builder.CreateIntMinReduce(vector.value, is_signed);
+		break;
+	default:
+		assert(false && "Unkown vector builtin");
+	}
+	return { result, type_mgr.get_info(vector.type).element };
+}
+
 auto CodeGenVisitor::handle(const PassingParams& node, LocalSymbolTable& table)
-		-> std::vector<llvm::Value*>
+		-> std::vector<TypedValue>
 {
 	
-	std::vector<llvm::Value*> result;
+	std::vector<TypedValue> result;
 	result.reserve(node.size());
 	result.push_back(handle(node.get_expr(), table));
 	handle(node.get_expr_list(), table, result);
@@ -552,7 +1647,7 @@ auto CodeGenVisitor::handle(const PassingParams& node, LocalSymbolTable& table)
 }
 
 auto CodeGenVisitor::handle(const ExprList& node, LocalSymbolTable& table,
-							std::vector<llvm::Value*>& list) -> bool
+							std::vector<TypedValue>& list) -> bool
 {
 	
 	for (const auto& expr: node)
@@ -568,14 +1663,14 @@ auto CodeGenVisitor::handle(const ExprList& node, LocalSymbolTable& table,
 	return true;
 }
 
-auto CodeGenVisitor::handle(const Number& node) -> llvm::Value*
+auto CodeGenVisitor::handle(const Number& node) -> TypedValue
 {
 	
 
 	llvm::Value* result = llvm::ConstantInt::get(get_type_mgr().get_signed_int(),
 											 node.get_int_literal());
 	
-	return result;
+	return { result, TypeId::ty_sint };
 }
 
 void CodeGenVisitor::handle(const Decl& node, LocalSymbolTable& table)
@@ -596,34 +1691,34 @@ void CodeGenVisitor::handle(const ConstDecl& node, LocalSymbolTable& table)
 {
 	
 
-	llvm::Type* type = handle(node.get_scalar_type());
+	auto type = handle(node.get_scalar_type());
+	if (type == TypeId::ty_void)
+		return;
 	handle(node.get_first_const_def(), type, table);
 	handle(node.get_const_def_list(), type, table);
 
 	
 }
 
-void CodeGenVisitor::handle(const ConstDef& node, llvm::Type* type,
+void CodeGenVisitor::handle(const ConstDef& node, TypeId type,
 							LocalSymbolTable& table)
 {
 	
 
 	auto name_str = handle(node.get_ident());
 
-	llvm::Value* right_value = handle(node.get_const_init_val(), table);
-	
-	auto ret = get_cvt_helper().value_conversion(
-		type, right_value->getType()
-	);
-	
-	auto left_type = report_conversion_result(ret, node);
-	if (left_type == nullptr)
+	auto init_value = handle(node.get_const_init_val(), table);
+	if (init_value == nullptr)
 		return;
-	
-	llvm::Value* left_value = right_value;
-	left_value->mutateType(left_type);
+	// 常量的转换被折叠, 读取时的取值范围即为常量值
+	init_value = convert_to(init_value, type, node);
+	if (init_value == nullptr)
+		return;
+	assert(llvm::isa<llvm::Constant>(init_value.value));
 
-	auto entry = std::make_shared<SymbolEntry>(SymbolEntry::eval_value, left_value);
+	auto entry = std::make_shared<SymbolEntry>(SymbolEntry::eval_value,
+											   init_value.value);
+	entry->type_id = type;
 	if (!table.insert(name_str, entry))
 	{
 		report_in_ast(node, Location::dk_error,
@@ -634,7 +1729,7 @@ void CodeGenVisitor::handle(const ConstDef& node, llvm::Type* type,
 	
 }
 
-void CodeGenVisitor::handle(const ConstDefList& node, llvm::Type* type,
+void CodeGenVisitor::handle(const ConstDefList& node, TypeId type,
 							LocalSymbolTable& table)
 {
 	
@@ -646,7 +1741,7 @@ void CodeGenVisitor::handle(const ConstDefList& node, llvm::Type* type,
 }
 
 auto CodeGenVisitor::handle(const ConstInitVal& node, LocalSymbolTable& table)
-	-> llvm::Value*
+	-> TypedValue
 {
 	
 	auto ret = handle(node.get_const_expr(), table);
@@ -655,11 +1750,15 @@ auto CodeGenVisitor::handle(const ConstInitVal& node, LocalSymbolTable& table)
 }
 
 auto CodeGenVisitor::handle(const ConstExpr& node, LocalSymbolTable& table)
-	-> llvm::Value*
+	-> TypedValue
 {
-	
-	auto result = handle(node.get_expr(), table);
-	
+	auto result = m_const_evaluator.evaluate(node.get_expr(), table);
+	if (result == nullptr)
+	{
+		report_in_ast(node, Location::dk_error,
+					  "Expression is not an integer constant expression");
+		report_eval_failure();
+	}
 
 	return result;
 }
@@ -682,237 +1781,1619 @@ auto CodeGenVisitor::handle(const LVal& node, LocalSymbolTable& table)
 	return entry;
 }
 
-auto CodeGenVisitor::unary_operate(const UnaryOp& op, llvm::Value* operand)
-	-> llvm::Value*
+auto CodeGenVisitor::is_in_memory(const LVal& node, const SymbolEntry* entry)
+	-> bool
 {
-	llvm::Value* result = nullptr;
-	llvm::Type* type = operand->getType();
+	return !node.is_named() || node.has_indices()
+		|| entry->type == SymbolEntry::address_value;
+}
 
-	if (!type->isIntegerTy() && !type->isFloatingPointTy())
+auto CodeGenVisitor::emit_address(const LVal& node, const SymbolEntry* entry,
+								  LocalSymbolTable& table) -> TypedValue
+{
+	auto& type_mgr = get_type_mgr();
+	if (node.is_dereference())
 	{
-		get_logger().error("Expected type in UnaryOp");
-		abort();
+		auto pointer = handle(node.get_pointer(), table);
+		if (pointer == nullptr)
+			return nullptr;
+		if (!type_mgr.is_pointer(pointer.type))
+		{
+			report_in_ast(node, Location::dk_error,
+				std::format("Indirection requires pointer operand ('{}' invalid)",
+							type_mgr.get_name(pointer.type)));
+			return nullptr;
+		}
+		auto element = type_mgr.get_info(pointer.type).element;
+		if (!type_mgr.is_complete(element))
+		{
+			report_in_ast(node, Location::dk_error,
+				std::format("Incomplete definition of type '{}'",
+							type_mgr.get_name(element)));
+			return nullptr;
+		}
+		return { pointer.value, element };
 	}
 
-	switch (op.get_type())
+	// 下标之前的对象, 局部标量变量没有地址
+	TypedValue object;
+	if (node.is_member())
 	{
-	case UnaryOp::op_add:
-		result = operand;
-		break;
-	case UnaryOp::op_sub:
-		if (type->isIntegerTy())
-			result = get_builder().CreateNeg(operand);
-		else 
-			result = get_builder().CreateFNeg(operand);
-		break;
-	/// c语言not操作将操作数转换为int类型
-	case UnaryOp::op_not:
+		object = emit_member_address(node, table);
+		if (object == nullptr)
+			return nullptr;
+	}
+	else
+	{
+		assert(entry != nullptr);
+		if (entry->type == SymbolEntry::address_value)
+			object = { entry->value, entry->type_id };
+	}
+	if (!node.has_indices())
+	{
+		assert(object != nullptr);
+		return object;
+	}
+
+	// 下标作用于指向首元素的指针, 越界检查只对数组有效
+	llvm::Value* base = nullptr;
+	TypeId element;
+	std::optional<std::uint64_t> bound;
+	if (object != nullptr && type_mgr.is_array(object.type))
+	{
+		base = object.value;
+		element = type_mgr.get_info(object.type).element;
+		bound = type_mgr.get_info(object.type).count;
+	}
+	else if (object != nullptr && type_mgr.is_pointer(object.type))
+	{
+		// 内存中的指针变量先读出其值
+		base = create_load(object.type, object.value);
+		element = type_mgr.get_info(object.type).element;
+	}
+	else if (object == nullptr && entry->type != SymbolEntry::eval_value
+			 && type_mgr.is_pointer(entry->type_id))
+	{
+		base = read_local(*entry);
+		element = type_mgr.get_info(entry->type_id).element;
+	}
+	else
+	{
+		report_in_ast(node, Location::dk_error,
+					  "Subscripted value is not an array");
+		return nullptr;
+	}
+	if (!type_mgr.is_complete(element))
+	{
+		report_in_ast(node, Location::dk_error,
+			std::format("Subscript of pointer to incomplete type '{}'",
+						type_mgr.get_name(element)));
+		return nullptr;
+	}
+
+	auto source_type = element;
+	std::vector<llvm::Value*> indices;
+	indices.reserve(node.get_indices().size());
+	for (const auto& index_expr : node.get_indices())
 	{
-		llvm::Value* zero = llvm::ConstantInt::get(type, 0);
-		llvm::Value* is_nonzero = nullptr;
-		if (type->isIntegerTy())
+		if (!indices.empty())
 		{
-			is_nonzero = get_builder().CreateICmpNE(operand, zero);
+			if (!type_mgr.is_array(element))
+			{
+				report_in_ast(node, Location::dk_error,
+							  "Subscripted value is not an array");
+				return nullptr;
+			}
+			bound = type_mgr.get_info(element).count;
+			element = type_mgr.get_info(element).element;
 		}
-		else
+
+		auto index = handle(*index_expr, table);
+		if (index == nullptr)
+			return nullptr;
+		index = to_integer(index);
+		if (!is_builtin(index.type) || !type_mgr.is_integer(index.type))
 		{
-			is_nonzero = get_builder().CreateFCmpUNE(operand, zero);
+			report_in_ast(*index_expr, Location::dk_error,
+						  "Array subscript is not an integer");
+			return nullptr;
 		}
-		llvm::Value* int_value =
-			get_builder().CreateZExt(is_nonzero, get_type_mgr().get_signed_int());
 
-		result = get_builder().CreateNot(int_value);
-		break;
-	}
-	default:
-		get_logger().error("Unkown operation: {}, category: {}",
-						static_cast<int>(op.get_type()), op.get_type_str());
-		abort();
+		auto is_signed = type_mgr.is_signed(index.type);
+		auto constant = llvm::dyn_cast<llvm::ConstantInt>(index.value);
+		if (constant != nullptr && bound)
+		{
+			if (is_signed && constant->isNegative())
+			{
+				report_in_ast(*index_expr, Location::dk_warning,
+					std::format("Array index {} is before the beginning of "
+								"the array", constant->getSExtValue()));
+			}
+			else if (constant->getValue().uge(*bound))
+			{
+				report_in_ast(*index_expr, Location::dk_warning,
+					std::format("Array index {} is past the end of the array "
+								"(which contains {} elements)",
+								constant->getZExtValue(), *bound));
+			}
+		}
+		// long与指针等宽, 下标扩展为GEP的索引类型
+		index = convert_to(index, is_signed ? TypeId::ty_slong
+											: TypeId::ty_ulong, *index_expr);
+		if (index == nullptr)
+			return nullptr;
+		indices.push_back(index.value);
 	}
 
-	return result;
-}
-
-auto CodeGenVisitor::handle(const Param& node) -> std::pair<std::string_view, llvm::Type*>
-{
-	auto name = handle(node.get_ident());
-	auto type = handle(node.get_type());
-
-	return { name, type };
+	auto address = get_builder().CreateInBoundsGEP(
+		type_mgr.get_llvm_type(source_type), base, indices);
+	return { address, element };
 }
 
-template <typename TBinaryExpr>
-	requires std::derived_from<TBinaryExpr, BinaryExprBase>
-auto CodeGenVisitor::handle(const TBinaryExpr& node, LocalSymbolTable& table)
-	-> llvm::Value*
+auto CodeGenVisitor::emit_member_address(const LVal& node,
+										 LocalSymbolTable& table) -> TypedValue
 {
-	
-
-	llvm::Value* result = nullptr;
-
-	if (node.has_higher_expr())
+	auto& type_mgr = get_type_mgr();
+	const auto& base = node.get_base();
+	TypedValue object;
+	if (node.is_arrow())
 	{
-		result = handle(node.get_higher_expr(), table);
+		auto pointer = emit_lval_read(base, table);
+		if (pointer == nullptr)
+			return nullptr;
+		if (!type_mgr.is_pointer(pointer.type)
+			|| !type_mgr.is_struct(type_mgr.get_info(pointer.type).element))
+		{
+			report_in_ast(node, Location::dk_error,
+				std::format("Member reference type '{}' is not a pointer to "
+							"a structure", type_mgr.get_name(pointer.type)));
+			return nullptr;
+		}
+		object = { pointer.value, type_mgr.get_info(pointer.type).element };
 	}
-	else if (node.has_combined_expr())
+	else
 	{
-		auto [self_expr_ref, op, higher_expr_ref ] = node.get_combined_expr();
-		auto left = handle(self_expr_ref.get(), table);
-		if (!left)
-		{
-			get_logger().info("Error happens in {}", self_expr_ref.get().get_kind_str());
-			
+		auto entry = base.is_named() ? handle(base, table) : nullptr;
+		if (entry == nullptr && base.is_named())
 			return nullptr;
+		// 结构体变量总是在内存中, 寄存器中的变量一定不是结构体
+		auto in_memory = entry == nullptr || is_in_memory(base, entry.get());
+		if (in_memory)
+		{
+			object = emit_address(base, entry.get(), table);
+			if (object == nullptr)
+				return nullptr;
 		}
-		auto right = handle(higher_expr_ref.get(), table);
-		if (!right)
+		auto type = in_memory ? object.type : entry->type_id;
+		if (!type_mgr.is_struct(type))
 		{
-			get_logger().info("Error happens in {}", higher_expr_ref.get().get_kind_str());
+			report_in_ast(node, Location::dk_error,
+				std::format("Member reference base type '{}' is not a "
+							"structure", type_mgr.get_name(type)));
 			return nullptr;
 		}
+	}
 
-		result = binary_operate(left, op, right);
+	if (!type_mgr.is_complete(object.type))
+	{
+		report_in_ast(node, Location::dk_error,
+			std::format("Incomplete definition of type '{}'",
+						type_mgr.get_name(object.type)));
+		return nullptr;
 	}
-	else
+	auto member = handle(node.get_member());
+	auto field = type_mgr.find_field(object.type, member);
+	if (field == nullptr)
 	{
-		assert(false && "Variant has an unkown type");
+		report_in_ast(node.get_member(), Location::dk_error,
+			std::format("No member named '{}' in '{}'", member,
+						type_mgr.get_name(object.type)));
+		return nullptr;
 	}
-	
-
-	return result;
+	return { get_builder().CreateStructGEP(type_mgr.get_llvm_type(object.type),
+										   object.value, field->index),
+			 field->type };
 }
 
-auto CodeGenVisitor::report_conversion_result(const ConversionResult& result,
-											  const BaseAST& node)
-	-> llvm::Type*
+auto CodeGenVisitor::emit_lval_read(const LVal& node, LocalSymbolTable& table)
+	-> TypedValue
 {
-	switch(result.status)
+	auto entry = node.is_named() ? handle(node, table) : nullptr;
+	if (entry == nullptr && node.is_named())
 	{
-	case ConversionStatus::success:
-		return result.result_type;
-	case ConversionStatus::warning:
-		report_in_ast(node, Location::dk_warning, result.ec.message());
-		return result.result_type;
-	case ConversionStatus::failure:
-		m_success = false;
-		report_in_ast(node, Location::dk_warning, result.ec.message());
+		get_logger().info("User Error Occured in LVal");
 		return nullptr;
-	default:
-		assert(false);
 	}
-}
-
-auto CodeGenVisitor::binary_operate(llvm::Value* left, const Operator& op,
-									llvm::Value* right) -> llvm::Value*
-{
-	get_logger().debug("{} [{}] Begin:", op.get_kind_str(), op.get_type_str());
+	if (is_vector_lane(node, entry.get()))
+		return emit_lane_read(node, *entry, table);
+	if (!is_in_memory(node, entry.get()))
+	{
+		auto value = entry->type == SymbolEntry::eval_value ?
+			entry->value :
+			read_local(*entry);
+		return { value, entry->type_id };
+	}
 
-	llvm::Value* result = nullptr;
-	assert(left && right);
-	assert(left->getType() == right->getType());
+	auto address = emit_address(node, entry.get(), table);
+	if (address == nullptr)
+	{
+		get_logger().info("User Error Occured in LVal");
+		return nullptr;
+	}
+	// 数组在表达式中退化为指向首元素的指针
+	if (get_type_mgr().is_array(address.type))
+	{
+		auto element = get_type_mgr().get_info(address.type).element;
+		return { address.value, get_type_mgr().get_pointer(element) };
+	}
+	return { create_load(address.type, address.value), address.type };
+}
+
+auto CodeGenVisitor::emit_address_of(const LVal& node, LocalSymbolTable& table)
+	-> TypedValue
+{
+	auto entry = node.is_named() ? handle(node, table) : nullptr;
+	if (entry == nullptr && node.is_named())
+		return nullptr;
+
+	TypedValue object;
+	if (is_in_memory(node, entry.get()))
+	{
+		object = emit_address(node, entry.get(), table);
+		if (object == nullptr)
+			return nullptr;
+	}
+	else if (entry->type == SymbolEntry::alloca_value)
+	{
+		object = { entry->alloca, entry->type_id };
+	}
+	else
+	{
+		// 被取地址的变量不会生成为SSA值
+		assert(entry->type == SymbolEntry::eval_value);
+		report_in_ast(node, Location::dk_error,
+			std::format("Cannot take the address of eval value '{}'",
+						node.get_id().get_value()));
+		return nullptr;
+	}
+	return { object.value, get_type_mgr().get_pointer(object.type) };
+}
+
+auto CodeGenVisitor::is_vector_lane(const LVal& node, const SymbolEntry* entry)
+	-> bool
+{
+	return node.is_named() && node.get_indices().size() == 1
+		&& get_type_mgr().is_vector(entry->type_id);
+}
+
+auto CodeGenVisitor::emit_lane_index(const LVal& node, TypeId vector_type,
+									 LocalSymbolTable& table) -> llvm::Value*
+{
+	auto& type_mgr = get_type_mgr();
+	const auto& index_expr = *node.get_indices().front();
+	auto index = handle(index_expr, table);
+	if (index == nullptr)
+		return nullptr;
+	index = to_integer(index);
+	if (!is_builtin(index.type) || !type_mgr.is_integer(index.type))
+	{
+		report_in_ast(index_expr, Location::dk_error,
+					  "Vector subscript is not an integer");
+		return nullptr;
+	}
+
+	auto lanes = type_mgr.get_info(vector_type).count;
+	auto constant = llvm::dyn_cast<llvm::ConstantInt>(index.value);
+	if (constant != nullptr
+		&& ((type_mgr.is_signed(index.type) && constant->isNegative())
+			|| constant->getValue().uge(lanes)))
+	{
+		report_in_ast(index_expr, Location::dk_warning,
+			std::format("Vector index {} is out of bounds (which contains {} "
+						"lanes)", type_mgr.is_signed(index.type)
+									  ? constant->getSExtValue()
+									  : static_cast<std::int64_t>(
+											constant->getZExtValue()),
+						lanes));
+	}
+	return index.value;
+}
+
+auto CodeGenVisitor::emit_lane_read(const LVal& node, const SymbolEntry& entry,
+									LocalSymbolTable& table) -> TypedValue
+{
+	auto index = emit_lane_index(node, entry.type_id, table);
+	if (index == nullptr)
+		return nullptr;
+	auto vector = read_variable(entry);
+	return { get_builder().CreateExtractElement(vector, index),
+			 get_type_mgr().get_info(entry.type_id).element };
+}
+
+auto CodeGenVisitor::emit_lane_write(const LVal& node, const SymbolEntry& entry,
+									 const Expr& expr, LocalSymbolTable& table)
+	-> bool
+{
+	auto index = emit_lane_index(node, entry.type_id, table);
+	if (index == nullptr)
+		return false;
+	auto value = handle(expr, table);
+	if (value == nullptr)
+		return false;
+	value = convert_to(value, get_type_mgr().get_info(entry.type_id).element,
+					   expr);
+	if (value == nullptr)
+		return false;
+
+	auto vector = read_variable(entry);
+	write_variable(entry, get_builder().CreateInsertElement(vector, value.value,
+															index));
+	return true;
+}
+
+auto CodeGenVisitor::create_load(TypeId type, llvm::Value* address)
+	-> llvm::Value*
+{
+	auto load = get_builder().CreateLoad(get_type_mgr().get_llvm_type(type),
+										 address);
+	load->setMetadata(llvm::LLVMContext::MD_tbaa, get_tbaa_tag(type));
+	return load;
+}
+
+void CodeGenVisitor::create_store(TypeId type, llvm::Value* value,
+								  llvm::Value* address)
+{
+	auto store = get_builder().CreateStore(value, address);
+	store->setMetadata(llvm::LLVMContext::MD_tbaa, get_tbaa_tag(type));
+}
+
+auto CodeGenVisitor::get_tbaa_tag(TypeId type) -> llvm::MDNode*
+{
+	auto& tag = m_tbaa_tags[type];
+	if (tag != nullptr)
+		return tag;
+
+	// 元数据节点是唯一化的, 重复创建得到同一节点
+	llvm::MDBuilder md_builder { get_llvm_context() };
+	auto root = md_builder.createTBAARoot("Simple C/C++ TBAA");
+	auto type_node = md_builder.createTBAAScalarTypeNode("omnipotent char",
+														 root);
+	// 向量和结构体的宽度为0, 与clang一致使用omnipotent char
+	const auto& info = get_type_mgr().get_info(type);
+	if (info.kind == TypeInfo::pointer_kind)
+	{
+		type_node = md_builder.createTBAAScalarTypeNode("any pointer",
+														type_node);
+	}
+	else if (info.bit_width > 8)
+	{
+		auto name = get_type_mgr().get_name(type);
+		if (name.starts_with("unsigned "))
+			name.erase(0, std::string_view { "unsigned " }.size());
+		type_node = md_builder.createTBAAScalarTypeNode(name, type_node);
+	}
+	tag = md_builder.createTBAAStructTagNode(type_node, type_node, 0);
+	return tag;
+}
+
+auto CodeGenVisitor::unary_operate(const UnaryOp& op, TypedValue operand)
+	-> TypedValue
+{
+	TypedValue result;
+	llvm::Type* type = operand->getType();
+
+	if (!type->isIntOrIntVectorTy() && !type->isFPOrFPVectorTy())
+	{
+		get_logger().error("Expected type in UnaryOp");
+		abort();
+	}
+
+	switch (op.get_type())
+	{
+	case UnaryOp::op_add:
+		result = to_integer(operand);
+		break;
+	case UnaryOp::op_sub:
+		operand = to_integer(operand);
+		result.type = operand.type;
+		if (!operand->getType()->isIntOrIntVectorTy())
+		{
+			result.value = get_builder().CreateFNeg(operand.value);
+			break;
+		}
+		if (get_type_mgr().is_signed(operand.type))
+			result.value = get_builder().CreateNSWNeg(operand.value);
+		else
+			result.value = get_builder().CreateNeg(operand.value);
+		// 取负为sub 0, x
+		result.range = infer_range(
+			result.value,
+			{ llvm::Constant::getNullValue(operand->getType()), operand.type },
+			operand);
+		break;
+	/// c语言not操作的结果为int, 在作为整数使用前保持为i1
+	case UnaryOp::op_not:
+	{
+		if (type->isVectorTy())
+		{
+			// 逐通道与0比较, 结果同向量比较
+			operand = to_integer(operand);
+			result.value = get_builder().CreateICmpEQ(
+				operand.value,
+				llvm::Constant::getNullValue(operand->getType()));
+			result.type = get_compare_type(operand.type);
+			break;
+		}
+		if (type->isIntegerTy(1))
+		{
+			// not为xor x, true
+			result.value = get_builder().CreateNot(operand.value);
+			result.range = infer_range(
+				result.value, operand,
+				{ llvm::ConstantInt::getTrue(type), operand.type });
+		}
+		else if (type->isIntegerTy())
+		{
+			result.value = get_builder().CreateICmpEQ(
+				operand.value, llvm::ConstantInt::get(type, 0));
+			result.range = infer_range(
+				result.value, operand,
+				{ llvm::ConstantInt::get(type, 0), operand.type });
+		}
+		else
+		{
+			result.value = get_builder().CreateFCmpOEQ(
+				operand.value, llvm::ConstantFP::get(type, 0.0));
+		}
+		result.type = TypeId::ty_sint;
+		break;
+	}
+	default:
+		get_logger().error("Unkown operation: {}, category: {}",
+						static_cast<int>(op.get_type()), op.get_type_str());
+		abort();
+	}
+
+	return result;
+}
+
+auto CodeGenVisitor::handle(const Param& node, LocalSymbolTable& table)
+	-> std::pair<std::string_view, TypeId>
+{
+	auto name = handle(node.get_ident());
+	auto type = handle(node.get_type());
+	if (type == TypeId::ty_void)
+		return { name, type };
+	if (node.is_pointer())
+		type = handle(node.get_pointer(), type);
+	if (!node.is_array())
+	{
+		if (get_type_mgr().is_struct(type))
+		{
+			report_in_ast(node, Location::dk_error,
+				"Passing a structure by value is not supported");
+			return { name, TypeId::ty_void };
+		}
+		return { name, type };
+	}
+
+	auto array_type = handle(node.get_dims(), type, true, table);
+	return { name, array_type.value_or(TypeId::ty_void) };
+}
+
+auto CodeGenVisitor::handle(const ArrayDims& node, TypeId element,
+							bool is_param, LocalSymbolTable& table)
+	-> std::optional<TypeId>
+{
+	std::vector<std::uint64_t> sizes;
+	sizes.reserve(node.size());
+	for (const auto& dim : node)
+	{
+		if (dim == nullptr)
+		{
+			// 参数调整为指针后第一维不影响类型
+			if (!is_param || !sizes.empty())
+			{
+				report_in_ast(node, Location::dk_error,
+							  "Array size must be specified");
+				return std::nullopt;
+			}
+			sizes.push_back(0);
+			continue;
+		}
+
+		auto size = handle(*dim, table);
+		if (size == nullptr)
+			return std::nullopt;
+		auto constant = llvm::cast<llvm::ConstantInt>(size.value);
+		if (constant->isZero()
+			|| (get_type_mgr().is_signed(size.type) && constant->isNegative()))
+		{
+			report_in_ast(*dim, Location::dk_error,
+						  "Array size must be positive");
+			return std::nullopt;
+		}
+		sizes.push_back(constant->getZExtValue());
+	}
+
+	// 从最内层的维度开始构造
+	auto type = element;
+	std::size_t outermost = is_param ? 1 : 0;
+	for (auto i = sizes.size(); i > outermost; --i)
+		type = get_type_mgr().get_array(type, sizes[i - 1]);
+	if (is_param)
+		type = get_type_mgr().get_pointer(type);
+	return type;
+}
+
+auto CodeGenVisitor::get_alignment(const VarDef& node, TypeId type)
+	-> std::optional<llvm::Align>
+{
+	auto align = get_type_mgr().get_data_layout().getABITypeAlign(
+		get_type_mgr().get_llvm_type(type));
+	if (!node.has_attribute())
+		return align;
+
+	const auto& attribute = node.get_attribute();
+	auto name = handle(attribute.get_name());
+	if (name != "aligned")
+	{
+		report_in_ast(attribute, Location::dk_warning,
+					  std::format("Unknown attribute '{}' ignored", name));
+		return align;
+	}
+	if (!attribute.has_value())
+	{
+		report_in_ast(attribute, Location::dk_error,
+					  "Attribute 'aligned' requires an alignment");
+		return std::nullopt;
+	}
+	auto value = attribute.get_value().get_int_literal();
+	if (value <= 0 || !llvm::isPowerOf2_32(static_cast<std::uint32_t>(value)))
+	{
+		report_in_ast(attribute, Location::dk_error,
+					  "Requested alignment is not a power of 2");
+		return std::nullopt;
+	}
+	return std::max(align, llvm::Align(value));
+}
+
+template <typename TBinaryExpr>
+	requires std::derived_from<TBinaryExpr, BinaryExprBase>
+auto CodeGenVisitor::handle(const TBinaryExpr& node, LocalSymbolTable& table)
+	-> TypedValue
+{
+	
+
+	TypedValue result;
+
+	if (node.has_higher_expr())
+	{
+		result = handle(node.get_higher_expr(), table);
+	}
+	else if (node.has_combined_expr())
+	{
+		auto [self_expr_ref, op, higher_expr_ref ] = node.get_combined_expr();
+		auto left = handle(self_expr_ref.get(), table);
+		if (!left)
+		{
+			get_logger().info("Error happens in {}", self_expr_ref.get().get_kind_str());
+			
+			return nullptr;
+		}
+		auto right = handle(higher_expr_ref.get(), table);
+		if (!right)
+		{
+			get_logger().info("Error happens in {}", higher_expr_ref.get().get_kind_str());
+			return nullptr;
+		}
+
+		if (get_type_mgr().is_vector(left.type)
+			|| get_type_mgr().is_vector(right.type))
+			return vector_operate(left, op, right, node);
+		if (!is_builtin(left.type) || !is_builtin(right.type))
+			return pointer_operate(left, op, right, node);
+		left = to_integer(left);
+		right = to_integer(right);
+		auto cvt_result =
+			get_cvt_helper().arithmetic_conversion(left.type, right.type);
+		if (!report_conversion_result(cvt_result, node))
+			return nullptr;
+		result = binary_operate(left, op, right, cvt_result.result_id);
+	}
+	else
+	{
+		assert(false && "Variant has an unkown type");
+	}
+	
+
+	return result;
+}
+
+auto CodeGenVisitor::create_local(TypeId type, std::string_view name)
+	-> std::shared_ptr<SymbolEntry>
+{
+	auto llvm_type = get_type_mgr().get_llvm_type(type);
+	// 结构体与数组相同, 成员只能通过地址访问
+	auto is_array = get_type_mgr().is_array(type)
+		|| get_type_mgr().is_struct(type);
+	auto address_taken =
+		m_func_def != nullptr && m_func_def->is_address_taken(name);
+	std::shared_ptr<SymbolEntry> entry;
+	if (m_direct_ssa && !is_array && !address_taken)
+	{
+		entry = std::make_shared<SymbolEntry>(llvm_type);
+	}
+	else
+	{
+		// 在入口块中分配内存
+		assert(m_alloca_insert_pt != nullptr);
+		llvm::IRBuilder<> alloca_builder { m_alloca_insert_pt };
+		auto alloca_inst = alloca_builder.CreateAlloca(llvm_type, nullptr, name);
+		entry = is_array
+			? std::make_shared<SymbolEntry>(SymbolEntry::address_value,
+											alloca_inst)
+			: std::make_shared<SymbolEntry>(alloca_inst);
+	}
+	entry->type_id = type;
+	return entry;
+}
+
+void CodeGenVisitor::begin_lifetime(llvm::AllocaInst* alloca_inst)
+{
+	// 跳转到标号可以绕过声明, 变量在整个函数中存活
+	if (m_has_labels)
+		return;
+	auto size = get_type_mgr().get_data_layout().getTypeAllocSize(
+		alloca_inst->getAllocatedType());
+	get_builder().CreateLifetimeStart(alloca_inst,
+									  get_builder().getInt64(size));
+	m_scope_allocas.push_back(alloca_inst);
+}
+
+void CodeGenVisitor::end_lifetimes(std::size_t scope_begin)
+{
+	emit_lifetime_ends(scope_begin);
+	m_scope_allocas.resize(scope_begin);
+}
+
+void CodeGenVisitor::emit_lifetime_ends(std::size_t scope_begin)
+{
+	assert(scope_begin <= m_scope_allocas.size());
+	// 作用域末尾不可达(已经返回)时不需要结束
+	if (get_builder().GetInsertBlock()->getTerminator() == nullptr)
+	{
+		// 与声明顺序相反
+		for (auto i = m_scope_allocas.size(); i > scope_begin; --i)
+		{
+			auto alloca_inst = m_scope_allocas[i - 1];
+			auto size = get_type_mgr().get_data_layout().getTypeAllocSize(
+				alloca_inst->getAllocatedType());
+			get_builder().CreateLifetimeEnd(alloca_inst,
+											get_builder().getInt64(size));
+		}
+	}
+}
+
+auto CodeGenVisitor::read_local(const SymbolEntry& entry) -> llvm::Value*
+{
+	if (entry.type == SymbolEntry::ssa_value)
+	{
+		assert(m_ssa_builder);
+		return m_ssa_builder->read_variable(&entry,
+											get_builder().GetInsertBlock());
+	}
+
+	assert(entry.type == SymbolEntry::alloca_value);
+	return create_load(entry.type_id, entry.alloca);
+}
+
+void CodeGenVisitor::write_local(const SymbolEntry& entry, llvm::Value* value)
+{
+	if (entry.type == SymbolEntry::ssa_value)
+	{
+		assert(m_ssa_builder);
+		m_ssa_builder->write_variable(&entry, get_builder().GetInsertBlock(),
+									  value);
+		return;
+	}
+
+	assert(entry.type == SymbolEntry::alloca_value);
+	create_store(entry.type_id, value, entry.alloca);
+}
+
+auto CodeGenVisitor::read_variable(const SymbolEntry& entry) -> llvm::Value*
+{
+	switch (entry.type)
+	{
+	case SymbolEntry::eval_value:
+		return entry.value;
+	case SymbolEntry::address_value:
+		return create_load(entry.type_id, entry.value);
+	default:
+		return read_local(entry);
+	}
+}
+
+void CodeGenVisitor::write_variable(const SymbolEntry& entry, llvm::Value* value)
+{
+	assert(entry.type != SymbolEntry::eval_value);
+	if (entry.type == SymbolEntry::address_value)
+		create_store(entry.type_id, value, entry.value);
+	else
+		write_local(entry, value);
+}
+
+auto CodeGenVisitor::emit_loop(std::string_view name, const Expr* cond,
+							   bool guarded, const LoopHintList* hints,
+							   llvm::function_ref<void()> emit_body,
+							   llvm::function_ref<void()> emit_step,
+							   LocalSymbolTable& table) -> llvm::BasicBlock*
+{
+	auto create_block = [&](std::string_view suffix,
+							llvm::BasicBlock* insert_before) {
+		return llvm::BasicBlock::Create(get_llvm_context(),
+										llvm::Twine(name) + "_" + suffix,
+										table.get_func(), insert_before);
+	};
+
+	auto always_true = cond == nullptr;
+	if (cond != nullptr)
+	{
+		if (auto const_cond = m_const_evaluator.evaluate(*cond, table))
+		{
+			auto is_zero =
+				llvm::cast<llvm::ConstantInt>(const_cond.value)->isZero();
+			// 循环体一次也不会执行, 不带guard地生成在没有前驱的块中以报告错误
+			if (is_zero && guarded && !m_has_labels)
+			{
+				emit_dead_code([&] {
+					emit_loop(name, cond, false, nullptr, emit_body, emit_step,
+							  table);
+				});
+				return get_builder().GetInsertBlock();
+			}
+			always_true = !is_zero;
+		}
+	}
+
+	// guard不成立时跳过整个循环
+	llvm::BasicBlock* end = nullptr;
+	if (guarded && !always_true)
+	{
+		end = create_block("end", nullptr);
+		auto preheader = create_block("ph", end);
+		if (!emit_cond_branch(*cond, preheader, end, table))
+			return nullptr;
+		// 条件在生成时被折叠为假时, 循环体生成在没有前驱的块中
+		begin_block(preheader);
+	}
+	auto body = create_block("body", end);
+	auto latch = create_block("latch", end);
+	auto exit = create_block("exit", end);
+	auto entry = get_builder().GetInsertBlock();
+	get_builder().CreateBr(body);
+
+	// 循环体的第一个块即循环头, 回边生成之前不能封闭
+	get_builder().SetInsertPoint(body);
+	m_jump_targets.push_back({ latch, exit, m_scope_allocas.size() });
+	emit_body();
+	m_jump_targets.pop_back();
+	if (!is_terminated())
+		get_builder().CreateBr(latch);
+
+	// 循环体总是跳出时latch不可达, 其中的步进和条件只用于报告错误, 不产生回边
+	auto latch_reachable = begin_block(latch);
+	emit_step();
+	if (always_true)
+	{
+		if (latch_reachable)
+			get_builder().CreateBr(body);
+		else
+			get_builder().CreateUnreachable();
+	}
+	else
+	{
+		auto dead = latch_reachable ? nullptr : create_block("dead", end);
+		// 条件中的警告已经在guard中报告过
+		m_quiet_warnings = guarded;
+		auto success = emit_cond_branch(*cond, dead ? dead : body,
+										dead ? dead : exit, table);
+		m_quiet_warnings = false;
+		if (!success)
+			return nullptr;
+		if (dead != nullptr)
+		{
+			begin_block(dead);
+			get_builder().CreateUnreachable();
+		}
+	}
+	seal_block(body);
+
+	// 所有回边都带有元数据, LoopSimplify合并latch时会保留
+	if (hints != nullptr)
+	{
+		if (auto loop_id = create_loop_id(*hints))
+		{
+			for (auto pred : llvm::predecessors(body))
+			{
+				if (pred != entry)
+					pred->getTerminator()->setMetadata(
+						llvm::LLVMContext::MD_loop, loop_id);
+			}
+		}
+	}
+
+	auto exit_reachable = enter_block(exit);
+	if (end == nullptr)
+		return exit_reachable ? exit : nullptr;
+	if (exit_reachable)
+		get_builder().CreateBr(end);
+	return enter_block(end) ? end : nullptr;
+}
+
+auto CodeGenVisitor::create_loop_id(const LoopHintList& hints)
+	-> llvm::MDNode*
+{
+	auto& ctx = get_llvm_context();
+	// 第一个操作数引用自身, 使每个循环的元数据互不相同
+	llvm::SmallVector<llvm::Metadata*, 4> properties { nullptr };
+	auto add_property = [&](llvm::StringRef name, llvm::Constant* value) {
+		llvm::SmallVector<llvm::Metadata*, 2> operands {
+			llvm::MDString::get(ctx, name) };
+		if (value != nullptr)
+			operands.push_back(llvm::ConstantAsMetadata::get(value));
+		properties.push_back(llvm::MDNode::get(ctx, operands));
+	};
+
+	for (const auto& hint : hints)
+	{
+		auto name = hint->get_name().get_value();
+		if (name != "unroll" && name != "vectorize" && name != "interleave")
+		{
+			report_in_ast(*hint, Location::dk_warning,
+						  std::format("Unknown loop hint '{}' is ignored", name));
+			continue;
+		}
+
+		if (hint->has_value())
+		{
+			auto value = hint->get_value().get_int_literal();
+			// 向量宽度和交错次数需要是2的幂
+			if (value <= 0
+				|| (name != "unroll" && !llvm::isPowerOf2_32(value)))
+			{
+				report_in_ast(*hint, Location::dk_error,
+							  std::format("Invalid value {} for loop hint '{}'",
+										  value, name));
+				continue;
+			}
+			auto count = get_builder().getInt32(value);
+			if (name == "unroll")
+				add_property("llvm.loop.unroll.count", count);
+			else if (name == "vectorize")
+			{
+				add_property("llvm.loop.vectorize.width", count);
+				add_property("llvm.loop.vectorize.enable",
+							 get_builder().getTrue());
+			}
+			else
+				add_property("llvm.loop.interleave.count", count);
+			continue;
+		}
+
+		auto option = hint->get_option().get_value();
+		if (name == "unroll" && option == "enable")
+			add_property("llvm.loop.unroll.enable", nullptr);
+		else if (name == "unroll" && option == "disable")
+			add_property("llvm.loop.unroll.disable", nullptr);
+		else if (name == "unroll" && option == "full")
+			add_property("llvm.loop.unroll.full", nullptr);
+		else if (name == "vectorize"
+				 && (option == "enable" || option == "disable"))
+		{
+			add_property("llvm.loop.vectorize.enable",
+						 get_builder().getInt1(option == "enable"));
+		}
+		else if (name == "interleave" && option == "disable")
+			add_property("llvm.loop.interleave.count",
+						 get_builder().getInt32(1));
+		else
+		{
+			report_in_ast(*hint, Location::dk_error,
+						  std::format("Invalid option '{}' for loop hint '{}'",
+									  option, name));
+		}
+	}
+
+	if (properties.size() == 1)
+		return nullptr;
+	auto loop_id = llvm::MDNode::getDistinct(ctx, properties);
+	loop_id->replaceOperandWith(0, loop_id);
+	return loop_id;
+}
+
+template <typename OpenOrClosedStmt>
+auto CodeGenVisitor::emit_switch(const BranchStmt<OpenOrClosedStmt>& node,
+								 LocalSymbolTable& table) -> llvm::BasicBlock*
+{
+	auto value = handle(node.get_expr(), table);
+	if (value == nullptr)
+		return nullptr;
+	value = to_integer(value);
+	if (!value->getType()->isIntegerTy())
+	{
+		report_in_ast(node.get_expr(), Location::dk_error,
+					  "Statement requires expression of integer type");
+		return nullptr;
+	}
+	// 整型提升
+	auto type = get_cvt_helper().arithmetic_conversion(value.type,
+		TypeId::ty_sint).result_id;
+	value = convert_to(value, type, node.get_expr());
+	if (value == nullptr)
+		return nullptr;
+
+	auto func = table.get_func();
+	auto end = llvm::BasicBlock::Create(get_llvm_context(), "switch_end", func);
+	// 没有default标号时跳转到switch之后
+	auto inst = get_builder().CreateSwitch(value.value, end);
+	m_jump_targets.push_back({ nullptr, end, m_scope_allocas.size() });
+	m_switch_stack.push_back({ inst, type, end, false });
+
+	// 第一个标号之前的语句不可达
+	auto unreachable = llvm::BasicBlock::Create(get_llvm_context(),
+		"unreachable", func, end);
+	seal_block(unreachable);
+	get_builder().SetInsertPoint(unreachable);
+	handle_branch_stmt(node.get_last_stmt(), table);
+
+	m_switch_stack.pop_back();
+	m_jump_targets.pop_back();
+	if (!is_terminated())
+		get_builder().CreateBr(end);
+	return enter_block(end) ? end : nullptr;
+}
+
+auto CodeGenVisitor::emit_case_label(const Expr* value, const BaseAST& node,
+									 LocalSymbolTable& table) -> bool
+{
+	if (m_switch_stack.empty())
+	{
+		report_in_ast(node, Location::dk_error, value != nullptr
+			? "'case' statement not in switch statement"
+			: "'default' statement not in switch statement");
+		return false;
+	}
+	auto& state = m_switch_stack.back();
+
+	llvm::ConstantInt* case_value = nullptr;
+	if (value != nullptr)
+	{
+		auto result = m_const_evaluator.evaluate(*value, table);
+		if (result != nullptr)
+			result = m_const_evaluator.cast(result, state.type);
+		if (result == nullptr)
+		{
+			report_in_ast(*value, Location::dk_error,
+						  "Expression is not an integer constant expression");
+			return false;
+		}
+		case_value = llvm::cast<llvm::ConstantInt>(result.value);
+		if (state.inst->findCaseValue(case_value) != state.inst->case_default())
+		{
+			report_in_ast(*value, Location::dk_error,
+				std::format("Duplicate case value '{}'",
+					get_type_mgr().is_signed(state.type)
+						? std::to_string(case_value->getSExtValue())
+						: std::to_string(case_value->getZExtValue())));
+			return false;
+		}
+	}
+	else if (state.has_default)
+	{
+		report_in_ast(node, Location::dk_error,
+					  "Multiple default labels in one switch");
+		return false;
+	}
+
+	auto block = llvm::BasicBlock::Create(get_llvm_context(),
+		case_value != nullptr ? "switch_case" : "switch_default",
+		state.end->getParent(), state.end);
+	// 上一个标号的语句落空进入
+	if (!is_terminated())
+		get_builder().CreateBr(block);
+	if (case_value != nullptr)
+		state.inst->addCase(case_value, block);
+	else
+	{
+		state.inst->setDefaultDest(block);
+		state.has_default = true;
+	}
+	seal_block(block);
+	get_builder().SetInsertPoint(block);
+	return true;
+}
+
+auto CodeGenVisitor::is_labeled(const BlockItem& item) -> bool
+{
+	if (!item.has_stmt())
+		return false;
+	const auto& stmt = item.get_stmt();
+	auto type = stmt.has_open_stmt() ? stmt.get_open_stmt().get_type()
+									 : stmt.get_closed_stmt().get_type();
+	return type == BranchType::case_stmt || type == BranchType::default_stmt
+		|| type == BranchType::label_stmt;
+}
+
+auto CodeGenVisitor::get_label(std::string_view name, const BaseAST& node)
+	-> LabelState&
+{
+	auto& label = m_labels[name];
+	if (label.block == nullptr)
+	{
+		label.block = llvm::BasicBlock::Create(get_llvm_context(), name,
+			get_builder().GetInsertBlock()->getParent());
+		label.first_use = &node;
+	}
+	return label;
+}
+
+auto CodeGenVisitor::emit_label(const Ident& ident, const BaseAST& node)
+	-> bool
+{
+	auto& label = get_label(ident.get_value(), node);
+	if (label.defined)
+	{
+		report_in_ast(ident, Location::dk_error,
+			std::format("Redefinition of label '{}'", ident.get_value()));
+		return false;
+	}
+	label.defined = true;
+	// 向前跳转时已经创建, 移动到当前位置
+	label.block->moveAfter(get_builder().GetInsertBlock());
+	if (!is_terminated())
+		get_builder().CreateBr(label.block);
+	get_builder().SetInsertPoint(label.block);
+	return true;
+}
+
+auto CodeGenVisitor::emit_label_address(const Ident& ident,
+										const BaseAST& node) -> TypedValue
+{
+	auto& label = get_label(ident.get_value(), node);
+	if (!label.address_index)
+	{
+		label.address_index = m_address_taken_labels.size();
+		m_address_taken_labels.push_back(label.block);
+		for (auto inst : m_indirect_branches)
+			inst->addDestination(label.block);
+	}
+	return { get_builder().getInt32(*label.address_index), TypeId::ty_uint };
+}
+
+void CodeGenVisitor::emit_computed_goto(const Expr& expr,
+										LocalSymbolTable& table)
+{
+	auto value = handle(expr, table);
+	if (value == nullptr)
+		return;
+	value = to_integer(value);
+	if (!value->getType()->isIntegerTy())
+	{
+		report_in_ast(expr, Location::dk_error,
+					  "Computed goto requires a label address");
+		return;
+	}
+
+	auto& builder = get_builder();
+	auto ptr_type = llvm::PointerType::get(get_llvm_context(), 0);
+	// 取过地址的标号直到函数结束才确定
+	if (m_label_table == nullptr)
+	{
+		m_label_table = new llvm::GlobalVariable(*get_module(), ptr_type,
+			true, llvm::GlobalValue::ExternalLinkage, nullptr,
+			table.get_func()->getName() + ".labels");
+	}
+	auto index = builder.CreateIntCast(value.value, builder.getInt64Ty(),
+		get_type_mgr().is_signed(value.type));
+	auto slot = builder.CreateInBoundsGEP(ptr_type, m_label_table, index);
+	auto address = builder.CreateLoad(ptr_type, slot);
+	auto inst = builder.CreateIndirectBr(address,
+										 m_address_taken_labels.size());
+	for (auto block : m_address_taken_labels)
+		inst->addDestination(block);
+	m_indirect_branches.push_back(inst);
+}
+
+void CodeGenVisitor::finish_labels(llvm::Function* func)
+{
+	for (auto& [name, label] : m_labels)
+	{
+		if (label.defined)
+			continue;
+		report_in_ast(*label.first_use, Location::dk_error,
+			std::format("Use of undeclared label '{}'", name.str()));
+		new llvm::UnreachableInst(get_llvm_context(), label.block);
+	}
+
+	if (m_label_table != nullptr)
+	{
+		auto array_type = llvm::ArrayType::get(m_label_table->getValueType(),
+											   m_address_taken_labels.size());
+		std::vector<llvm::Constant*> addresses;
+		addresses.reserve(m_address_taken_labels.size());
+		for (auto block : m_address_taken_labels)
+			addresses.push_back(llvm::BlockAddress::get(func, block));
+		auto label_table = new llvm::GlobalVariable(*get_module(), array_type,
+			true, llvm::GlobalValue::PrivateLinkage,
+			llvm::ConstantArray::get(array_type, addresses));
+		label_table->setUnnamedAddr(llvm::GlobalValue::UnnamedAddr::Global);
+		label_table->takeName(m_label_table);
+		m_label_table->replaceAllUsesWith(label_table);
+		m_label_table->eraseFromParent();
+	}
+
+	m_labels.clear();
+	m_address_taken_labels.clear();
+	m_indirect_branches.clear();
+	m_label_table = nullptr;
+}
+
+auto CodeGenVisitor::begin_block(llvm::BasicBlock* block) -> bool
+{
+	seal_block(block);
+	get_builder().SetInsertPoint(block);
+	return m_has_labels || !llvm::pred_empty(block);
+}
+
+void CodeGenVisitor::emit_dead_code(llvm::function_ref<void()> emit)
+{
+	auto insert_block = get_builder().GetInsertBlock();
+	auto dead = llvm::BasicBlock::Create(get_llvm_context(), "unreachable",
+										 insert_block->getParent());
+	begin_block(dead);
+	emit();
+	if (!is_terminated())
+		get_builder().CreateUnreachable();
+	get_builder().SetInsertPoint(insert_block);
+}
+
+auto CodeGenVisitor::enter_block(llvm::BasicBlock* block) -> bool
+{
+	// 带标号的函数中, 没有前驱的块仍可能包含跳转的目标
+	if (llvm::pred_empty(block) && !m_has_labels)
+	{
+		// 尚未进入过的空块, 删除不会影响SSABuilder的记录
+		assert(block->empty());
+		block->eraseFromParent();
+		return false;
+	}
+	seal_block(block);
+	get_builder().SetInsertPoint(block);
+	return true;
+}
+
+void CodeGenVisitor::seal_block(llvm::BasicBlock* block)
+{
+	if (m_ssa_builder)
+		m_ssa_builder->seal_block(block);
+}
+
+auto CodeGenVisitor::report_conversion_result(const ConversionResult& result,
+											  const BaseAST& node)
+	-> bool
+{
+	switch(result.status)
+	{
+	case ConversionStatus::success:
+		return true;
+	case ConversionStatus::warning:
+		report_in_ast(node, Location::dk_warning, result.ec.message());
+		return true;
+	case ConversionStatus::failure:
+		m_success = false;
+		report_in_ast(node, Location::dk_warning, result.ec.message());
+		return false;
+	default:
+		assert(false);
+	}
+}
+
+auto CodeGenVisitor::binary_operate(TypedValue left_value, const Operator& op,
+									TypedValue right_value, TypeId common_type)
+	-> TypedValue
+{
+	get_logger().debug("{} [{}] Begin:", op.get_kind_str(), op.get_type_str());
+
+	llvm::Value* result = nullptr;
+	assert(left_value && right_value);
+	assert(left_value->getType() == right_value->getType());
+	auto left = left_value.value;
+	auto right = right_value.value;
+	auto is_signed = get_type_mgr().is_signed(common_type);
+	auto result_type = common_type;
+	// 比较运算的结果为int
+	auto compare_type = get_compare_type(common_type);
 	
 	switch(op.get_type())
 	{
 	case Operator::op_add:
-		result = get_builder().CreateAdd(left, right);
+		result = is_signed ? get_builder().CreateNSWAdd(left, right)
+						   : get_builder().CreateAdd(left, right);
 		break;
 	case Operator::op_sub:
-		result = get_builder().CreateSub(left, right);
+		result = is_signed ? get_builder().CreateNSWSub(left, right)
+						   : get_builder().CreateSub(left, right);
 		break;
 	case Operator::op_mul:
-		result = get_builder().CreateMul(left, right);
+		result = is_signed ? get_builder().CreateNSWMul(left, right)
+						   : get_builder().CreateMul(left, right);
 		break;
 	case Operator::op_div:
-		result = get_builder().CreateSDiv(left, right);
+		result = is_signed ? get_builder().CreateSDiv(left, right)
+						   : get_builder().CreateUDiv(left, right);
 		break;
 	case Operator::op_mod:
-		result = get_builder().CreateSRem(left, right);
+		result = is_signed ? get_builder().CreateSRem(left, right)
+						   : get_builder().CreateURem(left, right);
 		break;
 	case Operator::op_lt:
-		result = get_builder().CreateICmpSLT(left, right);
+		result = is_signed ? get_builder().CreateICmpSLT(left, right)
+						   : get_builder().CreateICmpULT(left, right);
+		result_type = compare_type;
 		break;
 	case Operator::op_le:
-		result = get_builder().CreateICmpSLE(left, right);
+		result = is_signed ? get_builder().CreateICmpSLE(left, right)
+						   : get_builder().CreateICmpULE(left, right);
+		result_type = compare_type;
 		break;
 	case Operator::op_gt:
-		result = get_builder().CreateICmpSGT(left, right);
+		result = is_signed ? get_builder().CreateICmpSGT(left, right)
+						   : get_builder().CreateICmpUGT(left, right);
+		result_type = compare_type;
 		break;
 	case Operator::op_ge:
-		result = get_builder().CreateICmpSGE(left, right);
+		result = is_signed ? get_builder().CreateICmpSGE(left, right)
+						   : get_builder().CreateICmpUGE(left, right);
+		result_type = compare_type;
 		break;
 	case Operator::op_eq:
 		result = get_builder().CreateICmpEQ(left, right);
+		result_type = compare_type;
 		break;
 	case Operator::op_ne:
 		result = get_builder().CreateICmpNE(left, right);
-		break;
-	case Operator::op_land:
-		left = get_builder().CreateTrunc(left, llvm::Type::getInt1Ty(get_module()->getContext()));
-		right = get_builder().CreateTrunc(right, llvm::Type::getInt1Ty(get_module()->getContext()));
-		result = get_builder().CreateLogicalAnd(left, right);
-		break;
-	case Operator::op_lor:
-		left = get_builder().CreateTrunc(left, llvm::Type::getInt1Ty(get_module()->getContext()));
-		right = get_builder().CreateTrunc(right, llvm::Type::getInt1Ty(get_module()->getContext()));
-		result = get_builder().CreateLogicalOr(left, right);
+		result_type = compare_type;
 		break;
 	default:
+		// 逻辑运算符需要短路求值, 由handle(LAndExpr/LOrExpr)处理
 		//在二元运算符中
 		assert(false && "Unprocessed binary operate");
 	}
 
 	assert(result != nullptr);
-	get_builder().CreateZExt(result, get_type_mgr().get_signed_int());
+
+	auto range = infer_range(result, left_value, right_value);
 
 	get_logger().debug("{} [{}] End", op.get_kind_str(), op.get_type_str());
 
-	return result;
+	return { result, result_type, std::move(range) };
+}
+
+auto CodeGenVisitor::vector_operate(TypedValue left, const Operator& op,
+									TypedValue right, const BaseAST& node)
+	-> TypedValue
+{
+	auto type = get_type_mgr().is_vector(left.type) ? left.type : right.type;
+	if ((!is_builtin(left.type) && left.type != type)
+		|| (!is_builtin(right.type) && right.type != type))
+	{
+		report_in_ast(node, Location::dk_error,
+			std::format("Invalid operands to binary expression ('{}' and '{}')",
+						get_type_mgr().get_name(left.type),
+						get_type_mgr().get_name(right.type)));
+		return nullptr;
+	}
+
+	left = convert_to(left, type, node);
+	if (left == nullptr)
+		return nullptr;
+	right = convert_to(right, type, node);
+	if (right == nullptr)
+		return nullptr;
+	return binary_operate(left, op, right, type);
+}
+
+auto CodeGenVisitor::get_compare_type(TypeId type) -> TypeId
+{
+	if (!get_type_mgr().is_vector(type))
+		return TypeId::ty_sint;
+	return get_type_mgr().get_vector(TypeId::ty_sint,
+									 get_type_mgr().get_info(type).count);
+}
+
+auto CodeGenVisitor::pointer_operate(TypedValue left, const Operator& op,
+									 TypedValue right, const BaseAST& node)
+	-> TypedValue
+{
+	auto& type_mgr = get_type_mgr();
+	auto& builder = get_builder();
+	auto is_integer = [&](TypedValue& value) {
+		if (!is_builtin(value.type))
+			return false;
+		value = to_integer(value);
+		return type_mgr.is_integer(value.type);
+	};
+
+	switch (op.get_type())
+	{
+	case Operator::op_add:
+	case Operator::op_sub:
+	{
+		if (op.get_type() == Operator::op_add && type_mgr.is_pointer(right.type))
+			std::swap(left, right);
+		if (type_mgr.is_pointer(left.type)
+			&& !type_mgr.is_complete(type_mgr.get_info(left.type).element))
+		{
+			report_in_ast(node, Location::dk_error,
+				std::format("Arithmetic on a pointer to an incomplete type "
+							"'{}'", type_mgr.get_name(
+										type_mgr.get_info(left.type).element)));
+			return nullptr;
+		}
+		if (type_mgr.is_pointer(left.type) && is_integer(right))
+		{
+			// 与下标相同, 偏移扩展为与指针等宽的long
+			auto offset = convert_to(right, type_mgr.is_signed(right.type)
+												? TypeId::ty_slong
+												: TypeId::ty_ulong, node);
+			if (offset == nullptr)
+				return nullptr;
+			auto index = op.get_type() == Operator::op_sub
+				? builder.CreateNeg(offset.value)
+				: offset.value;
+			auto element = type_mgr.get_info(left.type).element;
+			return { builder.CreateInBoundsGEP(type_mgr.get_llvm_type(element),
+											   left.value, index),
+					 left.type };
+		}
+		if (op.get_type() == Operator::op_sub && left.type == right.type
+			&& type_mgr.is_pointer(left.type))
+		{
+			// 指向同一数组的指针之差是元素大小的整数倍, 除法是精确的
+			auto element = type_mgr.get_info(left.type).element;
+			return { builder.CreatePtrDiff(type_mgr.get_llvm_type(element),
+										   left.value, right.value),
+					 TypeId::ty_slong };
+		}
+		break;
+	}
+	case Operator::op_lt:
+	case Operator::op_le:
+	case Operator::op_gt:
+	case Operator::op_ge:
+	case Operator::op_eq:
+	case Operator::op_ne:
+	{
+		// 与空指针常量比较时将其转换为空指针
+		if (type_mgr.is_pointer(left.type) && is_null_pointer_constant(right))
+			right = convert_to(right, left.type, node);
+		else if (type_mgr.is_pointer(right.type)
+				 && is_null_pointer_constant(left))
+			left = convert_to(left, right.type, node);
+		if (left.type != right.type || !type_mgr.is_pointer(left.type))
+			break;
+
+		llvm::CmpInst::Predicate predicate;
+		switch (op.get_type())
+		{
+		case Operator::op_lt:
+			predicate = llvm::CmpInst::ICMP_ULT;
+			break;
+		case Operator::op_le:
+			predicate = llvm::CmpInst::ICMP_ULE;
+			break;
+		case Operator::op_gt:
+			predicate = llvm::CmpInst::ICMP_UGT;
+			break;
+		case Operator::op_ge:
+			predicate = llvm::CmpInst::ICMP_UGE;
+			break;
+		case Operator::op_eq:
+			predicate = llvm::CmpInst::ICMP_EQ;
+			break;
+		default:
+			predicate = llvm::CmpInst::ICMP_NE;
+		}
+		// 比较运算的结果为int
+		return { builder.CreateICmp(predicate, left.value, right.value),
+				 TypeId::ty_sint };
+	}
+	default:
+		break;
+	}
+
+	report_in_ast(node, Location::dk_error,
+		std::format("Invalid operands to binary expression ('{}' and '{}')",
+					type_mgr.get_name(left.type), type_mgr.get_name(right.type)));
+	return nullptr;
+}
+
+auto CodeGenVisitor::is_null_pointer_constant(TypedValue value) -> bool
+{
+	auto constant = llvm::dyn_cast<llvm::ConstantInt>(value.value);
+	return is_builtin(value.type) && constant != nullptr && constant->isZero();
 }
 
 void CodeGenVisitor::handle(const VarDecl& node, LocalSymbolTable& table)
 {
 	
 
-	auto* type = handle(node.get_scalar_type());
+	auto type = handle(node.get_scalar_type());
+	if (type == TypeId::ty_void)
+		return;
 	handle(node.get_var_def(), type, table);
 	handle(node.get_var_def_list(), type, table);
 
 	
 }
 
-void CodeGenVisitor::handle(const VarDef& node, llvm::Type* type,
+void CodeGenVisitor::handle(const VarDef& node, TypeId type,
 							LocalSymbolTable& table)
 {
 	
 
 	auto name_str = handle(node.get_ident());
+	if (node.is_pointer())
+		type = handle(node.get_pointer(), type);
+	if (node.is_array())
+	{
+		auto array_type = handle(node.get_dims(), type, false, table);
+		if (!array_type)
+			return;
+		if (node.is_initialized())
+		{
+			report_in_ast(node.get_init_val(), Location::dk_error,
+						  "Array initializer is not supported");
+			return;
+		}
+		type = *array_type;
+	}
+	if (!get_type_mgr().is_complete(type))
+	{
+		report_in_ast(node, Location::dk_error,
+			std::format("Variable has incomplete type '{}'",
+						get_type_mgr().get_name(type)));
+		return;
+	}
+	auto alignment = get_alignment(node, type);
+	if (!alignment)
+		return;
 
-	// 创建一个新的局部变量，分配内存
-	llvm::AllocaInst* alloca_inst =
-		new llvm::AllocaInst(type, 0, name_str, get_builder().GetInsertBlock());
+	// 创建一个新的局部变量
+	auto entry = create_local(type, name_str);
+	llvm::AllocaInst* alloca_inst = nullptr;
+	if (entry->type == SymbolEntry::alloca_value)
+		alloca_inst = entry->alloca;
+	else if (entry->type == SymbolEntry::address_value)
+		alloca_inst = llvm::cast<llvm::AllocaInst>(entry->value);
+	if (alloca_inst != nullptr)
+	{
+		alloca_inst->setAlignment(*alignment);
+		begin_lifetime(alloca_inst);
+	}
 
 	if (node.is_initialized())
 	{
 
-		ConversionResult cvt_result;
-		auto right_value = handle(node.get_init_val(), table);
+		auto init_value = handle(node.get_init_val(), table);
+		if (init_value == nullptr)
+			return;
 		// 判断隐式类型转换是否合法
-		cvt_result =
-			get_cvt_helper().value_conversion(type, right_value->getType());
-		auto left_type = report_conversion_result(cvt_result, node);
-		if (left_type == nullptr)
+		init_value = convert_to(init_value, type, node);
+		if (init_value == nullptr)
 			return;
 
-		get_builder().CreateStore(right_value, alloca_inst);
+		write_variable(*entry, init_value.value);
+	}
+	else if (entry->type == SymbolEntry::ssa_value)
+	{
+		// 未初始化的变量, 避免读取到外层同一变量在上一次循环中的值
+		write_local(*entry,
+					llvm::UndefValue::get(get_type_mgr().get_llvm_type(type)));
 	}
 	// 在符号表中添加对应条目
-	auto entry = std::make_shared<SymbolEntry>(alloca_inst);
 	table.insert(name_str, entry);
 
 	
 }
 
-void CodeGenVisitor::handle(const VarDefList& node, llvm::Type* type,
+void CodeGenVisitor::declare(const VarDecl& node)
+{
+	// 全局变量的初始值只能引用全局作用域中的符号
+	LocalSymbolTable table { nullptr, get_global_table() };
+	auto type = handle(node.get_scalar_type());
+	if (type == TypeId::ty_void)
+		return;
+	declare(node.get_var_def(), type, table);
+	for (const auto& var_def : node.get_var_def_list())
+		declare(*var_def, type, table);
+}
+
+void CodeGenVisitor::declare(const VarDef& node, TypeId type,
+							 LocalSymbolTable& table)
+{
+	auto name = handle(node.get_ident());
+	if (node.is_pointer())
+		type = handle(node.get_pointer(), type);
+	if (node.is_array())
+	{
+		auto array_type = handle(node.get_dims(), type, false, table);
+		if (!array_type)
+			return;
+		type = *array_type;
+	}
+	if (!get_type_mgr().is_complete(type))
+	{
+		report_in_ast(node, Location::dk_error,
+			std::format("Variable has incomplete type '{}'",
+						get_type_mgr().get_name(type)));
+		return;
+	}
+	auto alignment = get_alignment(node, type);
+	if (!alignment)
+		return;
+
+	if (get_global_table()->find_ptr(name) != nullptr)
+	{
+		report_in_ast(node, Location::dk_error,
+					  std::format("Variable {} has been defined", name));
+		return;
+	}
+
+	auto llvm_type = get_type_mgr().get_llvm_type(type);
+	llvm::Constant* init = nullptr;
+	if (m_define_globals)
+	{
+		init = llvm::Constant::getNullValue(llvm_type);
+		if (node.is_initialized())
+		{
+			if (get_type_mgr().is_array(type))
+			{
+				report_in_ast(node.get_init_val(), Location::dk_error,
+							  "Array initializer is not supported");
+				return;
+			}
+			auto value = m_const_evaluator.evaluate(
+				node.get_init_val().get_expr(), table);
+			if (value == nullptr)
+			{
+				report_in_ast(node.get_init_val(), Location::dk_error,
+					"Initializer element is not a compile-time constant");
+				report_eval_failure();
+				return;
+			}
+			value = convert_to(value, type, node);
+			if (value == nullptr)
+				return;
+			init = llvm::cast<llvm::Constant>(value.value);
+		}
+	}
+
+	auto global = new llvm::GlobalVariable(*get_module(), llvm_type, false,
+		llvm::GlobalValue::ExternalLinkage, init, name);
+	global->setAlignment(*alignment);
+
+	auto entry = std::make_shared<SymbolEntry>(SymbolEntry::address_value,
+											   global);
+	entry->type_id = type;
+	auto success = get_global_table()->insert(name, entry);
+	assert(success);
+	(void)success;
+}
+
+void CodeGenVisitor::handle(const VarDefList& node, TypeId type,
 							LocalSymbolTable& table)
 {
 	for (const auto& ptr : node)
@@ -923,7 +3404,7 @@ void CodeGenVisitor::handle(const VarDefList& node, llvm::Type* type,
 }
 
 auto CodeGenVisitor::handle(const InitVal& node, LocalSymbolTable& table)
-	-> llvm::Value*
+	-> TypedValue
 {
 	
 	auto result = handle(node.get_expr(), table);
@@ -935,9 +3416,18 @@ void CodeGenVisitor::report_in_ast(const BaseAST& node, Location::DiagKind kind,
 {
 	if (kind == Location::DiagKind::dk_error)
 		m_success = false;
+	else if (m_quiet_warnings)
+		return;
+	std::lock_guard lock { get_diag_mutex() };
 	node.report(kind, msg, &get_src_mgr());
 }
 
+void CodeGenVisitor::report_eval_failure()
+{
+	if (auto failure = m_const_evaluator.take_failure())
+		report_in_ast(*failure->node, Location::dk_note, failure->message);
+}
+
 }	//namespace toycc
 
 
@@ -0,0 +1,662 @@
+#include <algorithm>
+#include <format>
+#include "const_evaluator.hpp"
+
+namespace toycc
+{
+
+auto ConstEvaluator::evaluate(const Expr& node, LocalSymbolTable& table)
+	-> TypedValue
+{
+	// 不在eval函数中时是一次新的求值
+	if (m_depth == 0)
+		m_failure.reset();
+	return evaluate(node.get_low_expr(), table);
+}
+
+auto ConstEvaluator::evaluate(const LOrExpr& node, LocalSymbolTable& table)
+	-> TypedValue
+{
+	if (node.has_higher_expr())
+		return evaluate(node.get_higher_expr(), table);
+
+	auto [left_expr, op, right_expr] = node.get_combined_expr();
+	auto left = evaluate(left_expr.get(), table);
+	if (left == nullptr)
+		return nullptr;
+	if (!get_int(left).isZero())
+		return make_bool(true);
+
+	auto right = evaluate(right_expr.get(), table);
+	if (right == nullptr)
+		return nullptr;
+	return make_bool(!get_int(right).isZero());
+}
+
+auto ConstEvaluator::evaluate(const LAndExpr& node, LocalSymbolTable& table)
+	-> TypedValue
+{
+	if (node.has_higher_expr())
+		return evaluate(node.get_higher_expr(), table);
+
+	auto [left_expr, op, right_expr] = node.get_combined_expr();
+	auto left = evaluate(left_expr.get(), table);
+	if (left == nullptr)
+		return nullptr;
+	if (get_int(left).isZero())
+		return make_bool(false);
+
+	auto right = evaluate(right_expr.get(), table);
+	if (right == nullptr)
+		return nullptr;
+	return make_bool(!get_int(right).isZero());
+}
+
+template <typename TBinaryExpr>
+	requires std::derived_from<TBinaryExpr, BinaryExprBase>
+auto ConstEvaluator::evaluate(const TBinaryExpr& node, LocalSymbolTable& table)
+	-> TypedValue
+{
+	if (node.has_higher_expr())
+		return evaluate(node.get_higher_expr(), table);
+
+	auto [left_expr, op, right_expr] = node.get_combined_expr();
+	auto left = evaluate(left_expr.get(), table);
+	if (left == nullptr)
+		return nullptr;
+	auto right = evaluate(right_expr.get(), table);
+	if (right == nullptr)
+		return nullptr;
+	return binary_operate(left, op.get(), right);
+}
+
+auto ConstEvaluator::evaluate(const UnaryExpr& node, LocalSymbolTable& table)
+	-> TypedValue
+{
+	switch(node.get_unary_type())
+	{
+	case UnaryExpr::primary_expr:
+		return evaluate(node.get_primary_expr(), table);
+	case UnaryExpr::unary_op:
+	{
+		auto operand = evaluate(node.get_unary_expr(), table);
+		if (operand == nullptr)
+			return nullptr;
+		return unary_operate(node.get_unary_op(), operand);
+	}
+	case UnaryExpr::call:
+	case UnaryExpr::call_with_params:
+		return evaluate_call(node, table);
+	default:
+		return fail(node, "Taking an address is not allowed in a constant "
+						  "expression");
+	}
+}
+
+auto ConstEvaluator::evaluate(const PrimaryExpr& node, LocalSymbolTable& table)
+	-> TypedValue
+{
+	if (node.has_expr())
+		return evaluate(node.get_expr(), table);
+	if (node.has_number())
+	{
+		return { llvm::ConstantInt::get(get_type_mgr().get_signed_int(),
+										node.get_number().get_int_literal()),
+				 TypeId::ty_sint };
+	}
+
+	// 数组元素, 结构体成员和解引用得到的对象不是常量
+	const auto& lval = node.get_lval();
+	if (!lval.is_named() || lval.has_indices())
+	{
+		return fail(lval, "Only named scalar values can be read in a "
+						  "constant expression");
+	}
+	auto name = lval.get_id().get_value();
+	auto entry = table.lookup(name);
+	if (entry == nullptr)
+		return fail(lval, std::format("Use of undeclared identifier '{}'", name));
+	if (entry->type != SymbolEntry::eval_value)
+	{
+		return fail(lval, std::format("Read of non-constant variable '{}' is "
+									  "not allowed in a constant expression",
+									  name));
+	}
+	// eval函数中未初始化的局部变量
+	if (entry->value == nullptr)
+	{
+		return fail(lval, std::format("Read of uninitialized variable '{}'",
+									  name));
+	}
+	if (!llvm::isa<llvm::ConstantInt>(entry->value))
+		return nullptr;
+	return { entry->value, entry->type_id };
+}
+
+auto ConstEvaluator::cast(TypedValue value, TypeId type) -> TypedValue
+{
+	auto dest_type = get_type_mgr().get_llvm_type(type);
+	if (!dest_type->isIntegerTy())
+		return nullptr;
+	auto width = dest_type->getIntegerBitWidth();
+	if (type == TypeId::ty_bool)
+		return make_int(llvm::APInt(width, get_int(value).isZero() ? 0 : 1),
+						type);
+	return make_int(get_type_mgr().is_signed(value.type)
+						? get_int(value).sextOrTrunc(width)
+						: get_int(value).zextOrTrunc(width),
+					type);
+}
+
+auto ConstEvaluator::binary_operate(TypedValue left, const Operator& op,
+									TypedValue right) -> TypedValue
+{
+	auto common_type =
+		get_cvt_helper().arithmetic_conversion(left.type, right.type).result_id;
+	if (common_type == TypeId::ty_void)
+		return fail(op, "Invalid operands in a constant expression");
+	left = cast(left, common_type);
+	right = cast(right, common_type);
+	if (left == nullptr || right == nullptr)
+		return nullptr;
+
+	auto is_signed = get_type_mgr().is_signed(common_type);
+	const auto& lhs = get_int(left);
+	const auto& rhs = get_int(right);
+	// 有符号溢出是未定义行为, 不是常量表达式
+	bool overflow = false;
+	llvm::APInt result;
+
+	switch(op.get_type())
+	{
+	case Operator::op_add:
+		result = is_signed ? lhs.sadd_ov(rhs, overflow) : lhs + rhs;
+		break;
+	case Operator::op_sub:
+		result = is_signed ? lhs.ssub_ov(rhs, overflow) : lhs - rhs;
+		break;
+	case Operator::op_mul:
+		result = is_signed ? lhs.smul_ov(rhs, overflow) : lhs * rhs;
+		break;
+	case Operator::op_div:
+		if (rhs.isZero())
+			return fail(op, "Division by zero in a constant expression");
+		result = is_signed ? lhs.sdiv_ov(rhs, overflow) : lhs.udiv(rhs);
+		break;
+	case Operator::op_mod:
+		if (rhs.isZero())
+			return fail(op, "Division by zero in a constant expression");
+		// INT_MIN % -1 与INT_MIN / -1 同样溢出
+		if (is_signed && lhs.isMinSignedValue() && rhs.isAllOnes())
+			return fail(op, "Signed integer overflow in a constant expression");
+		result = is_signed ? lhs.srem(rhs) : lhs.urem(rhs);
+		break;
+	case Operator::op_lt:
+		return make_bool(is_signed ? lhs.slt(rhs) : lhs.ult(rhs));
+	case Operator::op_le:
+		return make_bool(is_signed ? lhs.sle(rhs) : lhs.ule(rhs));
+	case Operator::op_gt:
+		return make_bool(is_signed ? lhs.sgt(rhs) : lhs.ugt(rhs));
+	case Operator::op_ge:
+		return make_bool(is_signed ? lhs.sge(rhs) : lhs.uge(rhs));
+	case Operator::op_eq:
+		return make_bool(lhs == rhs);
+	case Operator::op_ne:
+		return make_bool(lhs != rhs);
+	default:
+		assert(false && "Unprocessed binary operate");
+		return nullptr;
+	}
+
+	if (overflow)
+		return fail(op, "Signed integer overflow in a constant expression");
+	return make_int(result, common_type);
+}
+
+auto ConstEvaluator::unary_operate(const UnaryOp& op, TypedValue operand)
+	-> TypedValue
+{
+	const auto& value = get_int(operand);
+	switch(op.get_type())
+	{
+	case UnaryOp::op_add:
+		return operand;
+	case UnaryOp::op_sub:
+		if (get_type_mgr().is_signed(operand.type) && value.isMinSignedValue())
+			return fail(op, "Signed integer overflow in a constant expression");
+		return make_int(-value, operand.type);
+	case UnaryOp::op_not:
+		return make_bool(value.isZero());
+	default:
+		assert(false && "Unprocessed unary operate");
+		return nullptr;
+	}
+}
+
+auto ConstEvaluator::call(std::string_view name,
+						  std::span<const TypedValue> args,
+						  const BaseAST& call_site) -> TypedValue
+{
+	if (m_depth == 0)
+	{
+		m_failure.reset();
+		m_steps = 0;
+	}
+	auto func_itr = m_eval_funcs.find(name);
+	auto entry = get_global_table()->find_ptr(name);
+	if (func_itr == m_eval_funcs.end() || entry == nullptr)
+	{
+		return fail(call_site, std::format("Call to non-eval function '{}' is "
+										   "not allowed in a constant "
+										   "expression", name));
+	}
+	const auto& func = *func_itr->second;
+	if (args.size() != entry->param_type_ids.size())
+	{
+		return fail(call_site,
+			std::format("Function {} expects {} arguments, but {} provided",
+						name, entry->param_type_ids.size(), args.size()));
+	}
+
+	std::pair<const FuncDef*, std::vector<std::uint64_t>> key { &func, {} };
+	std::vector<TypedValue> params;
+	params.reserve(args.size());
+	for (std::size_t i = 0; i < args.size(); ++i)
+	{
+		auto param = cast(args[i], entry->param_type_ids[i]);
+		key.second.push_back(get_int(param).getZExtValue());
+		params.push_back(param);
+	}
+	if (auto result = m_results.find(key); result != m_results.end())
+		return { result->second, entry->type_id };
+
+	if (m_depth >= m_depth_limit)
+	{
+		return fail(call_site,
+			std::format("Constant evaluation exceeded the maximum call depth "
+						"of {}", m_depth_limit),
+			true);
+	}
+	if (!tick(call_site))
+		return nullptr;
+
+	LocalSymbolTable table { llvm::cast<llvm::Function>(entry->value),
+							 get_global_table() };
+	for (std::size_t i = 0; const auto& param : func.get_paramlist())
+	{
+		auto param_entry = std::make_shared<SymbolEntry>(
+			SymbolEntry::eval_value, params[i].value);
+		param_entry->type_id = params[i].type;
+		table.insert(param->get_ident().get_value(), param_entry);
+		++i;
+	}
+
+	++m_depth;
+	auto flow = execute(func.get_block(), table);
+	--m_depth;
+	if (flow == Flow::failed)
+		return nullptr;
+	if (flow != Flow::func_return)
+	{
+		return fail(func, std::format("Eval function '{}' reached the end "
+									  "without returning a value", name));
+	}
+
+	auto result = cast(m_return_value, entry->type_id);
+	m_results.emplace(std::move(key), llvm::cast<llvm::Constant>(result.value));
+	return result;
+}
+
+auto ConstEvaluator::try_fold(std::string_view name,
+							  std::span<const TypedValue> args,
+							  const BaseAST& call_site) -> TypedValue
+{
+	auto func_itr = m_eval_funcs.find(name);
+	if (func_itr == m_eval_funcs.end())
+		return nullptr;
+	std::pair<const FuncDef*, std::vector<std::uint64_t>> key {
+		func_itr->second, {}
+	};
+	for (const auto& arg : args)
+		key.second.push_back(get_int(arg).getZExtValue());
+	if (m_failed_folds.contains(key))
+		return nullptr;
+
+	auto step_limit =
+		std::exchange(m_step_limit, std::min(m_step_limit, fold_step_limit));
+	auto result = call(name, args, call_site);
+	m_step_limit = step_limit;
+	if (result == nullptr)
+		m_failed_folds.insert(std::move(key));
+	return result;
+}
+
+auto ConstEvaluator::evaluate_call(const UnaryExpr& node,
+								   LocalSymbolTable& table) -> TypedValue
+{
+	auto name = node.get_ident().get_value();
+	// 不是eval函数时不求值实参
+	if (!is_eval_function(name))
+	{
+		return fail(node, std::format("Call to non-eval function '{}' is not "
+									  "allowed in a constant expression",
+									  name));
+	}
+
+	std::vector<TypedValue> args;
+	if (node.get_unary_type() == UnaryExpr::call_with_params)
+	{
+		const auto& params = node.get_passing_params();
+		args.reserve(params.size());
+		args.push_back(evaluate(params.get_expr(), table));
+		for (const auto& expr : params.get_expr_list())
+		{
+			if (args.back() == nullptr)
+				break;
+			args.push_back(evaluate(*expr, table));
+		}
+		if (args.back() == nullptr)
+			return nullptr;
+	}
+	return call(name, args, node);
+}
+
+auto ConstEvaluator::evaluate_cond(const Expr& node, LocalSymbolTable& table)
+	-> std::optional<bool>
+{
+	auto value = evaluate(node, table);
+	if (value == nullptr)
+	{
+		fail(node, "Condition is not a constant expression");
+		return std::nullopt;
+	}
+	return !get_int(value).isZero();
+}
+
+auto ConstEvaluator::execute(const Block& node, LocalSymbolTable& upper_table)
+	-> Flow
+{
+	LocalSymbolTable table { &upper_table };
+	for (const auto& block_item : node.get_block_item_list())
+	{
+		auto flow = block_item->has_decl()
+			? execute(block_item->get_decl(), table)
+			: execute(block_item->get_stmt(), table);
+		if (flow != Flow::next)
+			return flow;
+	}
+	return Flow::next;
+}
+
+auto ConstEvaluator::execute(const Decl& node, LocalSymbolTable& table) -> Flow
+{
+	if (node.has_var_decl())
+		return execute(node.get_var_decl(), table);
+
+	const auto& decl = node.get_const_decl();
+	auto type = get_scalar_type(decl.get_scalar_type());
+	if (!type)
+		return Flow::failed;
+	auto define_const = [&](const ConstDef& def) {
+		return define(def, def.get_ident(), *type,
+			&def.get_const_init_val().get_const_expr().get_expr(), table);
+	};
+	if (!define_const(decl.get_first_const_def()))
+		return Flow::failed;
+	for (const auto& def : decl.get_const_def_list())
+	{
+		if (!define_const(*def))
+			return Flow::failed;
+	}
+	return Flow::next;
+}
+
+auto ConstEvaluator::execute(const VarDecl& node, LocalSymbolTable& table)
+	-> Flow
+{
+	auto type = get_scalar_type(node.get_scalar_type());
+	if (!type)
+		return Flow::failed;
+	auto define_var = [&](const VarDef& def) {
+		if (def.is_pointer() || def.is_array())
+		{
+			fail(def, "Pointers and arrays are not supported in constant "
+					  "evaluation");
+			return false;
+		}
+		return define(def, def.get_ident(), *type,
+			def.is_initialized() ? &def.get_init_val().get_expr() : nullptr,
+			table);
+	};
+	if (!define_var(node.get_var_def()))
+		return Flow::failed;
+	for (const auto& def : node.get_var_def_list())
+	{
+		if (!define_var(*def))
+			return Flow::failed;
+	}
+	return Flow::next;
+}
+
+auto ConstEvaluator::execute(const SimpleStmt& node, LocalSymbolTable& table)
+	-> Flow
+{
+	switch (node.get_type())
+	{
+	case SimpleStmt::assign:
+	{
+		const auto& lval = node.get_lval();
+		if (!lval.is_named() || lval.has_indices())
+		{
+			fail(lval, "Only local scalar variables can be assigned in "
+					   "constant evaluation");
+			return Flow::failed;
+		}
+		auto name = lval.get_id().get_value();
+		auto entry = table.lookup(name);
+		if (entry == nullptr || entry->type != SymbolEntry::eval_value)
+		{
+			fail(lval, std::format("Cannot modify '{}' in constant evaluation",
+								   name));
+			return Flow::failed;
+		}
+		auto value = evaluate(node.get_expr(), table);
+		if (value == nullptr)
+		{
+			fail(node.get_expr(), "Expression is not a constant expression");
+			return Flow::failed;
+		}
+		entry->value = cast(value, entry->type_id).value;
+		return Flow::next;
+	}
+	case SimpleStmt::expression:
+		if (node.has_expr() && evaluate(node.get_expr(), table) == nullptr)
+		{
+			fail(node.get_expr(), "Expression is not a constant expression");
+			return Flow::failed;
+		}
+		return Flow::next;
+	case SimpleStmt::block:
+		return execute(node.get_block(), table);
+	case SimpleStmt::func_return:
+	{
+		if (!node.has_expr())
+		{
+			fail(node, "Eval function must return a value");
+			return Flow::failed;
+		}
+		auto value = evaluate(node.get_expr(), table);
+		if (value == nullptr)
+		{
+			fail(node.get_expr(), "Expression is not a constant expression");
+			return Flow::failed;
+		}
+		m_return_value = value;
+		return Flow::func_return;
+	}
+	case SimpleStmt::loop_break:
+		return Flow::loop_break;
+	case SimpleStmt::loop_continue:
+		return Flow::loop_continue;
+	default:
+		fail(node, "'goto' is not supported in constant evaluation");
+		return Flow::failed;
+	}
+}
+
+template <typename BodyFunc, typename StepFunc>
+auto ConstEvaluator::execute_loop(const BaseAST& node, const Expr* cond,
+								  bool check_first, BodyFunc&& body,
+								  StepFunc&& step, LocalSymbolTable& table)
+	-> Flow
+{
+	for (bool first = true; ; first = false)
+	{
+		// 每次迭代计入一步, 空循环体的无限循环也会超出上限
+		if (!tick(node))
+			return Flow::failed;
+		if (cond != nullptr && (check_first || !first))
+		{
+			auto cond_value = evaluate_cond(*cond, table);
+			if (!cond_value)
+				return Flow::failed;
+			if (!*cond_value)
+				break;
+		}
+		auto flow = body();
+		if (flow == Flow::loop_break)
+			break;
+		if (flow == Flow::func_return || flow == Flow::failed)
+			return flow;
+		if (step() == Flow::failed)
+			return Flow::failed;
+	}
+	return Flow::next;
+}
+
+template <typename OpenOrClosedStmt>
+auto ConstEvaluator::execute(const BranchStmt<OpenOrClosedStmt>& node,
+							 LocalSymbolTable& table) -> Flow
+{
+	if (!tick(node))
+		return Flow::failed;
+	switch (node.get_type())
+	{
+	case BranchType::if_stmt:
+	{
+		auto cond = evaluate_cond(node.get_expr(), table);
+		if (!cond)
+			return Flow::failed;
+		if (!*cond)
+			return Flow::next;
+		return execute(llvm::cast<OpenStmt>(&node)->get_stmt(), table);
+	}
+	case BranchType::if_else_stmt:
+	{
+		auto cond = evaluate_cond(node.get_expr(), table);
+		if (!cond)
+			return Flow::failed;
+		return *cond ? execute(node.get_first_stmt(), table)
+					 : execute(node.get_last_stmt(), table);
+	}
+	case BranchType::while_stmt:
+		return execute_loop(node, &node.get_expr(), true,
+			[&] { return execute(node.get_last_stmt(), table); },
+			[] { return Flow::next; }, table);
+	case BranchType::for_stmt:
+	{
+		const auto& clause = node.get_for_clause();
+		// 初始化部分声明的变量只在循环中可见
+		LocalSymbolTable for_table { &table };
+		auto init = clause.has_decl() ? execute(clause.get_decl(), for_table)
+									  : execute(clause.get_init(), for_table);
+		if (init == Flow::failed)
+			return Flow::failed;
+		return execute_loop(node,
+			clause.has_cond() ? &clause.get_cond() : nullptr, true,
+			[&] { return execute(node.get_last_stmt(), for_table); },
+			[&] { return execute(clause.get_step(), for_table); }, for_table);
+	}
+	case BranchType::do_while_stmt:
+		return execute_loop(node, &node.get_expr(), false,
+			[&] {
+				return execute(llvm::cast<ClosedStmt>(&node)->get_stmt(),
+							   table);
+			},
+			[] { return Flow::next; }, table);
+	case BranchType::simple_stmt:
+		return execute(llvm::cast<ClosedStmt>(&node)->get_simple_stmt(),
+					   table);
+	default:
+		fail(node, "'switch' and labeled statements are not supported in "
+				   "constant evaluation");
+		return Flow::failed;
+	}
+}
+
+auto ConstEvaluator::execute(const Stmt& node, LocalSymbolTable& table) -> Flow
+{
+	if (node.has_open_stmt())
+		return execute(node.get_open_stmt(), table);
+	return execute(node.get_closed_stmt(), table);
+}
+
+auto ConstEvaluator::define(const BaseAST& node, const Ident& ident,
+							TypeId type, const Expr* init,
+							LocalSymbolTable& table) -> bool
+{
+	llvm::Value* value = nullptr;
+	if (init != nullptr)
+	{
+		auto init_value = evaluate(*init, table);
+		if (init_value == nullptr)
+		{
+			fail(*init, "Initializer is not a constant expression");
+			return false;
+		}
+		value = cast(init_value, type).value;
+	}
+
+	auto entry = std::make_shared<SymbolEntry>(SymbolEntry::eval_value, value);
+	entry->type_id = type;
+	if (!table.insert(ident.get_value(), entry))
+	{
+		fail(node, std::format("Variable {} has been defined",
+							   ident.get_value()));
+		return false;
+	}
+	return true;
+}
+
+auto ConstEvaluator::get_scalar_type(const ScalarType& node)
+	-> std::optional<TypeId>
+{
+	if (!node.is_vector())
+	{
+		switch (node.get_type())
+		{
+		case BuiltinTypeEnum::ty_signed_int:
+			return TypeId::ty_sint;
+		case BuiltinTypeEnum::ty_unsigned_int:
+			return TypeId::ty_uint;
+		default:
+			break;
+		}
+	}
+	fail(node, std::format("Variables of type '{}' are not supported in "
+						   "constant evaluation", node.get_type_str()));
+	return std::nullopt;
+}
+
+auto ConstEvaluator::tick(const BaseAST& node) -> bool
+{
+	if (++m_steps <= m_step_limit)
+		return true;
+	fail(node,
+		 std::format("Constant evaluation exceeded the limit of {} steps",
+					 m_step_limit),
+		 true);
+	return false;
+}
+
+}	//namespace toycc
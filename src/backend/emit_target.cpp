@@ -1,8 +1,11 @@
+#include <llvm/Bitcode/BitcodeWriterPass.h>
 #include <llvm/CodeGen/CommandFlags.h>
 #include <llvm/Support/FileSystem.h>
 #include <llvm/IR/LegacyPassManager.h>
 #include <llvm/IR/IRPrintingPasses.h>
 #include <llvm/Pass.h>
+#include <llvm/Passes/OptimizationLevel.h>
+#include <llvm/Passes/PassBuilder.h>
 #include <expected>
 #include "emit_target.hpp"
 
@@ -14,6 +17,7 @@ EmitTarget::EmitTarget(std::string_view inputfile_name,
 		   std::string optimization_level,
 		   std::shared_ptr<spdlog::async_logger> logger):
 	m_inputfile_name { inputfile_name }, m_target_name { std::nullopt },
+	m_target_type { std::nullopt },
 	m_target_machine { target_machine }, m_emit_llvm { emit_llvm },
 	m_optimization_level { optimization_level }, m_logger { logger }
 {
@@ -24,6 +28,7 @@ EmitTarget::EmitTarget(std::string_view inputfile_name, std::string_view target_
 		   std::string optimization_level,
 		   std::shared_ptr<spdlog::async_logger> logger):
 	m_inputfile_name { inputfile_name }, m_target_name { target_name },
+	m_target_type { std::nullopt },
 	m_target_machine { target_machine }, m_emit_llvm { emit_llvm },
 	m_optimization_level { optimization_level }, m_logger { logger }
 {
@@ -43,6 +48,15 @@ auto EmitTarget::operator()(std::unique_ptr<llvm::Module> module)
 										   target_name, ec.message())};
 	}
 
+	return emit(std::move(module), os);
+}
+
+auto EmitTarget::emit(std::unique_ptr<llvm::Module> module,
+					  llvm::raw_pwrite_stream& os)
+	-> std::expected<void, std::string>
+{
+	optimize(*module);
+
 	llvm::legacy::PassManager pm;
 	
 	switch(get_target_type())
@@ -50,11 +64,16 @@ auto EmitTarget::operator()(std::unique_ptr<llvm::Module> module)
 	case llvm_ir:
 		pm.add(llvm::createPrintModulePass(os));
 		break;
-	case assembly:
 	case llvm_bin:
+		pm.add(llvm::createBitcodeWriterPass(os));
+		break;
+	case assembly:
 	case object: {
+		auto file_type = get_target_type() == assembly
+							 ? llvm::CodeGenFileType::AssemblyFile
+							 : llvm::CodeGenFileType::ObjectFile;
 		auto error = m_target_machine->addPassesToEmitFile(
-			pm, os, nullptr, llvm::codegen::getFileType());
+			pm, os, nullptr, file_type);
 		if (error)
 		{
 			return std::unexpected { "No support for file type" };
@@ -71,8 +90,42 @@ auto EmitTarget::operator()(std::unique_ptr<llvm::Module> module)
 	return {};
 }
 
+void EmitTarget::optimize(llvm::Module& module)
+{
+	unsigned level = 0;
+	if (llvm::StringRef { m_optimization_level }.getAsInteger(10, level))
+		m_logger->warn("Invalid optimization level {}", m_optimization_level);
+	if (level == 0)
+		return;
+
+	// -O1下向量化只处理带有vectorize提示的循环
+	llvm::PipelineTuningOptions tuning;
+	tuning.LoopVectorization = level > 1;
+	tuning.SLPVectorization = level > 1;
+
+	llvm::LoopAnalysisManager lam;
+	llvm::FunctionAnalysisManager fam;
+	llvm::CGSCCAnalysisManager cgam;
+	llvm::ModuleAnalysisManager mam;
+	llvm::PassBuilder pb { m_target_machine.get(), tuning };
+	pb.registerModuleAnalyses(mam);
+	pb.registerCGSCCAnalyses(cgam);
+	pb.registerFunctionAnalyses(fam);
+	pb.registerLoopAnalyses(lam);
+	pb.crossRegisterProxies(lam, fam, cgam, mam);
+
+	auto opt_level = level == 1 ? llvm::OptimizationLevel::O1
+				   : level == 2 ? llvm::OptimizationLevel::O2
+								: llvm::OptimizationLevel::O3;
+	auto mpm = pb.buildPerModuleDefaultPipeline(opt_level);
+	mpm.run(module, mam);
+}
+
 auto EmitTarget::get_target_type() -> TargetType
 {
+	if (m_target_type.has_value())
+		return *m_target_type;
+
 	auto file_type = llvm::codegen::getFileType();
 	switch(file_type)
 	{
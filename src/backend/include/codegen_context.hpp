@@ -4,7 +4,9 @@
 #include "conversion.hpp"
 #include "symbol_table.hpp"
 #include <memory>
+#include <mutex>
 #include <expected>
+#include <llvm/Analysis/InstSimplifyFolder.h>
 #include <llvm/IR/IRBuilder.h>
 #include <llvm/IR/LLVMContext.h>
 #include <llvm/IR/Module.h>
@@ -15,6 +17,17 @@
 namespace toycc
 {
 
+/**
+ * @brief 生成代码使用的IRBuilder
+ * @details 创建指令前依据DataLayout进行常量折叠和指令化简,
+ *          常量子表达式和x + 0之类的运算不会生成指令
+ * @note Create*返回的可能是常量或已有的值(x + 0返回x), 不一定是新建的指令;
+ *       只能依据运算本身和操作数推导结果的性质, 不能读取返回值的操作码,
+ *       操作数或标志(见infer_range), 也不能对其修改元数据.
+ *       Load, Store, Alloca, Phi和分支不会被化简
+ */
+using Builder = llvm::IRBuilder<llvm::InstSimplifyFolder>;
+
 class CodeGenContext
 {
 public:
@@ -22,6 +35,14 @@ public:
 				   llvm::SourceMgr& src_mgr, std::shared_ptr<llvm::TargetMachine> tm,
 				   std::shared_ptr<spdlog::async_logger> logger);
 
+	/**
+	 * @brief 创建拥有独立LLVMContext, Module, IRBuilder和全局符号表的上下文
+	 * @note 与当前上下文共享SourceMgr, TargetMachine, logger和诊断锁,
+	 *       用于在工作线程中生成函数体
+	 */
+	[[nodiscard]]
+	auto fork() const -> std::shared_ptr<CodeGenContext>;
+
 	auto get_llvm_context() -> llvm::LLVMContext&
 	{
 		return *m_context;
@@ -32,7 +53,7 @@ public:
 		return m_module.get();
 	}
 
-	auto get_builder() -> llvm::IRBuilder<>&
+	auto get_builder() -> Builder&
 	{
 		return m_builder;
 	}
@@ -66,18 +87,26 @@ public:
 	{
 		return m_global_table.get();
 	}
+
+	/// @brief 共享同一SourceMgr的上下文之间输出诊断信息时需要持有该锁
+	auto get_diag_mutex() -> std::mutex&
+	{
+		return *m_diag_mutex;
+	}
 	
 private:
 	std::unique_ptr<llvm::LLVMContext> m_context;
 	std::unique_ptr<llvm::Module> m_module;
-	llvm::IRBuilder<> m_builder;
+	Builder m_builder;
 	std::unique_ptr<TypeMgr> m_type_mgr;
+	std::shared_ptr<ConversionConfig> m_cvt_config;
 	std::shared_ptr<ConversionHelper> m_cvt_helper;
 
 	llvm::SourceMgr& m_src_mgr;
 	std::shared_ptr<llvm::TargetMachine> m_target_machine;
 	std::shared_ptr<spdlog::async_logger> m_logger;
 	std::unique_ptr<GlobalSymbolTable> m_global_table;
+	std::shared_ptr<std::mutex> m_diag_mutex;
 };
 
 
@@ -93,7 +122,7 @@ public:
 	[[nodiscard]]
 	virtual auto get_module() -> llvm::Module*;
 	[[nodiscard]]
-	virtual auto get_builder() -> llvm::IRBuilder<>&;
+	virtual auto get_builder() -> Builder&;
 	[[nodiscard]]
 	virtual auto get_cvt_helper() -> ConversionHelper&;
 	[[nodiscard]]
@@ -106,6 +135,8 @@ public:
 	virtual auto get_type_mgr() -> TypeMgr&;
 	[[nodiscard]]
 	virtual auto get_global_table() -> GlobalSymbolTable*;
+	[[nodiscard]]
+	virtual auto get_diag_mutex() -> std::mutex&;
 private:
 	std::shared_ptr<CodeGenContext> m_cg_context;
 };
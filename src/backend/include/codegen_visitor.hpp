@@ -1,8 +1,16 @@
 #pragma once
+#include <optional>
+#include <unordered_map>
+#include <llvm/ADT/MapVector.h>
+#include <llvm/ADT/STLFunctionalExtras.h>
+#include <llvm/ADT/StringRef.h>
 #include "codegen_context.hpp"
 
 #include "ast.hpp"
 #include "symbol_table.hpp"
+#include "ssa_builder.hpp"
+#include "typed_value.hpp"
+#include "const_evaluator.hpp"
 
 namespace toycc
 {
@@ -15,30 +23,140 @@ public:
 	[[nodiscard]]
 	auto visit(BaseAST* ast) -> bool override;
 
+	/**
+	 * @brief 只生成源代码顺序中[begin, end)范围内的函数体, 其余函数只生成声明
+	 * @note 用于并行生成, 默认生成全部函数体
+	 */
+	void set_body_range(std::size_t begin, std::size_t end)
+	{
+		m_body_begin = begin;
+		m_body_end = end;
+	}
+
+	/**
+	 * @brief 源代码中函数定义的个数, 即set_body_range的索引范围
+	 * @note 在visit后有效, 不包括只有声明的外部函数和内建函数
+	 */
+	[[nodiscard]]
+	auto get_func_def_count() const -> std::size_t
+	{ return m_func_def_count; }
+
+	/**
+	 * @brief 局部标量变量直接生成SSA形式, 不使用alloca/load/store
+	 * @note 需要在visit前调用
+	 */
+	void set_direct_ssa(bool direct_ssa)
+	{ m_direct_ssa = direct_ssa; }
+
+	/**
+	 * @brief 为false时全局变量只生成外部声明, 定义由其他模块提供
+	 * @note 用于并行生成, 函数体所在的模块链接到声明阶段生成的模块
+	 */
+	void set_define_globals(bool define_globals)
+	{ m_define_globals = define_globals; }
+
+	/**
+	 * @brief 编译期求值eval函数时执行的语句数和调用深度的上限
+	 * @note 需要在visit前调用
+	 */
+	void set_eval_limits(std::size_t step_limit, std::size_t depth_limit)
+	{ m_const_evaluator.set_limits(step_limit, depth_limit); }
+
 private:
 	using SymbolTable = std::unordered_map<std::string_view, llvm::Value*>;
 
+	/// @brief 向量内建函数, 定义见builtin.def
+	enum class VectorBuiltin
+	{
+	#define VECTOR_BUILTIN(id, name) id,
+	#include "builtin.def"
+	};
+
+	/**
+	 * @brief 分两个阶段生成: 先声明所有全局变量和函数原型并注册到全局符号表,
+	 *        再逐个生成函数体, 保证函数调用可以解析到任意位置的函数
+	 */
 	void handle(const CompUnit& node);
-	void handle(const Module& node);
-	void handle(const FuncDef& node);
+	/// @brief 按源代码顺序收集Module链表中的函数定义, 全局变量声明和结构体定义
+	void collect_definitions(const Module& node,
+							 std::vector<const FuncDef*>& func_defs,
+							 std::vector<const VarDecl*>& var_decls,
+							 std::vector<const StructDef*>& struct_defs);
+	/**
+	 * @brief 声明阶段, 先创建所有结构体的不透明类型, 成员可以是指向之后定义的
+	 *        结构体的指针
+	 */
+	void declare(const StructDef& node);
+	/**
+	 * @brief 按定义顺序确定结构体的成员和布局
+	 * @details packed取消成员间的填充, reorder按对齐和大小降序重排成员以减少空洞;
+	 *          成员不能是不完整类型, 不能带有初始值
+	 */
+	void handle(const StructDef& node);
+	/**
+	 * @brief 声明阶段, 创建全局变量并以address_value插入全局符号表
+	 * @details 初始值必须是常量表达式, 没有初始值时零初始化;
+	 *          set_define_globals(false)时只生成外部声明
+	 */
+	void declare(const VarDecl& node);
+	void declare(const VarDef& node, TypeId type, LocalSymbolTable& table);
+	/**
+	 * @brief 声明阶段, 创建函数原型并以func_value插入全局符号表
+	 * @details restrict指针参数带有noalias属性
+	 * @return 重复定义时返回nullptr
+	 */
+	auto declare(const FuncDef& node) -> llvm::Function*;
+	/// @brief 函数体生成阶段, func为declare创建的原型
+	void handle(const FuncDef& node, llvm::Function* func);
 
-	auto handle(const BuiltinType& node) -> llvm::Type*;
-	auto handle(const ScalarType& node) -> llvm::Type*;
+	/// @return 未定义的结构体返回ty_void
+	auto handle(const BuiltinType& node) -> TypeId;
+	/// @copydoc handle(const BuiltinType&)
+	auto handle(const ScalarType& node) -> TypeId;
+	/// @brief 查找已定义的结构体, 未定义时报错并返回ty_void
+	auto find_struct(std::string_view name, const BaseAST& node) -> TypeId;
+	/// @brief 在pointee之上逐级构造指针类型
+	auto handle(const Pointer& node, TypeId pointee) -> TypeId;
 
-	auto handle(const ParamList& node)
-		-> std::pair<std::vector<std::string_view>, std::vector<llvm::Type*>>;
+	auto handle(const ParamList& node, LocalSymbolTable& table)
+		-> std::pair<std::vector<std::string_view>, std::vector<TypeId>>;
 
 	auto create_basic_block(const Block& node, llvm::Function* func,
-				std::string_view block_name, std::span<std::string_view> param_names) -> llvm::BasicBlock*;
+				std::string_view block_name, std::span<std::string_view> param_names,
+				std::span<const TypeId> param_types) -> llvm::BasicBlock*;
+	/**
+	 * @brief 函数生成结束后, 为基于noalias参数的访问添加别名域
+	 * @details 每个参数一个作用域, 访问带有自身的alias.scope和其他参数的noalias,
+	 *          函数被内联后这些信息仍然保留在访问上
+	 */
+	void set_alias_scopes(llvm::Function* func);
 	// 不创建新块的情况
 	void handle(const Block& node, LocalSymbolTable& upper_table);
 
 	void handle(const BlockItemList& node, LocalSymbolTable& table);
 	void handle(const BlockItem& node, LocalSymbolTable& table);
 	
-	auto handle(const Param& node) -> std::pair<std::string_view, llvm::Type*>;
+	/**
+	 * @return 数组参数出错时类型为ty_void
+	 * @note 结构体只能通过指针传递
+	 */
+	auto handle(const Param& node, LocalSymbolTable& table)
+		-> std::pair<std::string_view, TypeId>;
+	/**
+	 * @brief 依据各维大小构造数组类型, 大小必须是正的整数常量表达式
+	 * @param is_param 为true时按参数调整为指向元素的指针, 第一维可以省略
+	 * @return 出错时返回std::nullopt
+	 */
+	auto handle(const ArrayDims& node, TypeId element, bool is_param,
+				LocalSymbolTable& table) -> std::optional<TypeId>;
+	/**
+	 * @brief 变量存储的对齐, aligned(N)只能提高类型本身的对齐
+	 * @return 属性不合法时返回std::nullopt
+	 */
+	auto get_alignment(const VarDef& node, TypeId type)
+		-> std::optional<llvm::Align>;
 
-	auto handle(const Number& num) -> llvm::Value*;
+	auto handle(const Number& num) -> TypedValue;
 	auto handle(const Ident& node) -> std::string_view;
 
 	void handle(const Decl& node, LocalSymbolTable& table);
@@ -50,52 +168,396 @@ private:
 	auto handle_branch_stmt(const BranchStmt<OpenOrClosedStmt>& node,
 							LocalSymbolTable& table) -> llvm::BasicBlock*;
 
-	auto handle(const Expr& expr, LocalSymbolTable& table) -> llvm::Value*;
+	auto handle(const Expr& expr, LocalSymbolTable& table) -> TypedValue;
+	/**
+	 * @brief 短路求值, 结果为i1
+	 * @note 左操作数为常量时不生成跳转
+	 */
+	auto handle(const LOrExpr& node, LocalSymbolTable& table) -> TypedValue;
+	/// @copydoc handle(const LOrExpr&, LocalSymbolTable&)
+	auto handle(const LAndExpr& node, LocalSymbolTable& table) -> TypedValue;
+
+	/**
+	 * @brief 将条件表达式直接生成为跳转, 逻辑运算符不生成中间的bool值
+	 * @note 调用结束后当前插入点所在的基本块已经终结, 跳转目标块的前驱
+	 *       由调用者在全部生成后封闭
+	 * @return false代表用户出错返回
+	 */
+	auto emit_cond_branch(const Expr& node, llvm::BasicBlock* true_block,
+						  llvm::BasicBlock* false_block, LocalSymbolTable& table)
+		-> bool;
+	auto emit_cond_branch(const LOrExpr& node, llvm::BasicBlock* true_block,
+						  llvm::BasicBlock* false_block, LocalSymbolTable& table)
+		-> bool;
+	auto emit_cond_branch(const LAndExpr& node, llvm::BasicBlock* true_block,
+						  llvm::BasicBlock* false_block, LocalSymbolTable& table)
+		-> bool;
+	auto emit_cond_branch(const L7Expr& node, llvm::BasicBlock* true_block,
+						  llvm::BasicBlock* false_block, LocalSymbolTable& table)
+		-> bool;
+	/// @brief 短路运算的右操作数转换为i1
+	template <typename TExpr>
+	auto create_logical_operand(const TExpr& node, LocalSymbolTable& table)
+		-> TypedValue;
+	/**
+	 * @brief 短路运算符在值上下文中的结果, 汇合块中的phi
+	 * @param short_circuit 左操作数短路时的结果
+	 */
+	auto create_logical_phi(llvm::BasicBlock* end_block, bool short_circuit,
+							llvm::Value* right, llvm::BasicBlock* right_block)
+		-> TypedValue;
+	/**
+	 * @brief 将值转换为i1, 用于条件判断
+	 * @return 无法转换为bool时返回nullptr
+	 */
+	auto create_bool(llvm::Value* value, const BaseAST& node) -> llvm::Value*;
+	/**
+	 * @brief 比较和逻辑运算的结果保持为i1, 只在作为整数使用时扩展为int
+	 * @details 向量比较的结果为i1向量, 与gcc一致符号扩展为每个通道-1或0
+	 * @note 非i1的值原样返回
+	 */
+	auto to_integer(TypedValue value) -> TypedValue;
+	/**
+	 * @brief 将value隐式转换为type, 检查转换是否合法并生成转换指令
+	 * @details 取值范围证明转换保持值时不报告诊断;
+	 *          非负值的扩展使用zext nneg, 截断依据范围带上nuw/nsw;
+	 *          标量转换为向量时先转换为通道类型, 再广播到每个通道
+	 * @return 转换失败时返回nullptr
+	 */
+	auto convert_to(TypedValue value, TypeId type, const BaseAST& node)
+		-> TypedValue;
 	auto handle(const PrimaryExpr& node, LocalSymbolTable& table)
-		-> llvm::Value*;
-	auto handle(const UnaryExpr& node, LocalSymbolTable& table) -> llvm::Value*;
+		-> TypedValue;
+	auto handle(const UnaryExpr& node, LocalSymbolTable& table) -> TypedValue;
+	/// @brief 生成函数调用, 检查实参个数与类型
+	auto handle_call(const UnaryExpr& node, const SymbolEntry& func_entry,
+					 LocalSymbolTable& table) -> TypedValue;
+	[[nodiscard]] static
+	auto find_vector_builtin(std::string_view name)
+		-> std::optional<VectorBuiltin>;
+	/**
+	 * @brief 生成向量内建函数的调用
+	 * @details splat的通道数和shufflevector的下标必须为整数常量;
+	 *          reduce系列生成llvm.vector.reduce.*内建函数
+	 * @return 出错时返回nullptr
+	 */
+	auto handle_vector_builtin(const UnaryExpr& node, VectorBuiltin builtin,
+							   LocalSymbolTable& table) -> TypedValue;
 	auto handle(const PassingParams& node, LocalSymbolTable& table)
-		-> std::vector<llvm::Value*>;
+		-> std::vector<TypedValue>;
 	/// @return false代表用户出错返回
 	auto handle(const ExprList& node, LocalSymbolTable& table,
-				std::vector<llvm::Value*>& list) -> bool;
+				std::vector<TypedValue>& list) -> bool;
 
-	void handle(const ConstDef& node, llvm::Type* type, LocalSymbolTable& table);
-	void handle(const ConstDefList& node, llvm::Type* type, LocalSymbolTable& table);
+	void handle(const ConstDef& node, TypeId type, LocalSymbolTable& table);
+	void handle(const ConstDefList& node, TypeId type, LocalSymbolTable& table);
 	auto handle(const ConstInitVal& node, LocalSymbolTable& table)
-		-> llvm::Value*;
-	auto handle(const ConstExpr& node, LocalSymbolTable& table) -> llvm::Value*;
+		-> TypedValue;
+	/// @brief 由ConstEvaluator求值, 不是常量表达式时报错
+	auto handle(const ConstExpr& node, LocalSymbolTable& table) -> TypedValue;
 	/**
 	 * @return 如果无法查找到返回nullptr
+	 * @note 只有is_named()的左值有条目
 	 */
 	auto handle(const LVal& node, LocalSymbolTable& table)
 		-> std::shared_ptr<SymbolEntry>;
+	/**
+	 * @brief 左值所指的对象需要经由地址访问
+	 * @details 解引用, 成员访问, 带有下标的左值, 全局变量, 数组和结构体;
+	 *          其余为局部标量变量
+	 * @param entry 不是is_named()时为nullptr
+	 */
+	[[nodiscard]] static
+	auto is_in_memory(const LVal& node, const SymbolEntry* entry) -> bool;
+	/**
+	 * @brief 计算左值所指对象的地址, 所有下标合并为一条inbounds GEP
+	 * @details 数组先退化为指向首元素的指针, 指针(包括数组参数)的值即为基地址;
+	 *          下标为常量且越界时报告警告
+	 * @param entry 不是is_named()时为nullptr
+	 * @note 需要满足is_in_memory(node, entry)
+	 * @return value为地址, type为对象的类型(可能仍是数组); 出错时返回nullptr
+	 */
+	auto emit_address(const LVal& node, const SymbolEntry* entry,
+					  LocalSymbolTable& table) -> TypedValue;
+	/**
+	 * @brief 成员的地址, base.member取base的地址, base->member读取base的值
+	 * @return 出错时返回nullptr
+	 */
+	auto emit_member_address(const LVal& node, LocalSymbolTable& table)
+		-> TypedValue;
+	/// @brief 读取左值的值, 数组退化为指向首元素的指针
+	/// @return 出错时返回nullptr
+	auto emit_lval_read(const LVal& node, LocalSymbolTable& table)
+		-> TypedValue;
+	/**
+	 * @brief 生成&lval, 结果为指向对象类型的指针
+	 * @note 被取地址的局部变量在解析时已经标记, 总是分配在内存中
+	 */
+	auto emit_address_of(const LVal& node, LocalSymbolTable& table)
+		-> TypedValue;
+	/**
+	 * @brief 左值是向量变量的一个通道v[i]
+	 * @details 通道不可寻址, 通过extractelement/insertelement读写,
+	 *          向量变量本身仍可以是SSA值
+	 * @param entry 不是is_named()时为nullptr
+	 */
+	[[nodiscard]]
+	auto is_vector_lane(const LVal& node, const SymbolEntry* entry) -> bool;
+	/// @brief 通道下标的值, 为常量且越界时报告警告
+	auto emit_lane_index(const LVal& node, TypeId vector_type,
+						 LocalSymbolTable& table) -> llvm::Value*;
+	/// @note 需要满足is_vector_lane(node, &entry)
+	auto emit_lane_read(const LVal& node, const SymbolEntry& entry,
+						LocalSymbolTable& table) -> TypedValue;
+	/// @brief 将expr插入到通道中并写回整个向量
+	/// @return false代表用户出错返回
+	auto emit_lane_write(const LVal& node, const SymbolEntry& entry,
+						 const Expr& expr, LocalSymbolTable& table) -> bool;
+	/// @brief 读取内存中type类型的对象, 带有TBAA标签
+	auto create_load(TypeId type, llvm::Value* address) -> llvm::Value*;
+	/// @brief 写入内存中type类型的对象, 带有TBAA标签
+	void create_store(TypeId type, llvm::Value* value, llvm::Value* address);
+	/**
+	 * @brief 标量类型的TBAA访问标签
+	 * @details 与clang的类型树相同: 根节点之下为omnipotent char, 其余类型是它的
+	 *          子节点; 同宽整数的有无符号类型共用节点, char和_Bool可以访问任意对象
+	 */
+	auto get_tbaa_tag(TypeId type) -> llvm::MDNode*;
 	
 	void handle(const VarDecl& node, LocalSymbolTable& table);
-	void handle(const VarDef& node, llvm::Type* type, LocalSymbolTable& table);
-	void handle(const VarDefList& node, llvm::Type* type, LocalSymbolTable& table);
-	auto handle(const InitVal& node, LocalSymbolTable& table) -> llvm::Value*;
+	void handle(const VarDef& node, TypeId type, LocalSymbolTable& table);
+	void handle(const VarDefList& node, TypeId type, LocalSymbolTable& table);
+	auto handle(const InitVal& node, LocalSymbolTable& table) -> TypedValue;
 
 
 	/// @note 在上层会传入所有的BinaryExpr, 无需在实现文件中显式实例化声明
 	template <typename TBinaryExpr>
 		requires std::derived_from<TBinaryExpr, BinaryExprBase>
 	auto handle(const TBinaryExpr& node, LocalSymbolTable& table)
-		-> llvm::Value*;
+		-> TypedValue;
 
 	/// @brief 一元运算符处理
-	auto unary_operate(const UnaryOp& op, llvm::Value* operand) -> llvm::Value*;
-	/// @brief 二元运算符通用处理函数
-	auto binary_operate(llvm::Value* left, const Operator& op,
-						llvm::Value* right) -> llvm::Value*;
+	auto unary_operate(const UnaryOp& op, TypedValue operand) -> TypedValue;
+	/**
+	 * @brief 二元运算符通用处理函数
+	 * @details 通常算术转换的结果为无符号类型时按无符号运算(udiv, urem,
+	 *          icmp ult等), 有符号的加减乘带有nsw标记,
+	 *          C语言中有符号溢出是未定义行为
+	 * @param common_type 通常算术转换的结果类型
+	 */
+	auto binary_operate(TypedValue left, const Operator& op,
+						TypedValue right, TypeId common_type) -> TypedValue;
+	/**
+	 * @brief 操作数中有向量的二元运算, 逐通道进行
+	 * @details 标量操作数广播到每个通道, 两个向量的类型必须相同
+	 * @return 出错时返回nullptr
+	 */
+	auto vector_operate(TypedValue left, const Operator& op,
+						TypedValue right, const BaseAST& node) -> TypedValue;
+	/// @brief 比较运算的结果类型, 向量为同样通道数的int向量
+	[[nodiscard]]
+	auto get_compare_type(TypeId type) -> TypeId;
+	/**
+	 * @brief 操作数中有指针的二元运算
+	 * @details 指针加减整数生成inbounds GEP, 同类型指针相减得到long类型的元素个数,
+	 *          同类型指针之间或与空指针常量比较; 其余组合报错
+	 * @return 出错时返回nullptr
+	 */
+	auto pointer_operate(TypedValue left, const Operator& op,
+						 TypedValue right, const BaseAST& node) -> TypedValue;
+	/// @brief value是值为0的整数常量
+	[[nodiscard]] static
+	auto is_null_pointer_constant(TypedValue value) -> bool;
+	/**
+	 * @brief 创建局部变量的符号表条目, 依据模式分配内存或交给SSABuilder
+	 * @note 数组和结构体总是分配在内存中, 条目为address_value;
+	 *       被取地址的变量总是分配在内存中
+	 */
+	auto create_local(TypeId type, std::string_view name)
+		-> std::shared_ptr<SymbolEntry>;
+	/// @brief 读取局部变量的当前值
+	auto read_local(const SymbolEntry& entry) -> llvm::Value*;
+	/// @brief 写入局部变量
+	void write_local(const SymbolEntry& entry, llvm::Value* value);
+	/// @brief 读取变量的当前值, 包括全局变量和eval值
+	auto read_variable(const SymbolEntry& entry) -> llvm::Value*;
+	/// @brief 写入局部或全局变量
+	void write_variable(const SymbolEntry& entry, llvm::Value* value);
+	/// @brief 基本块的前驱全部生成后调用, 非SSA模式下没有效果
+	void seal_block(llvm::BasicBlock* block);
+	/// @brief 在声明处开始局部变量的生命周期, 并记录到当前作用域
+	void begin_lifetime(llvm::AllocaInst* alloca_inst);
+	/**
+	 * @brief 结束作用域内声明的变量的生命周期
+	 * @param scope_begin 进入作用域时m_scope_allocas的大小
+	 */
+	void end_lifetimes(std::size_t scope_begin);
+	/// @brief 只生成lifetime.end, 不离开作用域, 用于break和continue
+	void emit_lifetime_ends(std::size_t scope_begin);
 
+	/**
+	 * @brief 生成旋转后的循环: guard -> preheader -> body -> latch -> exit
+	 * @details 循环体的第一个块即循环头, latch是唯一的回边来源并在底部判断条件;
+	 *          continue跳转到latch, break跳转到只有循环内前驱的exit块
+	 * @param name 基本块名称的前缀
+	 * @param cond 为nullptr时条件恒为真
+	 * @param guarded 为false时(do-while)不生成guard, 循环体至少执行一次
+	 * @param hints 附加到回边上的#pragma toycc提示, 可以为nullptr
+	 * @param emit_step 在latch中判断条件之前生成
+	 * @return 循环之后的代码不可达或出错时返回nullptr
+	 */
+	auto emit_loop(std::string_view name, const Expr* cond, bool guarded,
+				   const LoopHintList* hints,
+				   llvm::function_ref<void()> emit_body,
+				   llvm::function_ref<void()> emit_step,
+				   LocalSymbolTable& table) -> llvm::BasicBlock*;
+	/**
+	 * @brief 将循环提示转换为llvm.loop元数据
+	 * @details unroll(N|enable|disable|full), vectorize(N|enable|disable),
+	 *          interleave(N|disable); 未知的提示报告警告后忽略
+	 * @return 没有有效的提示时返回nullptr
+	 */
+	auto create_loop_id(const LoopHintList& hints) -> llvm::MDNode*;
+
+	/**
+	 * @brief 生成switch语句, 控制表达式经过整型提升后作为llvm::SwitchInst的条件
+	 * @details case的分发交给后端: 稠密的case生成跳转表, 稀疏的case生成二分查找
+	 * @return switch之后的代码不可达或出错时返回nullptr
+	 */
+	template <typename OpenOrClosedStmt>
+	auto emit_switch(const BranchStmt<OpenOrClosedStmt>& node,
+					 LocalSymbolTable& table) -> llvm::BasicBlock*;
+	/**
+	 * @brief 在当前位置开始case或default标号所在的基本块, 上一条语句可以落空进入
+	 * @param value 为nullptr时为default标号
+	 * @return 出错时返回false, 插入点保持不变
+	 */
+	auto emit_case_label(const Expr* value, const BaseAST& node,
+						 LocalSymbolTable& table) -> bool;
+	/// @brief 语句以case, default或goto标号开始, 可能由跳转直接到达
+	[[nodiscard]] static
+	auto is_labeled(const BlockItem& item) -> bool;
+
+	struct LabelState;
+	/**
+	 * @brief 查找函数中的goto标号, 第一次使用时创建其基本块
+	 * @note 标号块在函数结束前不封闭, 之后的goto和间接跳转还会添加前驱
+	 */
+	auto get_label(std::string_view name, const BaseAST& node) -> LabelState&;
+	/**
+	 * @brief 在当前位置开始标号所在的基本块, 上一条语句可以落空进入
+	 * @return 标号重复定义时返回false, 插入点保持不变
+	 */
+	auto emit_label(const Ident& label, const BaseAST& node) -> bool;
+	/**
+	 * @brief 生成&&label, 标号加入所有间接跳转的目标
+	 * @return 标号在函数标号表中的编号, 类型为unsigned int
+	 */
+	auto emit_label_address(const Ident& label, const BaseAST& node)
+		-> TypedValue;
+	/**
+	 * @brief 生成goto *expr, 每个跳转点都有独立的indirectbr(线程化分派)
+	 * @details 从函数的标号表中取出blockaddress, 目标为所有取过地址的标号
+	 */
+	void emit_computed_goto(const Expr& expr, LocalSymbolTable& table);
+	/// @brief 函数结束时报告未定义的标号, 并生成标号表
+	void finish_labels(llvm::Function* func);
+
+	/**
+	 * @brief 所有前驱都已生成时, 封闭block并将插入点移动到其末尾
+	 * @return block没有前驱时将其删除并返回false, 插入点保持不变;
+	 *         带标号的函数中不删除, 其中的代码可能由跳转到达
+	 */
+	auto enter_block(llvm::BasicBlock* block) -> bool;
+	/**
+	 * @brief 封闭block并将插入点移动到其末尾, 用于分支和循环中的第一个块
+	 * @details 与enter_block不同, 没有前驱时也进入, 静态不可达的代码同样
+	 *          经过语义检查, 函数结束时由EliminateUnreachableBlocks删除
+	 * @return block是否可达
+	 */
+	auto begin_block(llvm::BasicBlock* block) -> bool;
+	/// @brief 在没有前驱的块中生成emit的代码, 之后回到当前插入点
+	void emit_dead_code(llvm::function_ref<void()> emit);
+
+	/// @brief 当前基本块已经结束, 之后的语句不可达
+	[[nodiscard]]
+	auto is_terminated() -> bool
+	{ return get_builder().GetInsertBlock()->getTerminator() != nullptr; }
+
+	/// @return 转换失败时返回false
 	auto report_conversion_result(const ConversionResult& result,
-								  const BaseAST& node) -> llvm::Type*;
+								  const BaseAST& node) -> bool;
 	void report_in_ast(const BaseAST& node, Location::DiagKind kind,
 					   std::string_view msg);
+	/// @brief 以note报告常量求值失败的位置和原因, 跟在错误之后
+	void report_eval_failure();
 
 private:
+	/// @brief 当前所在循环或switch的break和continue目标
+	struct JumpTarget
+	{
+		/// switch没有continue目标, 为nullptr
+		llvm::BasicBlock* continue_block;
+		llvm::BasicBlock* break_block;
+		/// 进入循环或switch时m_scope_allocas的大小
+		std::size_t scope_begin;
+	};
+
+	/// @brief 函数中的goto标号
+	struct LabelState
+	{
+		llvm::BasicBlock* block;
+		/// 第一次使用的位置, 标号未定义时在此报告
+		const BaseAST* first_use;
+		bool defined;
+		/// 在标号表中的编号, 没有取过地址时为空
+		std::optional<std::uint32_t> address_index;
+	};
+
+	/// @brief 正在生成的switch语句, case标号添加到其中
+	struct SwitchState
+	{
+		llvm::SwitchInst* inst;
+		/// 整型提升后控制表达式的类型, case的值转换为该类型
+		TypeId type;
+		llvm::BasicBlock* end;
+		bool has_default;
+	};
+
 	bool m_success;
+	/// 当前函数的返回类型
+	TypeId m_return_type;
+	std::size_t m_body_begin;
+	std::size_t m_body_end;
+	std::size_t m_func_def_count;
+	bool m_direct_ssa;
+	bool m_define_globals;
+	/// 当前函数的SSA构造状态, 只在direct_ssa模式下存在
+	std::unique_ptr<SSABuilder> m_ssa_builder;
+	/// 入口块中的占位指令, 局部变量的alloca都插入到它之前
+	llvm::Instruction* m_alloca_insert_pt;
+	/// 按声明顺序记录的嵌套作用域中存活的局部变量
+	std::vector<llvm::AllocaInst*> m_scope_allocas;
+	/// 嵌套的循环和switch, 末尾为最内层
+	std::vector<JumpTarget> m_jump_targets;
+	/// 嵌套的switch, 末尾为最内层
+	std::vector<SwitchState> m_switch_stack;
+	/// 当前函数中有带标号的语句, 跳转可以绕过声明或到达静态不可达的代码
+	bool m_has_labels;
+	/// 正在生成函数体的函数, 查询其中被取地址的变量
+	const FuncDef* m_func_def;
+	/// 按第一次使用的顺序记录, 诊断的顺序是确定的
+	llvm::MapVector<llvm::StringRef, LabelState> m_labels;
+	/// 取过地址的标号块, 下标为其编号
+	std::vector<llvm::BasicBlock*> m_address_taken_labels;
+	std::vector<llvm::IndirectBrInst*> m_indirect_branches;
+	/// 标号表的占位符, 函数结束时替换为blockaddress数组
+	llvm::GlobalVariable* m_label_table;
+	/// 以TypeId为键缓存的TBAA访问标签
+	std::unordered_map<TypeId, llvm::MDNode*> m_tbaa_tags;
+	/// 重复生成同一表达式(latch中的循环条件)时不再报告警告
+	bool m_quiet_warnings;
+	ConstEvaluator m_const_evaluator;
 };
 
 }	//namespace toycc
@@ -0,0 +1,230 @@
+#pragma once
+#include <map>
+#include <optional>
+#include <set>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <llvm/ADT/APInt.h>
+#include <llvm/IR/Constants.h>
+#include "codegen_context.hpp"
+#include "ast.hpp"
+#include "symbol_table.hpp"
+#include "typed_value.hpp"
+
+namespace toycc
+{
+
+/// @brief 编译期求值失败的原因
+struct EvalFailure
+{
+	/// 出错的语法树节点, 用于报告位置
+	const BaseAST* node;
+	std::string message;
+	/// 因超出步数或调用深度上限而失败, 放宽上限后可能成功
+	bool limit_exceeded = false;
+};
+
+/**
+ * @brief 在语法树上求值整数常量表达式, 不生成任何指令
+ * @details 操作数只能是整数字面量, 已绑定的eval常量和以常量为实参的eval函数
+ *          调用, 运算依据通常算术转换的结果类型在APInt上进行;
+ *          短路运算的右操作数在左操作数已决定结果时不会被求值;
+ *          eval函数在语法树上解释执行, 局部变量作为eval_value保存在
+ *          局部符号表中, 执行的语句数和调用深度有上限
+ * @note 遇到变量, 非eval函数调用, 除以0和有符号溢出时不是常量表达式,
+ *       返回nullptr, 由调用者决定报错或生成指令, 原因由take_failure取得
+ */
+class ConstEvaluator: public CGContextInterface
+{
+public:
+	ConstEvaluator(std::shared_ptr<CodeGenContext> cg_context):
+		CGContextInterface { cg_context }
+	{}
+
+	/// @return 结果的value为llvm::ConstantInt, 比较和逻辑运算的结果为int
+	[[nodiscard]]
+	auto evaluate(const Expr& node, LocalSymbolTable& table) -> TypedValue;
+	[[nodiscard]]
+	auto evaluate(const LOrExpr& node, LocalSymbolTable& table) -> TypedValue;
+	[[nodiscard]]
+	auto evaluate(const LAndExpr& node, LocalSymbolTable& table) -> TypedValue;
+	[[nodiscard]]
+	auto evaluate(const UnaryExpr& node, LocalSymbolTable& table)
+		-> TypedValue;
+	[[nodiscard]]
+	auto evaluate(const PrimaryExpr& node, LocalSymbolTable& table)
+		-> TypedValue;
+
+	template <typename TBinaryExpr>
+		requires std::derived_from<TBinaryExpr, BinaryExprBase>
+	[[nodiscard]]
+	auto evaluate(const TBinaryExpr& node, LocalSymbolTable& table)
+		-> TypedValue;
+
+	/// @brief 按源类型的符号扩展或截断到type
+	[[nodiscard]]
+	auto cast(TypedValue value, TypeId type) -> TypedValue;
+
+	/// @note 参数和返回类型已在声明时检查为整数
+	void add_eval_function(std::string_view name, const FuncDef& func)
+	{ m_eval_funcs.emplace(name, &func); }
+
+	[[nodiscard]]
+	auto is_eval_function(std::string_view name) const -> bool
+	{ return m_eval_funcs.contains(name); }
+
+	/**
+	 * @brief 以常量实参解释执行eval函数
+	 * @param args 实参, value为llvm::ConstantInt
+	 * @param call_site 调用表达式, 超出调用深度时报告在此处
+	 * @return 失败时返回nullptr
+	 * @note 相同实参的结果被缓存, 递归调用不会重复求值
+	 */
+	[[nodiscard]]
+	auto call(std::string_view name, std::span<const TypedValue> args,
+			  const BaseAST& call_site) -> TypedValue;
+
+	/**
+	 * @brief 在普通代码中尝试以常量实参折叠eval函数调用
+	 * @details 步数上限不超过fold_step_limit, 远小于常量上下文的上限;
+	 *          失败的调用被记录, 相同实参不再重复求值
+	 * @param args 实参, 已转换为形参类型
+	 * @return 失败时返回nullptr, 已记录的失败不会再产生take_failure的结果
+	 */
+	[[nodiscard]]
+	auto try_fold(std::string_view name, std::span<const TypedValue> args,
+				  const BaseAST& call_site) -> TypedValue;
+
+	/**
+	 * @param step_limit 一次求值中最多执行的语句和调用个数
+	 * @param depth_limit eval函数的最大嵌套调用深度
+	 */
+	void set_limits(std::size_t step_limit, std::size_t depth_limit)
+	{
+		m_step_limit = step_limit;
+		m_depth_limit = depth_limit;
+	}
+
+	/// @return 最近一次求值中最先出现的失败, 没有失败时返回std::nullopt
+	[[nodiscard]]
+	auto take_failure() -> std::optional<EvalFailure>
+	{ return std::exchange(m_failure, std::nullopt); }
+
+private:
+	/// @brief 语句执行后的去向
+	enum class Flow
+	{
+		next,
+		loop_break,
+		loop_continue,
+		func_return,
+		failed,
+	};
+
+	[[nodiscard]]
+	auto evaluate_call(const UnaryExpr& node, LocalSymbolTable& table)
+		-> TypedValue;
+	/// @return 失败时返回std::nullopt
+	[[nodiscard]]
+	auto evaluate_cond(const Expr& node, LocalSymbolTable& table)
+		-> std::optional<bool>;
+
+	[[nodiscard]]
+	auto execute(const Block& node, LocalSymbolTable& upper_table) -> Flow;
+	[[nodiscard]]
+	auto execute(const Decl& node, LocalSymbolTable& table) -> Flow;
+	[[nodiscard]]
+	auto execute(const VarDecl& node, LocalSymbolTable& table) -> Flow;
+	[[nodiscard]]
+	auto execute(const Stmt& node, LocalSymbolTable& table) -> Flow;
+	[[nodiscard]]
+	auto execute(const SimpleStmt& node, LocalSymbolTable& table) -> Flow;
+	template <typename OpenOrClosedStmt>
+	[[nodiscard]]
+	auto execute(const BranchStmt<OpenOrClosedStmt>& node,
+				 LocalSymbolTable& table) -> Flow;
+
+	/**
+	 * @param cond 为nullptr时是无限循环
+	 * @param check_first 第一次执行循环体前是否检查条件, do-while为false
+	 */
+	template <typename BodyFunc, typename StepFunc>
+	[[nodiscard]]
+	auto execute_loop(const BaseAST& node, const Expr* cond, bool check_first,
+					  BodyFunc&& body, StepFunc&& step,
+					  LocalSymbolTable& table) -> Flow;
+
+	/// @param init 为nullptr时变量未初始化, 读取时求值失败
+	[[nodiscard]]
+	auto define(const BaseAST& node, const Ident& ident, TypeId type,
+				const Expr* init, LocalSymbolTable& table) -> bool;
+	/// @return 只支持int和unsigned, 其他类型返回std::nullopt
+	[[nodiscard]]
+	auto get_scalar_type(const ScalarType& node) -> std::optional<TypeId>;
+
+	/// @brief 计入一步, 超出上限时失败
+	[[nodiscard]]
+	auto tick(const BaseAST& node) -> bool;
+
+	/// @brief 记录失败的原因, 只保留最先出现(最内层)的失败
+	auto fail(const BaseAST& node, std::string message,
+			  bool limit_exceeded = false) -> std::nullptr_t
+	{
+		if (!m_failure)
+			m_failure = EvalFailure { &node, std::move(message), limit_exceeded };
+		return nullptr;
+	}
+
+	[[nodiscard]]
+	auto binary_operate(TypedValue left, const Operator& op, TypedValue right)
+		-> TypedValue;
+	[[nodiscard]]
+	auto unary_operate(const UnaryOp& op, TypedValue operand) -> TypedValue;
+
+	[[nodiscard]]
+	auto make_int(const llvm::APInt& value, TypeId type) -> TypedValue
+	{
+		return { llvm::ConstantInt::get(get_llvm_context(), value), type };
+	}
+
+	/// @brief 比较和逻辑运算的结果
+	[[nodiscard]]
+	auto make_bool(bool value) -> TypedValue
+	{
+		return { llvm::ConstantInt::get(get_type_mgr().get_signed_int(),
+										value ? 1 : 0),
+				 TypeId::ty_sint };
+	}
+
+	[[nodiscard]] static
+	auto get_int(const TypedValue& value) -> const llvm::APInt&
+	{ return llvm::cast<llvm::ConstantInt>(value.value)->getValue(); }
+
+private:
+	/// 默认上限与clang的-fconstexpr-steps和-fconstexpr-depth相同
+	static constexpr std::size_t default_step_limit = 1048576;
+	static constexpr std::size_t default_depth_limit = 512;
+	/// 普通代码中的折叠是可选的, 不值得为每个调用花费完整的上限
+	static constexpr std::size_t fold_step_limit = 8192;
+
+	std::unordered_map<std::string_view, const FuncDef*> m_eval_funcs;
+	/// 已求值的调用, 键为函数和零扩展后的实参
+	std::map<std::pair<const FuncDef*, std::vector<std::uint64_t>>,
+			 llvm::Constant*> m_results;
+	/// try_fold失败的调用, 键与m_results相同
+	std::set<std::pair<const FuncDef*, std::vector<std::uint64_t>>>
+		m_failed_folds;
+
+	std::size_t m_step_limit = default_step_limit;
+	std::size_t m_depth_limit = default_depth_limit;
+	std::size_t m_steps = 0;
+	std::size_t m_depth = 0;
+	/// 当前执行的return语句的值
+	TypedValue m_return_value;
+	std::optional<EvalFailure> m_failure;
+};
+
+}	//namespace toycc
@@ -1,7 +1,9 @@
 #pragma once
 #include <llvm/IR/Module.h>
 #include <expected>
+#include <llvm/Support/raw_ostream.h>
 #include <llvm/Target/TargetMachine.h>
+#include <optional>
 #include <string>
 #include <spdlog/spdlog.h>
 #include <spdlog/async.h>
@@ -34,13 +36,31 @@ public:
 	void set_target_name(std::string_view target_name)
 	{ m_target_name = target_name; }
 
+	/// @brief 显式指定输出类型, 未指定时由命令行参数决定
+	void set_target_type(TargetType target_type)
+	{ m_target_type = target_type; }
+
+	/// @brief 输出到目标文件
 	[[nodiscard]]
 	auto operator()(std::unique_ptr<llvm::Module> module)
 		-> std::expected<void, std::string>;
+
+	/// @brief 输出到指定的流, 不涉及文件
+	[[nodiscard]]
+	auto emit(std::unique_ptr<llvm::Module> module, llvm::raw_pwrite_stream& os)
+		-> std::expected<void, std::string>;
+
 	[[nodiscard]]
 	auto get_target_type() -> TargetType;
 	
 private:
+	/**
+	 * @brief 优化级别大于0时运行新PassManager的默认优化流水线
+	 * @note 无法执行循环提示要求的变换时, 由WarnMissedTransformations
+	 *       通过LLVMContext的诊断回调报告
+	 */
+	void optimize(llvm::Module& module);
+
 	[[nodiscard]] static
 	auto erase_file_postfix(std::string_view file_name) -> std::string_view;
 
@@ -50,6 +70,7 @@ private:
 private:
 	std::string_view m_inputfile_name;
 	std::optional<std::string_view> m_target_name;
+	std::optional<TargetType> m_target_type;
 	std::shared_ptr<llvm::TargetMachine> m_target_machine;
 	bool m_emit_llvm;
 	std::string m_optimization_level;
@@ -0,0 +1,63 @@
+#pragma once
+#include "codegen_context.hpp"
+#include "ast.hpp"
+
+#include <llvm/ADT/SmallVector.h>
+
+namespace toycc
+{
+
+struct CodeGenOptions
+{
+	/// 工作线程个数, 0代表在当前线程中直接生成到单个Module
+	unsigned threads = 0;
+	/// 每个任务包含的函数个数, 与线程个数无关, 保证输出结果稳定
+	std::size_t funcs_per_job = 32;
+	/// 局部标量变量直接生成SSA形式
+	bool direct_ssa = false;
+	/// 编译期求值eval函数时执行的语句数上限
+	std::size_t eval_step_limit = 1048576;
+	/// 编译期求值eval函数时的调用深度上限
+	std::size_t eval_depth_limit = 512;
+};
+
+/**
+ * @brief 并行生成函数体
+ * @details 主线程先生成所有函数声明并检查声明阶段的错误, 之后按源代码顺序
+ *          将函数划分为固定大小的任务, 工作线程从队列中领取任务, 在独立的
+ *          LLVMContext中生成函数体并输出bitcode, 最后主线程按任务顺序读取
+ *          并链接到同一个Module
+ * @note 任务的划分和链接顺序与线程个数无关, 输出与线程个数无关
+ */
+class ParallelCodeGen
+{
+public:
+	ParallelCodeGen(std::shared_ptr<CodeGenContext> cg_context,
+					CodeGenOptions options);
+
+	/// @return 出错返回nullptr
+	[[nodiscard]]
+	auto operator()(CompUnit& comp_unit) -> std::unique_ptr<llvm::Module>;
+
+private:
+	struct Job
+	{
+		std::size_t begin;
+		std::size_t end;
+		bool success;
+		llvm::SmallVector<char, 0> bitcode;
+	};
+
+	/// @brief 在工作线程中生成job范围内的函数体
+	void run_job(Job& job, CompUnit& comp_unit);
+
+	/// @brief 按顺序将各个任务的结果链接到module
+	[[nodiscard]]
+	auto link_jobs(llvm::Module& module, std::vector<Job>& jobs) -> bool;
+
+private:
+	std::shared_ptr<CodeGenContext> m_cg_context;
+	CodeGenOptions m_options;
+};
+
+}	//namespace toycc
@@ -0,0 +1,78 @@
+#pragma once
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <llvm/IR/BasicBlock.h>
+#include <llvm/IR/Instructions.h>
+#include <llvm/IR/ValueHandle.h>
+#include "symbol_table.hpp"
+
+namespace toycc
+{
+
+/**
+ * @brief 在生成IR的同时直接构造SSA形式的局部变量
+ * @details 依据 Braun et al. "Simple and Efficient Construction of Static
+ *          Single Assignment Form" (CC 2013):
+ *          1. 每个基本块记录变量的当前定义;
+ *          2. 在未封闭(前驱尚未全部生成)的基本块中读取变量时, 先创建不完整的phi,
+ *             基本块封闭时再补全操作数;
+ *          3. 所有操作数相同的phi被替换为该值并删除
+ * @note 每个函数使用一个实例, 变量以SymbolEntry的地址区分
+ */
+class SSABuilder
+{
+public:
+	SSABuilder() = default;
+	SSABuilder(const SSABuilder&) = delete;
+	auto operator=(const SSABuilder&) -> SSABuilder& = delete;
+
+	/// @brief 记录变量var在block中的当前定义
+	void write_variable(const SymbolEntry* var, llvm::BasicBlock* block,
+						llvm::Value* value);
+
+	/// @brief 读取变量var在block末尾的值, 必要时插入phi
+	[[nodiscard]]
+	auto read_variable(const SymbolEntry* var, llvm::BasicBlock* block)
+		-> llvm::Value*;
+
+	/**
+	 * @brief 声明block的所有前驱都已经生成, 补全其中的不完整phi
+	 * @note 重复调用没有效果
+	 */
+	void seal_block(llvm::BasicBlock* block);
+
+	/// @brief 封闭函数中剩余的基本块, 在函数生成结束时调用
+	void seal_remaining(llvm::Function* func);
+
+private:
+	[[nodiscard]]
+	auto read_variable_recursive(const SymbolEntry* var,
+								 llvm::BasicBlock* block) -> llvm::Value*;
+
+	auto add_phi_operands(const SymbolEntry* var, llvm::PHINode* phi)
+		-> llvm::Value*;
+
+	/// @return 替换phi的值, phi不是平凡的时返回phi
+	auto try_remove_trivial_phi(llvm::PHINode* phi) -> llvm::Value*;
+
+	[[nodiscard]]
+	auto create_phi(const SymbolEntry* var, llvm::BasicBlock* block)
+		-> llvm::PHINode*;
+
+	[[nodiscard]]
+	auto is_sealed(llvm::BasicBlock* block) const -> bool
+	{ return m_sealed.contains(block); }
+
+private:
+	/// 使用WeakTrackingVH, 删除平凡phi时通过RAUW自动更新
+	std::unordered_map<llvm::BasicBlock*,
+		std::unordered_map<const SymbolEntry*, llvm::WeakTrackingVH>>
+		m_current_def;
+	std::unordered_map<llvm::BasicBlock*,
+		std::vector<std::pair<const SymbolEntry*, llvm::PHINode*>>>
+		m_incomplete_phis;
+	std::unordered_set<llvm::BasicBlock*> m_sealed;
+};
+
+}	//namespace toycc
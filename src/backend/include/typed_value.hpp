@@ -0,0 +1,44 @@
+#pragma once
+#include <cstddef>
+#include <optional>
+#include <llvm/IR/ConstantRange.h>
+#include <llvm/IR/Value.h>
+#include "type_id.hpp"
+
+namespace toycc
+{
+
+/**
+ * @brief 表达式的值及其在C语言中的类型
+ * @details llvm::Type不区分有无符号, 运算指令(sdiv/udiv, icmp slt/ult, nsw)
+ *          需要依据操作数的类型选择
+ */
+struct TypedValue
+{
+	TypedValue() = default;
+	/// 用于出错时返回
+	TypedValue(std::nullptr_t) {}
+	TypedValue(llvm::Value* value_, TypeId type_,
+			   std::optional<llvm::ConstantRange> range_ = std::nullopt):
+		value { value_ }, type { type_ }, range { std::move(range_) }
+	{}
+
+	[[nodiscard]]
+	explicit operator bool() const
+	{ return value != nullptr; }
+
+	[[nodiscard]]
+	auto operator->() const -> llvm::Value*
+	{ return value; }
+
+	[[nodiscard]]
+	friend auto operator==(const TypedValue& lhs, std::nullptr_t) -> bool
+	{ return lhs.value == nullptr; }
+
+	llvm::Value* value = nullptr;
+	TypeId type = TypeId::ty_void;
+	/// 已知的取值范围, 宽度与value的类型相同, 为空时由get_range推导
+	std::optional<llvm::ConstantRange> range;
+};
+
+}	//namespace toycc
@@ -0,0 +1,31 @@
+#pragma once
+#include <optional>
+#include <llvm/IR/ConstantRange.h>
+#include <llvm/IR/Value.h>
+#include "typed_value.hpp"
+
+namespace toycc
+{
+
+/**
+ * @brief 表达式的取值范围
+ * @details 依次使用TypedValue中记录的范围, 整数常量的值和整数类型的完整范围;
+ *          比较和逻辑运算的结果为i1, 其完整范围即为[0, 1]
+ * @return 非整数类型返回std::nullopt
+ */
+[[nodiscard]]
+auto get_range(const TypedValue& value) -> std::optional<llvm::ConstantRange>;
+
+/**
+ * @brief 依据生成的指令和操作数推导运算结果的范围
+ * @param result 二元运算或一元运算生成的值
+ * @param left,right 与指令的操作数顺序一致, 例如取负(sub 0, x)的left为0
+ * @return 无法推导时返回std::nullopt, 由get_range使用类型的完整范围
+ * @note IRBuilder化简时可能返回已有的值: 返回操作数本身时沿用其范围,
+ *       只有操作数恰为left和right的指令才按其操作码推导, 常量由get_range处理
+ */
+[[nodiscard]]
+auto infer_range(llvm::Value* result, const TypedValue& left,
+				 const TypedValue& right) -> std::optional<llvm::ConstantRange>;
+
+}	//namespace toycc
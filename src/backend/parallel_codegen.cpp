@@ -0,0 +1,145 @@
+#include "parallel_codegen.hpp"
+#include "codegen_visitor.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+#include <llvm/Bitcode/BitcodeReader.h>
+#include <llvm/Bitcode/BitcodeWriter.h>
+#include <llvm/Linker/Linker.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/raw_ostream.h>
+
+namespace toycc
+{
+
+ParallelCodeGen::ParallelCodeGen(std::shared_ptr<CodeGenContext> cg_context,
+								 CodeGenOptions options):
+	m_cg_context { cg_context },
+	m_options { options }
+{
+	if (m_options.funcs_per_job == 0)
+		m_options.funcs_per_job = 1;
+}
+
+auto ParallelCodeGen::operator()(CompUnit& comp_unit)
+	-> std::unique_ptr<llvm::Module>
+{
+	auto& logger = m_cg_context->get_logger();
+
+	if (m_options.threads == 0)
+	{
+		CodeGenVisitor visitor { m_cg_context };
+		visitor.set_direct_ssa(m_options.direct_ssa);
+		visitor.set_eval_limits(m_options.eval_step_limit,
+								m_options.eval_depth_limit);
+		if (!visitor.visit(&comp_unit))
+			return nullptr;
+		return visitor.get_result();
+	}
+
+	// 声明阶段, 只在主线程报告重复定义等错误
+	CodeGenVisitor declare_visitor { m_cg_context };
+	declare_visitor.set_body_range(0, 0);
+	declare_visitor.set_eval_limits(m_options.eval_step_limit,
+									m_options.eval_depth_limit);
+	if (!declare_visitor.visit(&comp_unit))
+		return nullptr;
+	auto module = declare_visitor.get_result();
+
+	// 任务按函数定义划分, 模块中还有外部函数和内建函数的声明
+	auto func_count = declare_visitor.get_func_def_count();
+	std::vector<Job> jobs;
+	for (std::size_t begin = 0; begin < func_count;
+		 begin += m_options.funcs_per_job)
+	{
+		auto end = std::min(begin + m_options.funcs_per_job, func_count);
+		jobs.push_back(Job { begin, end, false, {} });
+	}
+
+	auto thread_count = std::min<std::size_t>(m_options.threads, jobs.size());
+	logger.debug("Generate {} functions in {} jobs with {} threads",
+				 func_count, jobs.size(), thread_count);
+
+	std::atomic<std::size_t> next_job { 0 };
+	{
+		std::vector<std::jthread> workers;
+		workers.reserve(thread_count);
+		for (std::size_t i = 0; i < thread_count; ++i)
+		{
+			workers.emplace_back([&] {
+				for (auto idx = next_job.fetch_add(1, std::memory_order_relaxed);
+					 idx < jobs.size();
+					 idx = next_job.fetch_add(1, std::memory_order_relaxed))
+				{
+					run_job(jobs[idx], comp_unit);
+				}
+			});
+		}
+	}
+
+	if (!std::ranges::all_of(jobs, &Job::success))
+		return nullptr;
+
+	if (!link_jobs(*module, jobs))
+		return nullptr;
+
+	return module;
+}
+
+void ParallelCodeGen::run_job(Job& job, CompUnit& comp_unit)
+{
+	auto context = m_cg_context->fork();
+
+	CodeGenVisitor visitor { context };
+	visitor.set_body_range(job.begin, job.end);
+	visitor.set_direct_ssa(m_options.direct_ssa);
+	visitor.set_eval_limits(m_options.eval_step_limit,
+							m_options.eval_depth_limit);
+	// 全局变量由声明阶段的模块定义
+	visitor.set_define_globals(false);
+	job.success = visitor.visit(&comp_unit);
+	if (!job.success)
+		return;
+
+	auto module = visitor.get_result();
+	llvm::raw_svector_ostream os { job.bitcode };
+	llvm::WriteBitcodeToFile(*module, os);
+}
+
+auto ParallelCodeGen::link_jobs(llvm::Module& module, std::vector<Job>& jobs)
+	-> bool
+{
+	auto& logger = m_cg_context->get_logger();
+	llvm::Linker linker { module };
+
+	for (auto& job : jobs)
+	{
+		llvm::MemoryBufferRef buffer {
+			llvm::StringRef { job.bitcode.data(), job.bitcode.size() },
+			module.getModuleIdentifier()
+		};
+		auto module_or_error =
+			llvm::parseBitcodeFile(buffer, module.getContext());
+		if (!module_or_error)
+		{
+			logger.error("Failed to read generated bitcode: {}",
+						 llvm::toString(module_or_error.takeError()));
+			return false;
+		}
+
+		// 返回true代表出错
+		if (linker.linkInModule(std::move(*module_or_error)))
+		{
+			logger.error("Failed to link functions [{}, {})", job.begin,
+						 job.end);
+			return false;
+		}
+		job.bitcode.clear();
+	}
+
+	return true;
+}
+
+}	//namespace toycc
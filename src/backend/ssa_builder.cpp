@@ -0,0 +1,143 @@
+#include "ssa_builder.hpp"
+
+#include <llvm/IR/CFG.h>
+#include <llvm/IR/Constants.h>
+#include <llvm/IR/Function.h>
+
+namespace toycc
+{
+
+void SSABuilder::write_variable(const SymbolEntry* var, llvm::BasicBlock* block,
+								llvm::Value* value)
+{
+	assert(var->type == SymbolEntry::ssa_value);
+	m_current_def[block][var] = value;
+}
+
+auto SSABuilder::read_variable(const SymbolEntry* var, llvm::BasicBlock* block)
+	-> llvm::Value*
+{
+	auto block_itr = m_current_def.find(block);
+	if (block_itr != m_current_def.end())
+	{
+		auto itr = block_itr->second.find(var);
+		if (itr != block_itr->second.end() && itr->second != nullptr)
+			return itr->second;
+	}
+
+	return read_variable_recursive(var, block);
+}
+
+auto SSABuilder::read_variable_recursive(const SymbolEntry* var,
+										 llvm::BasicBlock* block)
+	-> llvm::Value*
+{
+	llvm::Value* value = nullptr;
+
+	if (!is_sealed(block))
+	{
+		// 前驱未知, 先放置不完整的phi
+		auto phi = create_phi(var, block);
+		m_incomplete_phis[block].emplace_back(var, phi);
+		value = phi;
+	}
+	else if (auto pred = block->getSinglePredecessor())
+	{
+		// 只有一个前驱时不需要phi
+		value = read_variable(var, pred);
+	}
+	else if (llvm::pred_empty(block))
+	{
+		// 入口块或不可达块, 变量未初始化
+		value = llvm::UndefValue::get(var->ssa_type);
+	}
+	else
+	{
+		// 先写入phi以打破循环中的递归
+		auto phi = create_phi(var, block);
+		write_variable(var, block, phi);
+		value = add_phi_operands(var, phi);
+	}
+
+	write_variable(var, block, value);
+	return value;
+}
+
+auto SSABuilder::add_phi_operands(const SymbolEntry* var, llvm::PHINode* phi)
+	-> llvm::Value*
+{
+	// 前驱中重复的边也需要对应的phi操作数
+	for (auto pred : llvm::predecessors(phi->getParent()))
+		phi->addIncoming(read_variable(var, pred), pred);
+
+	return try_remove_trivial_phi(phi);
+}
+
+auto SSABuilder::try_remove_trivial_phi(llvm::PHINode* phi) -> llvm::Value*
+{
+	llvm::Value* same = nullptr;
+	for (auto& op : phi->incoming_values())
+	{
+		if (op == same || op == phi)
+			continue;
+		// 存在至少两个不同的值
+		if (same != nullptr)
+			return phi;
+		same = op;
+	}
+
+	if (same == nullptr)
+		same = llvm::UndefValue::get(phi->getType());
+
+	// 删除后可能变为平凡的phi, 其中不完整的phi在所在块封闭时处理
+	std::vector<llvm::WeakVH> phi_users;
+	for (auto user : phi->users())
+	{
+		auto user_phi = llvm::dyn_cast<llvm::PHINode>(user);
+		if (user_phi != nullptr && user_phi != phi
+			&& is_sealed(user_phi->getParent()))
+		{
+			phi_users.emplace_back(user_phi);
+		}
+	}
+
+	phi->replaceAllUsesWith(same);
+	phi->eraseFromParent();
+
+	for (auto& user : phi_users)
+	{
+		if (auto user_phi = llvm::dyn_cast_or_null<llvm::PHINode>(user))
+			try_remove_trivial_phi(user_phi);
+	}
+
+	return same;
+}
+
+auto SSABuilder::create_phi(const SymbolEntry* var, llvm::BasicBlock* block)
+	-> llvm::PHINode*
+{
+	if (block->empty())
+		return llvm::PHINode::Create(var->ssa_type, 0, "", block);
+	return llvm::PHINode::Create(var->ssa_type, 0, "", &block->front());
+}
+
+void SSABuilder::seal_block(llvm::BasicBlock* block)
+{
+	if (is_sealed(block))
+		return;
+
+	auto incomplete = std::move(m_incomplete_phis[block]);
+	m_incomplete_phis.erase(block);
+	for (auto [var, phi] : incomplete)
+		add_phi_operands(var, phi);
+
+	m_sealed.insert(block);
+}
+
+void SSABuilder::seal_remaining(llvm::Function* func)
+{
+	for (auto& block : *func)
+		seal_block(&block);
+}
+
+}	//namespace toycc
@@ -0,0 +1,69 @@
+#include <llvm/IR/Constants.h>
+#include <llvm/IR/InstrTypes.h>
+#include <llvm/IR/Instructions.h>
+#include <llvm/IR/Operator.h>
+#include "value_range.hpp"
+
+namespace toycc
+{
+
+auto get_range(const TypedValue& value) -> std::optional<llvm::ConstantRange>
+{
+	if (value.range)
+		return value.range;
+	if (auto constant = llvm::dyn_cast<llvm::ConstantInt>(value.value))
+		return llvm::ConstantRange { constant->getValue() };
+	if (auto type = llvm::dyn_cast<llvm::IntegerType>(value->getType()))
+		return llvm::ConstantRange::getFull(type->getBitWidth());
+	return std::nullopt;
+}
+
+auto infer_range(llvm::Value* result, const TypedValue& left,
+				 const TypedValue& right) -> std::optional<llvm::ConstantRange>
+{
+	// InstSimplifyFolder可能返回已有的值(x + 0, x * 1返回x), 其范围即操作数的范围
+	if (result == left.value)
+		return get_range(left);
+	if (result == right.value)
+		return get_range(right);
+
+	// 其余被化简的结果可能是其他操作数的已有指令, 其操作码与当前运算无关,
+	// 只有操作数恰为left和right的新指令才能用操作数的范围推导
+	auto inst = llvm::dyn_cast<llvm::Instruction>(result);
+	if (inst == nullptr || inst->getNumOperands() != 2
+		|| inst->getOperand(0) != left.value || inst->getOperand(1) != right.value)
+		return std::nullopt;
+	auto left_range = get_range(left);
+	auto right_range = get_range(right);
+	if (!left_range || !right_range)
+		return std::nullopt;
+
+	if (auto cmp = llvm::dyn_cast<llvm::ICmpInst>(inst))
+	{
+		// 范围可以确定比较结果时, 结果为单值
+		auto pred = cmp->getPredicate();
+		if (left_range->icmp(pred, *right_range))
+			return llvm::ConstantRange { llvm::APInt(1, 1) };
+		if (left_range->icmp(llvm::CmpInst::getInversePredicate(pred), *right_range))
+			return llvm::ConstantRange { llvm::APInt(1, 0) };
+		return std::nullopt;
+	}
+
+	auto binary = llvm::dyn_cast<llvm::BinaryOperator>(inst);
+	if (binary == nullptr || !binary->getType()->isIntegerTy())
+		return std::nullopt;
+
+	auto opcode = binary->getOpcode();
+	if (auto overflowing = llvm::dyn_cast<llvm::OverflowingBinaryOperator>(binary))
+	{
+		unsigned no_wrap_kind = 0;
+		if (overflowing->hasNoSignedWrap())
+			no_wrap_kind |= llvm::OverflowingBinaryOperator::NoSignedWrap;
+		if (overflowing->hasNoUnsignedWrap())
+			no_wrap_kind |= llvm::OverflowingBinaryOperator::NoUnsignedWrap;
+		return left_range->overflowingBinaryOp(opcode, *right_range, no_wrap_kind);
+	}
+	return left_range->binaryOp(opcode, *right_range);
+}
+
+}	//namespace toycc
@@ -1,5 +1,6 @@
 #include <cassert>
 #include "base_components_ast.hpp"
+#include "expr_ast.hpp"
 
 namespace toycc
 {
@@ -25,11 +26,22 @@ auto Ident::get_value() const -> std::string_view
 
 
 /// Type
-ScalarType::ScalarType(std::unique_ptr<Location> location, BuiltinTypeEnum type)
-	: BaseAST { ast_scalar_type, std::move(location) }, m_type { type }
+ScalarType::ScalarType(std::unique_ptr<Location> location, BuiltinTypeEnum type,
+					   unsigned lanes)
+	: BaseAST { ast_scalar_type, std::move(location) }, m_type { type },
+	  m_lanes { lanes }
 {
 	assert(m_type != BuiltinTypeEnum::ty_void
 		&& "ScalarType doesnot support void type");
+	assert(m_type != BuiltinTypeEnum::ty_struct
+		&& "struct type requires a name");
+}
+
+ScalarType::ScalarType(std::unique_ptr<Location> location, std::string struct_name)
+	: BaseAST { ast_scalar_type, std::move(location) },
+	  m_type { BuiltinTypeEnum::ty_struct }, m_lanes { 0 },
+	  m_struct_name { std::move(struct_name) }
+{
 }
 
 auto ScalarType::get_type() const -> BuiltinTypeEnum
@@ -43,9 +55,15 @@ auto ScalarType::get_type_str() const -> const char*
 }
 
 
-BuiltinType::BuiltinType(std::unique_ptr<Location> location, BuiltinTypeEnum type)
-	: BaseAST{ast_builtin_type, std::move(location)}, m_type{type}
+BuiltinType::BuiltinType(std::unique_ptr<Location> location, BuiltinTypeEnum type,
+						 unsigned lanes, std::string struct_name)
+	: BaseAST{ast_builtin_type, std::move(location)}, m_type{type},
+	  m_lanes{lanes}, m_struct_name{std::move(struct_name)}
 {
+	assert((m_lanes == 0 || m_type != BuiltinTypeEnum::ty_void)
+		&& "void cannot be a vector");
+	assert((m_type == BuiltinTypeEnum::ty_struct) != m_struct_name.empty()
+		&& "only struct type has a name");
 }
 
 auto BuiltinType::get_type() const -> BuiltinTypeEnum
@@ -63,8 +81,60 @@ LVal::LVal(std::unique_ptr<Location> location, std::unique_ptr<Ident> ident):
 	m_ident { std::move(ident) }
 {}
 
+LVal::LVal(std::unique_ptr<Location> location, std::unique_ptr<LVal> lval,
+		   std::unique_ptr<Expr> index):
+	BaseAST { ast_lval, std::move(location) },
+	m_ident { std::move(lval->m_ident) },
+	m_base { std::move(lval->m_base) },
+	m_member { std::move(lval->m_member) },
+	m_arrow { lval->m_arrow },
+	m_indices { std::move(lval->m_indices) }
+{
+	assert(index);
+	m_indices.push_back(std::move(index));
+}
+
+LVal::LVal(std::unique_ptr<Location> location,
+		   std::unique_ptr<UnaryExpr> pointer):
+	BaseAST { ast_lval, std::move(location) },
+	m_pointer { std::move(pointer) }
+{
+	assert(m_pointer);
+}
+
+LVal::LVal(std::unique_ptr<Location> location, std::unique_ptr<LVal> base,
+		   std::unique_ptr<Ident> member, bool arrow):
+	BaseAST { ast_lval, std::move(location) },
+	m_base { std::move(base) },
+	m_member { std::move(member) },
+	m_arrow { arrow }
+{
+	assert(m_base && m_member);
+}
+
+LVal::~LVal() = default;
+
+auto LVal::get_base() const -> const LVal&
+{
+	assert(m_base);
+	return *m_base;
+}
+
+auto LVal::get_member() const -> const Ident&
+{
+	assert(m_member);
+	return *m_member;
+}
+
+auto LVal::get_pointer() const -> const UnaryExpr&
+{
+	assert(m_pointer);
+	return *m_pointer;
+}
+
 auto LVal::get_id() const -> const Ident&
 {
+	assert(m_ident);
 	return *m_ident;
 }
 
@@ -1,3 +1,4 @@
+#include <cassert>
 #include "decl_ast.hpp"
 
 namespace toycc
@@ -149,6 +150,56 @@ auto InitVal::get_expr() const -> const Expr&
     return *m_expr;
 }
 
+// Pointer implementation
+Pointer::Pointer(std::unique_ptr<Location> location)
+    : BaseAST{ast_pointer, std::move(location)}
+{
+}
+
+void Pointer::add_level(bool is_restrict)
+{
+    m_restrict.push_back(is_restrict);
+}
+
+// ArrayDims implementation
+ArrayDims::ArrayDims(std::unique_ptr<Location> location)
+    : BaseAST{ast_array_dims, std::move(location)}
+{
+}
+
+void ArrayDims::add_dim(std::unique_ptr<ConstExpr> dim)
+{
+    m_dims.push_back(std::move(dim));
+}
+
+// Attribute implementation
+Attribute::Attribute(std::unique_ptr<Location> location,
+                     std::unique_ptr<Ident> name,
+                     std::unique_ptr<Number> value)
+    : BaseAST{ast_attribute, std::move(location)},
+      m_name{std::move(name)},
+      m_value{std::move(value)}
+{
+}
+
+Attribute::Attribute(std::unique_ptr<Location> location,
+                     std::unique_ptr<Ident> name)
+    : BaseAST{ast_attribute, std::move(location)},
+      m_name{std::move(name)}
+{
+}
+
+auto Attribute::get_name() const -> const Ident&
+{
+    return *m_name;
+}
+
+auto Attribute::get_value() const -> const Number&
+{
+    assert(m_value);
+    return *m_value;
+}
+
 // VarDef implementation
 VarDef::VarDef(std::unique_ptr<Location> location, std::unique_ptr<Ident> ident)
     : BaseAST{ast_var_def, std::move(location)},
@@ -168,6 +219,40 @@ VarDef::VarDef(std::unique_ptr<Location> location,
 {
 }
 
+VarDef::VarDef(std::unique_ptr<Location> location,
+               std::unique_ptr<Pointer> pointer,
+               std::unique_ptr<Ident> ident,
+               std::unique_ptr<ArrayDims> dims,
+               std::unique_ptr<Attribute> attribute,
+               std::unique_ptr<InitVal> init_val)
+    : BaseAST{ast_var_def, std::move(location)},
+      m_initialized{init_val != nullptr},
+      m_pointer{std::move(pointer)},
+      m_ident{std::move(ident)},
+      m_dims{std::move(dims)},
+      m_attribute{std::move(attribute)},
+      m_init_val{std::move(init_val)}
+{
+}
+
+auto VarDef::get_pointer() const -> const Pointer&
+{
+    assert(m_pointer);
+    return *m_pointer;
+}
+
+auto VarDef::get_dims() const -> const ArrayDims&
+{
+    assert(m_dims);
+    return *m_dims;
+}
+
+auto VarDef::get_attribute() const -> const Attribute&
+{
+    assert(m_attribute);
+    return *m_attribute;
+}
+
 auto VarDef::is_initialized() const -> bool
 {
     return m_initialized;
@@ -232,5 +317,39 @@ auto VarDecl::get_var_def_list() const -> const VarDefList&
     return *m_var_def_list;
 }
 
-}	//namespace toycc
+// StructDef implementation
+StructDef::StructDef(std::unique_ptr<Location> location,
+                     std::unique_ptr<Ident> ident)
+    : BaseAST{ast_struct_def, std::move(location)},
+      m_ident{std::move(ident)}
+{
+}
 
+StructDef::StructDef(std::unique_ptr<Location> location,
+                     std::unique_ptr<StructDef> rhs,
+                     std::unique_ptr<VarDecl> field)
+    : BaseAST{ast_struct_def, std::move(location)},
+      m_ident{std::move(rhs->m_ident)},
+      m_fields{std::move(rhs->m_fields)},
+      m_attributes{std::move(rhs->m_attributes)}
+{
+    m_fields.push_back(std::move(field));
+}
+
+StructDef::StructDef(std::unique_ptr<Location> location,
+                     std::unique_ptr<StructDef> rhs,
+                     std::unique_ptr<Attribute> attribute)
+    : BaseAST{ast_struct_def, std::move(location)},
+      m_ident{std::move(rhs->m_ident)},
+      m_fields{std::move(rhs->m_fields)},
+      m_attributes{std::move(rhs->m_attributes)}
+{
+    m_attributes.push_back(std::move(attribute));
+}
+
+auto StructDef::get_ident() const -> const Ident&
+{
+    return *m_ident;
+}
+
+}	//namespace toycc
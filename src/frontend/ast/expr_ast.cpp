@@ -161,7 +161,7 @@ UnaryExpr::UnaryExpr(std::unique_ptr<Location> location,
 	BaseExpr(ast_unary_expr, std::move(location)),
 	m_type { type }, m_ident { std::move(ident) }
 {
-	assert(m_type == UnaryType::call);
+	assert(m_type == UnaryType::call || m_type == UnaryType::label_address);
 }
 
 UnaryExpr::UnaryExpr(std::unique_ptr<Location> location,
@@ -175,6 +175,15 @@ UnaryExpr::UnaryExpr(std::unique_ptr<Location> location,
 	assert(m_type == UnaryType::call_with_params);
 }
 
+UnaryExpr::UnaryExpr(std::unique_ptr<Location> location,
+		  UnaryType type,
+		  std::unique_ptr<LVal> lval):
+	BaseExpr(ast_unary_expr, std::move(location)),
+	m_type { type }, m_lval { std::move(lval) }
+{
+	assert(m_type == UnaryType::address_of);
+}
+
 auto UnaryExpr::get_unary_type() const -> UnaryType
 {
 	return m_type;
@@ -200,7 +209,8 @@ auto UnaryExpr::get_unary_expr() const -> const UnaryExpr&
 
 auto UnaryExpr::get_ident() const -> const Ident&
 {
-	assert(m_type == UnaryType::call || m_type == UnaryType::call_with_params);
+	assert(m_type == UnaryType::call || m_type == UnaryType::call_with_params
+		   || m_type == UnaryType::label_address);
 	return *m_ident;
 }
 
@@ -210,6 +220,12 @@ auto UnaryExpr::get_passing_params() const -> const PassingParams&
 	return *m_passing_params;
 }
 
+auto UnaryExpr::get_lval() const -> const LVal&
+{
+	assert(m_type == UnaryType::address_of);
+	return *m_lval;
+}
+
 /// BinaryExpr
 template <typename SelfExpr, typename HigherExpr, typename Op>
 	requires std::is_base_of_v<::toycc::Operator, Op>
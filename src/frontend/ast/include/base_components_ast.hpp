@@ -1,4 +1,5 @@
 #pragma once
+#include <vector>
 #include "base_ast.hpp"
 
 namespace toycc
@@ -46,6 +47,8 @@ enum class BuiltinTypeEnum
 	ty_void,
 	ty_signed_int,
 	ty_unsigned_int,
+	/// 具体的结构体由名称确定
+	ty_struct,
 };
 
 [[nodiscard]] constexpr
@@ -59,6 +62,8 @@ auto get_builtin_type_str(BuiltinTypeEnum type) -> const char*
 		return "signed_int";
 	case BuiltinTypeEnum::ty_unsigned_int:
 		return "unsigned_int";
+	case BuiltinTypeEnum::ty_struct:
+		return "struct";
 	default:
 		return "unkown";
 	}
@@ -66,20 +71,42 @@ auto get_builtin_type_str(BuiltinTypeEnum type) -> const char*
 
 
 /**
- * ScalarType		::= SINT | UINT 	#在lexer.ll中定义其正则表达式
+ * ScalarType		::= SINT | UINT | SINT_VECTOR | UINT_VECTOR
+ * 					  | "struct" Ident
+ * 					#在lexer.ll中定义其正则表达式
+ * @note intN/unsignedN(N为2, 4, 8, 16)表示N个通道的向量, 通道类型为type
  */
 class ScalarType: public BaseAST
 {
 public:
 	TOYCC_AST_FILL_CLASSOF(ast_scalar_type)
-	ScalarType(std::unique_ptr<Location> location, BuiltinTypeEnum type);
+	/// @param lanes 向量的通道数, 0表示标量
+	ScalarType(std::unique_ptr<Location> location, BuiltinTypeEnum type,
+			   unsigned lanes = 0);
+	/// @brief 名为struct_name的结构体
+	ScalarType(std::unique_ptr<Location> location, std::string struct_name);
 
 	[[nodiscard]]
 	auto get_type() const -> BuiltinTypeEnum;
 	[[nodiscard]]
 	auto get_type_str() const -> const char*;
+	[[nodiscard]]
+	auto is_vector() const -> bool
+	{ return m_lanes != 0; }
+	[[nodiscard]]
+	auto get_lanes() const -> unsigned
+	{ return m_lanes; }
+	[[nodiscard]]
+	auto is_struct() const -> bool
+	{ return m_type == BuiltinTypeEnum::ty_struct; }
+	/// @note 只对结构体有意义
+	[[nodiscard]]
+	auto get_struct_name() const -> std::string_view
+	{ return m_struct_name; }
 private:
 	BuiltinTypeEnum m_type;
+	unsigned m_lanes;
+	std::string m_struct_name;
 
 };
 
@@ -92,32 +119,98 @@ class BuiltinType : public BaseAST
 {
 public:
 	TOYCC_AST_FILL_CLASSOF(ast_builtin_type)
-	BuiltinType(std::unique_ptr<Location> location, BuiltinTypeEnum type);
+	/// @param lanes, struct_name 同ScalarType, 函数可以返回向量或结构体指针
+	BuiltinType(std::unique_ptr<Location> location, BuiltinTypeEnum type,
+				unsigned lanes = 0, std::string struct_name = {});
 
 	[[nodiscard]]
 	auto get_type() const -> BuiltinTypeEnum;
 	[[nodiscard]]
 	auto get_type_str() const -> const char*;
+	[[nodiscard]]
+	auto is_vector() const -> bool
+	{ return m_lanes != 0; }
+	[[nodiscard]]
+	auto get_lanes() const -> unsigned
+	{ return m_lanes; }
+	[[nodiscard]]
+	auto is_struct() const -> bool
+	{ return m_type == BuiltinTypeEnum::ty_struct; }
+	[[nodiscard]]
+	auto get_struct_name() const -> std::string_view
+	{ return m_struct_name; }
 
 private:
 	BuiltinTypeEnum m_type;
+	unsigned m_lanes;
+	std::string m_struct_name;
 };
 
 
+class Expr;
+class UnaryExpr;
+
 /**
- *LVal		::= Ident;
+ *LVal		::= SubscriptLVal | "*" UnaryExpr;
+ *SubscriptLVal	::= Ident | SubscriptLVal "[" Expr "]"
+ *				  | SubscriptLVal "." Ident | SubscriptLVal "->" Ident;
+ *@note 成员访问的左值以访问前的左值为基础, 之后的下标作用于成员
  */
 class LVal: public BaseAST
 {
 public:
 	TOYCC_AST_FILL_CLASSOF(ast_lval);
+	using Vector = std::vector<std::unique_ptr<Expr>>;
 
 	LVal(std::unique_ptr<Location> location, std::unique_ptr<Ident> ident);
+	/// @brief 在lval的下标之后追加一个下标
+	LVal(std::unique_ptr<Location> location, std::unique_ptr<LVal> lval,
+		 std::unique_ptr<Expr> index);
+	/// @brief 解引用pointer得到的对象
+	LVal(std::unique_ptr<Location> location,
+		 std::unique_ptr<UnaryExpr> pointer);
+	/// @brief base.member, arrow为true时是base->member
+	LVal(std::unique_ptr<Location> location, std::unique_ptr<LVal> base,
+		 std::unique_ptr<Ident> member, bool arrow);
+	~LVal();
+
+	/// @brief 以变量名开始, 可以带有下标
+	[[nodiscard]]
+	auto is_named() const -> bool
+	{ return m_ident != nullptr; }
+	[[nodiscard]]
+	auto is_dereference() const -> bool
+	{ return m_pointer != nullptr; }
+	[[nodiscard]]
+	auto is_member() const -> bool
+	{ return m_base != nullptr; }
+	[[nodiscard]]
+	auto is_arrow() const -> bool
+	{ return m_arrow; }
+	[[nodiscard]]
+	auto get_base() const -> const LVal&;
+	[[nodiscard]]
+	auto get_member() const -> const Ident&;
+	[[nodiscard]]
+	auto get_pointer() const -> const UnaryExpr&;
+	/// @note 只有is_named()的左值有标识符
 	[[nodiscard]]
 	auto get_id() const -> const Ident&;
+	[[nodiscard]]
+	auto has_indices() const -> bool
+	{ return !m_indices.empty(); }
+	/// @brief 从外层到内层的下标
+	[[nodiscard]]
+	auto get_indices() const -> const Vector&
+	{ return m_indices; }
 
 private:
 	std::unique_ptr<Ident> m_ident;
+	std::unique_ptr<UnaryExpr> m_pointer;
+	std::unique_ptr<LVal> m_base;
+	std::unique_ptr<Ident> m_member;
+	bool m_arrow = false;
+	Vector m_indices;
 };
 
 }	//namespace toycc
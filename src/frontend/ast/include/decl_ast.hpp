@@ -109,7 +109,96 @@ private:
 };
 
 
-/// VarDef 			::= Ident | Ident "=" InitVal;
+///	Pointer			::= /* empty */ | Pointer "*" | Pointer "*" "restrict";
+/// @note 按声明顺序记录每一级指针, 最后一级修饰被声明的对象本身
+class Pointer: public BaseAST
+{
+public:
+	TOYCC_AST_FILL_CLASSOF(ast_pointer);
+	Pointer(std::unique_ptr<Location> location);
+
+	/// @param is_restrict 该级指针是否带有restrict限定
+	void add_level(bool is_restrict);
+
+	/// @brief 指针的级数, 为0时不是指针
+	[[nodiscard]]
+	auto get_depth() const -> std::size_t
+	{ return m_restrict.size(); }
+	[[nodiscard]]
+	auto empty() const -> bool
+	{ return m_restrict.empty(); }
+	/// @brief 被声明的指针本身是否带有restrict限定
+	[[nodiscard]]
+	auto is_restrict() const -> bool
+	{ return !m_restrict.empty() && m_restrict.back(); }
+
+private:
+	std::vector<bool> m_restrict;
+};
+
+
+///	ArrayDims		::= /* empty */ | ArrayDims "[" ConstExpr "]" | ArrayDims "[" "]";
+/// @note 省略大小的维度以nullptr表示, 只允许出现在参数的第一维
+class ArrayDims: public BaseAST
+{
+public:
+	TOYCC_AST_FILL_CLASSOF(ast_array_dims);
+	using Vector = std::vector<std::unique_ptr<ConstExpr>>;
+	ArrayDims(std::unique_ptr<Location> location);
+
+	/// @param dim 为nullptr时代表省略大小
+	void add_dim(std::unique_ptr<ConstExpr> dim);
+
+	[[nodiscard]]
+	auto begin() const -> Vector::const_iterator
+	{ return m_dims.cbegin(); }
+	[[nodiscard]]
+	auto end() const -> Vector::const_iterator
+	{ return m_dims.cend(); }
+
+	[[nodiscard]]
+	auto size() const -> std::size_t
+	{ return m_dims.size(); }
+	[[nodiscard]]
+	auto empty() const -> bool
+	{ return m_dims.empty(); }
+
+private:
+	Vector m_dims;
+};
+
+
+/**
+ * Attribute		::= "__attribute__" "(" "(" Ident "(" Number ")" ")" ")"
+ * 					  | "__attribute__" "(" "(" Ident ")" ")";
+ */
+class Attribute: public BaseAST
+{
+public:
+	TOYCC_AST_FILL_CLASSOF(ast_attribute);
+	Attribute(std::unique_ptr<Location> location, std::unique_ptr<Ident> name,
+			  std::unique_ptr<Number> value);
+	/// @brief 不带参数的属性, 如packed
+	Attribute(std::unique_ptr<Location> location, std::unique_ptr<Ident> name);
+
+	[[nodiscard]]
+	auto get_name() const -> const Ident&;
+	[[nodiscard]]
+	auto has_value() const -> bool
+	{ return m_value != nullptr; }
+	[[nodiscard]]
+	auto get_value() const -> const Number&;
+
+private:
+	std::unique_ptr<Ident> m_name;
+	std::unique_ptr<Number> m_value;
+};
+
+
+/**
+ * VarDef 			::= Pointer Ident ArrayDims [Attribute]
+ * 					  | Pointer Ident ArrayDims [Attribute] "=" InitVal;
+ */
 class VarDef: public BaseAST
 {
 public:
@@ -117,14 +206,38 @@ public:
 	VarDef(std::unique_ptr<Location> location, std::unique_ptr<Ident> ident);
 	VarDef(std::unique_ptr<Location> location, std::unique_ptr<Ident> ident,
 		   std::unique_ptr<InitVal> init_val);
+	/// @param attribute 和 init_val 可以为nullptr
+	VarDef(std::unique_ptr<Location> location, std::unique_ptr<Pointer> pointer,
+		   std::unique_ptr<Ident> ident, std::unique_ptr<ArrayDims> dims,
+		   std::unique_ptr<Attribute> attribute,
+		   std::unique_ptr<InitVal> init_val);
 
 	auto is_initialized() const -> bool;
 	auto get_ident() const -> Ident&;
 	auto get_init_val() const -> InitVal&;
+
+	[[nodiscard]]
+	auto is_pointer() const -> bool
+	{ return m_pointer != nullptr && !m_pointer->empty(); }
+	[[nodiscard]]
+	auto get_pointer() const -> const Pointer&;
+	[[nodiscard]]
+	auto is_array() const -> bool
+	{ return m_dims != nullptr && !m_dims->empty(); }
+	[[nodiscard]]
+	auto get_dims() const -> const ArrayDims&;
+	[[nodiscard]]
+	auto has_attribute() const -> bool
+	{ return m_attribute != nullptr; }
+	[[nodiscard]]
+	auto get_attribute() const -> const Attribute&;
 	
 private:
 	bool m_initialized;
+	std::unique_ptr<Pointer> m_pointer;
 	std::unique_ptr<Ident> m_ident;
+	std::unique_ptr<ArrayDims> m_dims;
+	std::unique_ptr<Attribute> m_attribute;
 	std::unique_ptr<InitVal> m_init_val;
 };
 
@@ -206,5 +319,35 @@ private:
 	Variant m_value;
 };
 
-}	//namespace toycc
+/**
+ * StructDef		::= "struct" Ident "{" {VarDecl} "}" {Attribute};
+ * @note 结构体只能在全局定义, 成员按声明顺序保存
+ */
+class StructDef: public BaseAST
+{
+public:
+	using FieldVector = std::vector<std::unique_ptr<VarDecl>>;
+	using AttributeVector = std::vector<std::unique_ptr<Attribute>>;
+	TOYCC_AST_FILL_CLASSOF(ast_struct_def);
+	StructDef(std::unique_ptr<Location> location, std::unique_ptr<Ident> ident);
+	StructDef(std::unique_ptr<Location> location, std::unique_ptr<StructDef> rhs,
+			  std::unique_ptr<VarDecl> field);
+	StructDef(std::unique_ptr<Location> location, std::unique_ptr<StructDef> rhs,
+			  std::unique_ptr<Attribute> attribute);
 
+	[[nodiscard]]
+	auto get_ident() const -> const Ident&;
+	[[nodiscard]]
+	auto get_fields() const -> const FieldVector&
+	{ return m_fields; }
+	[[nodiscard]]
+	auto get_attributes() const -> const AttributeVector&
+	{ return m_attributes; }
+
+private:
+	std::unique_ptr<Ident> m_ident;
+	FieldVector m_fields;
+	AttributeVector m_attributes;
+};
+
+}	//namespace toycc
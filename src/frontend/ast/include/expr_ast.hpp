@@ -148,7 +148,7 @@ private:
 
 
 /**
- * UnaryExpr ::= PrimaryExpr | UnaryOp UnaryExpr;
+ * UnaryExpr ::= PrimaryExpr | UnaryOp UnaryExpr | "&" LVal;
  */
 class UnaryExpr: public BaseExpr
 {
@@ -159,6 +159,10 @@ public:
 		unary_op,
 		call,
 		call_with_params,
+		/// &&Ident, 标号在所在函数中的编号
+		label_address,
+		/// &LVal, 对象的地址
+		address_of,
 	};
 
 	UnaryExpr(std::unique_ptr<Location> location,
@@ -175,6 +179,9 @@ public:
 			  UnaryType type,
 			  std::unique_ptr<Ident> ident,
 			  std::unique_ptr<PassingParams> passing_param);
+	UnaryExpr(std::unique_ptr<Location> location,
+			  UnaryType type,
+			  std::unique_ptr<LVal> lval);
 
 	[[nodiscard]]
 	auto get_unary_type() const -> UnaryType;
@@ -188,6 +195,8 @@ public:
 	auto get_ident() const -> const Ident&;
 	[[nodiscard]]
 	auto get_passing_params() const -> const PassingParams&;
+	[[nodiscard]]
+	auto get_lval() const -> const LVal&;
 
 private:
 	UnaryType m_type;
@@ -196,6 +205,7 @@ private:
 	std::unique_ptr<UnaryExpr> m_unary_expr;
 	std::unique_ptr<Ident> m_ident;
 	std::unique_ptr<PassingParams> m_passing_params;
+	std::unique_ptr<LVal> m_lval;
 };
 
 
@@ -1,4 +1,7 @@
 #pragma once
+#include <set>
+#include <string>
+#include <string_view>
 #include "base_ast.hpp"
 #include "expr_ast.hpp"
 #include "decl_ast.hpp"
@@ -12,12 +15,23 @@ class Block;
 class SimpleStmt;
 class Stmt;
 class ClosedStmt;
+class ForClause;
+class LoopHintList;
 
 enum class BranchType
 {
 	if_stmt,
 	if_else_stmt,
 	while_stmt,
+	for_stmt,
+	do_while_stmt,
+	switch_stmt,
+	/// 带有case标号的语句
+	case_stmt,
+	/// 带有default标号的语句, 没有表达式
+	default_stmt,
+	/// 带有goto标号的语句
+	label_stmt,
 	simple_stmt,
 };
 
@@ -39,9 +53,20 @@ public:
 		: BaseAST{kind, std::move(location)}, m_br_type{brtype},
 		  m_expr{std::move(expr)}, m_last_stmt{std::move(last_stmt)}
 	{
-		assert(brtype == BranchType::while_stmt);
+		assert(brtype == BranchType::while_stmt
+			|| brtype == BranchType::switch_stmt
+			|| brtype == BranchType::case_stmt
+			|| brtype == BranchType::default_stmt);
 	}
 
+	BranchStmt(AstKind kind, std::unique_ptr<Location> location,
+			   BranchType brtype, std::unique_ptr<ForClause> for_clause,
+			   std::unique_ptr<OpenOrClosedStmt> last_stmt);
+
+	BranchStmt(AstKind kind, std::unique_ptr<Location> location,
+			   BranchType brtype, std::unique_ptr<Ident> label,
+			   std::unique_ptr<OpenOrClosedStmt> last_stmt);
+
 	BranchStmt(AstKind kind, std::unique_ptr<Location> location,
 			   BranchType brtype, std::unique_ptr<Expr> expr,
 			   std::unique_ptr<ClosedStmt> first_stmt,
@@ -62,12 +87,25 @@ public:
 	auto get_first_stmt() const -> const ClosedStmt&;
 	[[nodiscard]]
 	auto get_last_stmt() const -> const OpenOrClosedStmt&;
+	[[nodiscard]]
+	auto get_for_clause() const -> const ForClause&;
+	[[nodiscard]]
+	auto get_label() const -> const Ident&;
+
+	/// @note 只有循环语句可以带有提示
+	void set_loop_hints(std::unique_ptr<LoopHintList> loop_hints);
+	/// @return 没有提示时返回nullptr
+	[[nodiscard]]
+	auto get_loop_hints() const -> const LoopHintList*;
 
 protected:
 	BranchType m_br_type;
 	std::unique_ptr<Expr> m_expr;
 	std::unique_ptr<ClosedStmt> m_first_stmt;
 	std::unique_ptr<OpenOrClosedStmt> m_last_stmt;
+	std::unique_ptr<ForClause> m_for_clause;
+	std::unique_ptr<LoopHintList> m_loop_hints;
+	std::unique_ptr<Ident> m_label;
 };
 
 
@@ -88,10 +126,31 @@ public:
 			std::unique_ptr<ClosedStmt> first_stmt,
 			std::unique_ptr<ClosedStmt> last_stmt);
 
+	ClosedStmt(std::unique_ptr<Location> location,
+			BranchType br_type,
+			std::unique_ptr<ForClause> for_clause,
+			std::unique_ptr<ClosedStmt> last_stmt);
+
+	/// do Stmt while (Expr);
+	ClosedStmt(std::unique_ptr<Location> location,
+			BranchType br_type,
+			std::unique_ptr<Stmt> stmt,
+			std::unique_ptr<Expr> expr);
+
+	/// Ident ":" ClosedStmt
+	ClosedStmt(std::unique_ptr<Location> location,
+			BranchType br_type,
+			std::unique_ptr<Ident> label,
+			std::unique_ptr<ClosedStmt> last_stmt);
+
 	[[nodiscard]]
 	auto get_simple_stmt() const -> const SimpleStmt&;
+	/// @brief do-while的循环体
+	[[nodiscard]]
+	auto get_stmt() const -> const Stmt&;
 private:
 	std::unique_ptr<SimpleStmt> m_simple_stmt;
+	std::unique_ptr<Stmt> m_stmt;
 };
 
 
@@ -115,6 +174,17 @@ public:
 			std::unique_ptr<ClosedStmt> closed_stmt,
 			std::unique_ptr<OpenStmt> open_stmt);
 
+	OpenStmt(std::unique_ptr<Location> location,
+			BranchType br_type,
+			std::unique_ptr<ForClause> for_clause,
+			std::unique_ptr<OpenStmt> open_stmt);
+
+	/// Ident ":" OpenStmt
+	OpenStmt(std::unique_ptr<Location> location,
+			BranchType br_type,
+			std::unique_ptr<Ident> label,
+			std::unique_ptr<OpenStmt> open_stmt);
+
 
 	[[nodiscard]]
 	auto get_stmt() const -> const Stmt&;
@@ -133,6 +203,12 @@ public:
 		expression,
 		block,
 		func_return,
+		loop_break,
+		loop_continue,
+		/// goto Ident;
+		jump_goto,
+		/// goto *Expr;
+		computed_goto,
 	};
 	SimpleStmt(std::unique_ptr<Location> location, SimpleStmtType type);
 
@@ -145,6 +221,9 @@ public:
 	SimpleStmt(std::unique_ptr<Location> location, SimpleStmtType type,
 		std::unique_ptr<Block> block);
 
+	SimpleStmt(std::unique_ptr<Location> location, SimpleStmtType type,
+		std::unique_ptr<Ident> label);
+
 	~SimpleStmt();
 
 	[[nodiscard]]
@@ -163,11 +242,114 @@ public:
 	[[nodiscard]]
 	auto get_block() const -> const Block&;
 
+	/// @brief goto的目标标号
+	[[nodiscard]]
+	auto get_label() const -> const Ident&;
+
 private:
 	SimpleStmtType m_type;
 	std::unique_ptr<LVal> m_lval;
 	std::unique_ptr<Expr> m_expr;
 	std::unique_ptr<Block> m_block;
+	std::unique_ptr<Ident> m_label;
+};
+
+
+/**
+ * ForClause ::= (VarDecl | ForStep ";") [Expr] ";" ForStep;
+ * ForStep   ::= empty | LVal "=" Expr | Expr;
+ **/
+class ForClause: public BaseAST
+{
+public:
+	TOYCC_AST_FILL_CLASSOF(ast_for_clause);
+	ForClause(std::unique_ptr<Location> location,
+			  std::unique_ptr<VarDecl> decl, std::unique_ptr<Expr> cond,
+			  std::unique_ptr<SimpleStmt> step);
+	ForClause(std::unique_ptr<Location> location,
+			  std::unique_ptr<SimpleStmt> init, std::unique_ptr<Expr> cond,
+			  std::unique_ptr<SimpleStmt> step);
+
+	[[nodiscard]]
+	auto has_decl() const -> bool
+	{ return m_decl != nullptr; }
+	[[nodiscard]]
+	auto get_decl() const -> const VarDecl&;
+	/// @note 初始化部分为声明时不存在
+	[[nodiscard]]
+	auto get_init() const -> const SimpleStmt&;
+
+	/// @brief 省略条件时循环条件恒为真
+	[[nodiscard]]
+	auto has_cond() const -> bool
+	{ return m_cond != nullptr; }
+	[[nodiscard]]
+	auto get_cond() const -> const Expr&;
+	[[nodiscard]]
+	auto get_step() const -> const SimpleStmt&;
+
+private:
+	std::unique_ptr<VarDecl> m_decl;
+	std::unique_ptr<SimpleStmt> m_init;
+	std::unique_ptr<Expr> m_cond;
+	std::unique_ptr<SimpleStmt> m_step;
+};
+
+
+/**
+ * LoopHint ::= Ident "(" (Ident | Number) ")";
+ * 例如 unroll(8), vectorize(enable), interleave(4)
+ **/
+class LoopHint: public BaseAST
+{
+public:
+	TOYCC_AST_FILL_CLASSOF(ast_loop_hint);
+	LoopHint(std::unique_ptr<Location> location, std::unique_ptr<Ident> name,
+			 std::unique_ptr<Ident> option);
+	LoopHint(std::unique_ptr<Location> location, std::unique_ptr<Ident> name,
+			 std::unique_ptr<Number> value);
+
+	[[nodiscard]]
+	auto get_name() const -> const Ident&;
+	/// @brief 参数为数值, 否则为enable, disable等选项
+	[[nodiscard]]
+	auto has_value() const -> bool
+	{ return m_value != nullptr; }
+	[[nodiscard]]
+	auto get_option() const -> const Ident&;
+	[[nodiscard]]
+	auto get_value() const -> const Number&;
+
+private:
+	std::unique_ptr<Ident> m_name;
+	std::unique_ptr<Ident> m_option;
+	std::unique_ptr<Number> m_value;
+};
+
+
+/// LoopHintList ::= ("#pragma" "toycc" LoopHint+ "\n")*;
+class LoopHintList: public BaseAST
+{
+public:
+	TOYCC_AST_FILL_CLASSOF(ast_loop_hint_list);
+	using Vector = std::vector<std::unique_ptr<LoopHint>>;
+
+	LoopHintList(std::unique_ptr<Location> location);
+
+	[[nodiscard]]
+	auto begin() const -> Vector::const_iterator;
+	[[nodiscard]]
+	auto end() const -> Vector::const_iterator;
+	[[nodiscard]]
+	auto empty() const -> bool
+	{ return m_hints.empty(); }
+
+	void add_hint(std::unique_ptr<LoopHint> hint);
+	/// @brief 将other中的提示按顺序追加到末尾
+	void merge(std::unique_ptr<LoopHintList> other);
+
+private:
+	Vector m_hints;
 };
 
 
@@ -198,6 +380,10 @@ class Param : public BaseAST
 public:
 	Param(std::unique_ptr<Location> location, std::unique_ptr<ScalarType> type,
 		  std::unique_ptr<Ident> id);
+	/// @brief 指针或数组参数, 数组与C语言相同调整为指向元素的指针
+	Param(std::unique_ptr<Location> location, std::unique_ptr<ScalarType> type,
+		  std::unique_ptr<Pointer> pointer, std::unique_ptr<Ident> id,
+		  std::unique_ptr<ArrayDims> dims);
 
 	TOYCC_AST_FILL_CLASSOF(ast_param);
 	
@@ -205,10 +391,22 @@ public:
 	auto get_type() const -> const ScalarType&;
 	[[nodiscard]]
 	auto get_ident() const -> const Ident&;
+	[[nodiscard]]
+	auto is_pointer() const -> bool
+	{ return m_pointer != nullptr && !m_pointer->empty(); }
+	[[nodiscard]]
+	auto get_pointer() const -> const Pointer&;
+	[[nodiscard]]
+	auto is_array() const -> bool
+	{ return m_dims != nullptr && !m_dims->empty(); }
+	[[nodiscard]]
+	auto get_dims() const -> const ArrayDims&;
 	
 private:
 	std::unique_ptr<ScalarType> m_type;
+	std::unique_ptr<Pointer> m_pointer;
 	std::unique_ptr<Ident> m_id;
+	std::unique_ptr<ArrayDims> m_dims;
 };
 
 
@@ -313,21 +511,68 @@ public:
 		std::unique_ptr<Ident> ident,
 		std::unique_ptr<ParamList> paramlist,
 		std::unique_ptr<Block> block);
+	/// @param pointer 返回值的指针声明符
+	FuncDef(
+		std::unique_ptr<Location> location, 
+		std::unique_ptr<BuiltinType> type,
+		std::unique_ptr<Pointer> pointer,
+		std::unique_ptr<Ident> ident,
+		std::unique_ptr<ParamList> paramlist,
+		std::unique_ptr<Block> block);
 
 	[[nodiscard]]
 	auto get_type () const -> const BuiltinType&;
 	[[nodiscard]]
+	auto returns_pointer() const -> bool
+	{ return m_pointer != nullptr && !m_pointer->empty(); }
+	[[nodiscard]]
+	auto get_return_pointer() const -> const Pointer&;
+	[[nodiscard]]
 	auto get_ident () const -> const Ident&;
 	[[nodiscard]]
 	auto get_paramlist () const -> const ParamList&;
 	[[nodiscard]]
 	auto get_block () const -> const Block&;
 
+	/**
+	 * @brief 函数体中是否有带标号(case, default, goto标号)的语句
+	 * @note 此时跳转可以进入作用域中间或到达静态不可达的代码
+	 */
+	void set_has_labels(bool has_labels)
+	{ m_has_labels = has_labels; }
+	[[nodiscard]]
+	auto has_labels() const -> bool
+	{ return m_has_labels; }
+
+	/**
+	 * @brief 函数体中被取地址的变量名
+	 * @note 按名字记录, 同名的变量都需要分配在内存中
+	 */
+	void set_address_taken(std::set<std::string, std::less<>> names)
+	{ m_address_taken = std::move(names); }
+	[[nodiscard]]
+	auto is_address_taken(std::string_view name) const -> bool
+	{ return m_address_taken.contains(name); }
+
+	/**
+	 * @brief eval函数, 以常量实参调用时在编译期解释执行
+	 * @note 仍然生成函数体, 实参不是常量时在运行时调用
+	 */
+	void set_eval(bool is_eval)
+	{ m_eval = is_eval; }
+	[[nodiscard]]
+	auto is_eval() const -> bool
+	{ return m_eval; }
+
 private:
 	std::unique_ptr<BuiltinType> m_type;
+	std::unique_ptr<Pointer> m_pointer;
 	std::unique_ptr<Ident> m_ident;
 	std::unique_ptr<ParamList> m_paramlist;
 	std::unique_ptr<Block> m_block;
+	bool m_has_labels;
+	std::set<std::string, std::less<>> m_address_taken;
+	bool m_eval = false;
 };
 
 class Module: public BaseAST
@@ -338,6 +583,7 @@ public:
 		extern_func,
 		static_global_variable,
 		static_func,
+		struct_def,
 	};
 	TOYCC_AST_FILL_CLASSOF(ast_module)
 	Module(std::unique_ptr<Location> location,
@@ -351,16 +597,28 @@ public:
 
 	Module(std::unique_ptr<Location> location,
 			 ModuleType type,
-			 std::unique_ptr<Ident> ident);
+			 std::unique_ptr<VarDecl> var_decl);
 
 	Module(std::unique_ptr<Location> location,
 			 ModuleType type,
 			 std::unique_ptr<Module> comp_unit,
-			 std::unique_ptr<Ident> ident);
+			 std::unique_ptr<VarDecl> var_decl);
+
+	/// @note 类型为struct_def
+	Module(std::unique_ptr<Location> location,
+			 std::unique_ptr<StructDef> struct_def);
+
+	Module(std::unique_ptr<Location> location,
+			 std::unique_ptr<Module> comp_unit,
+			 std::unique_ptr<StructDef> struct_def);
 
 	[[nodiscard]]
 	auto get_func_def() const -> const FuncDef&;
 	[[nodiscard]]
+	auto get_var_decl() const -> const VarDecl&;
+	[[nodiscard]]
+	auto get_struct_def() const -> const StructDef&;
+	[[nodiscard]]
 	auto get_module() const -> const Module&;
 	[[nodiscard]]
 	auto has_next_module() const -> bool;
@@ -373,7 +631,8 @@ private:
 	ModuleType m_type;
 	std::unique_ptr<Module> m_comp_unit;
 	std::unique_ptr<FuncDef> m_func_def;
-	std::unique_ptr<Ident> m_ident;
+	std::unique_ptr<VarDecl> m_var_decl;
+	std::unique_ptr<StructDef> m_struct_def;
 };
 
 } // namespace toycc
@@ -7,6 +7,30 @@ namespace toycc
 template<typename OpenOrClosedStmt>
 BranchStmt<OpenOrClosedStmt>::~BranchStmt() {}
 
+template<typename OpenOrClosedStmt>
+BranchStmt<OpenOrClosedStmt>::BranchStmt(AstKind kind,
+	std::unique_ptr<Location> location, BranchType brtype,
+	std::unique_ptr<ForClause> for_clause,
+	std::unique_ptr<OpenOrClosedStmt> last_stmt):
+	BaseAST { kind, std::move(location) }, m_br_type { brtype },
+	m_last_stmt { std::move(last_stmt) },
+	m_for_clause { std::move(for_clause) }
+{
+	assert(brtype == BranchType::for_stmt);
+}
+
+template<typename OpenOrClosedStmt>
+BranchStmt<OpenOrClosedStmt>::BranchStmt(AstKind kind,
+	std::unique_ptr<Location> location, BranchType brtype,
+	std::unique_ptr<Ident> label,
+	std::unique_ptr<OpenOrClosedStmt> last_stmt):
+	BaseAST { kind, std::move(location) }, m_br_type { brtype },
+	m_last_stmt { std::move(last_stmt) },
+	m_label { std::move(label) }
+{
+	assert(brtype == BranchType::label_stmt);
+}
+
 template<typename OpenOrClosedStmt>
 auto BranchStmt<OpenOrClosedStmt>::get_type() const -> BranchType
 {
@@ -34,6 +58,37 @@ auto BranchStmt<OpenOrClosedStmt>::get_last_stmt() const -> const OpenOrClosedSt
 	return *m_last_stmt;
 }
 
+template<typename OpenOrClosedStmt>
+auto BranchStmt<OpenOrClosedStmt>::get_for_clause() const -> const ForClause&
+{
+	assert(m_for_clause);
+	return *m_for_clause;
+}
+
+template<typename OpenOrClosedStmt>
+auto BranchStmt<OpenOrClosedStmt>::get_label() const -> const Ident&
+{
+	assert(m_label);
+	return *m_label;
+}
+
+template<typename OpenOrClosedStmt>
+void BranchStmt<OpenOrClosedStmt>::set_loop_hints(
+	std::unique_ptr<LoopHintList> loop_hints)
+{
+	assert(m_br_type == BranchType::while_stmt
+		|| m_br_type == BranchType::for_stmt
+		|| m_br_type == BranchType::do_while_stmt);
+	if (loop_hints != nullptr && !loop_hints->empty())
+		m_loop_hints = std::move(loop_hints);
+}
+
+template<typename OpenOrClosedStmt>
+auto BranchStmt<OpenOrClosedStmt>::get_loop_hints() const -> const LoopHintList*
+{
+	return m_loop_hints.get();
+}
+
 template class BranchStmt<OpenStmt>;
 template class BranchStmt<ClosedStmt>;	
 
@@ -61,12 +116,43 @@ ClosedStmt::ClosedStmt(std::unique_ptr<Location> location, BranchType br_type,
 {
 }
 
+ClosedStmt::ClosedStmt(std::unique_ptr<Location> location, BranchType br_type,
+					   std::unique_ptr<ForClause> for_clause,
+					   std::unique_ptr<ClosedStmt> last_stmt)
+	: BranchStmt{ast_closed_stmt, std::move(location), br_type,
+				 std::move(for_clause), std::move(last_stmt)}
+{
+}
+
+ClosedStmt::ClosedStmt(std::unique_ptr<Location> location, BranchType br_type,
+					   std::unique_ptr<Stmt> stmt, std::unique_ptr<Expr> expr)
+	: BranchStmt<ClosedStmt>{ast_closed_stmt, std::move(location), br_type},
+	  m_stmt{std::move(stmt)}
+{
+	assert(br_type == BranchType::do_while_stmt);
+	m_expr = std::move(expr);
+}
+
+ClosedStmt::ClosedStmt(std::unique_ptr<Location> location, BranchType br_type,
+					   std::unique_ptr<Ident> label,
+					   std::unique_ptr<ClosedStmt> last_stmt)
+	: BranchStmt{ast_closed_stmt, std::move(location), br_type,
+				 std::move(label), std::move(last_stmt)}
+{
+}
+
 auto ClosedStmt::get_simple_stmt() const -> const SimpleStmt&
 {
 	assert(m_simple_stmt);
 	return *m_simple_stmt;
 }
 
+auto ClosedStmt::get_stmt() const -> const Stmt&
+{
+	assert(m_stmt);
+	return *m_stmt;
+}
+
 OpenStmt::OpenStmt(std::unique_ptr<Location> location, BranchType br_type,
 				   std::unique_ptr<Expr> expr,
 				   std::unique_ptr<Stmt> stmt):
@@ -93,6 +179,22 @@ OpenStmt::OpenStmt(std::unique_ptr<Location> location, BranchType br_type,
 {
 }
 
+OpenStmt::OpenStmt(std::unique_ptr<Location> location, BranchType br_type,
+				   std::unique_ptr<ForClause> for_clause,
+				   std::unique_ptr<OpenStmt> open_stmt)
+	: BranchStmt{ast_open_stmt, std::move(location), br_type,
+				 std::move(for_clause), std::move(open_stmt)}
+{
+}
+
+OpenStmt::OpenStmt(std::unique_ptr<Location> location, BranchType br_type,
+				   std::unique_ptr<Ident> label,
+				   std::unique_ptr<OpenStmt> open_stmt)
+	: BranchStmt{ast_open_stmt, std::move(location), br_type,
+				 std::move(label), std::move(open_stmt)}
+{
+}
+
 auto OpenStmt::get_stmt() const -> const Stmt&
 {
 	assert(m_stmt);
@@ -132,6 +234,14 @@ SimpleStmt::SimpleStmt(std::unique_ptr<Location> location, SimpleStmtType type,
 {
 }
 
+SimpleStmt::SimpleStmt(std::unique_ptr<Location> location, SimpleStmtType type,
+		   std::unique_ptr<Ident> label)
+	: BaseAST{ast_stmt, std::move(location)}, m_type{type}, m_lval{nullptr},
+	  m_expr{nullptr}, m_block{nullptr}, m_label{std::move(label)}
+{
+	assert(type == jump_goto);
+}
+
 auto SimpleStmt::has_expr() const -> bool
 {
 	assert(m_type == SimpleStmt::expression
@@ -158,6 +268,115 @@ auto SimpleStmt::get_block() const -> const Block&
 	return *m_block;
 }	
 
+auto SimpleStmt::get_label() const -> const Ident&
+{
+	assert(m_label && "SimpleStmt does not contain a label");
+	return *m_label;
+}
+
+/// ForClause
+ForClause::ForClause(std::unique_ptr<Location> location,
+					 std::unique_ptr<VarDecl> decl, std::unique_ptr<Expr> cond,
+					 std::unique_ptr<SimpleStmt> step)
+	: BaseAST{ast_for_clause, std::move(location)}, m_decl{std::move(decl)},
+	  m_cond{std::move(cond)}, m_step{std::move(step)}
+{
+}
+
+ForClause::ForClause(std::unique_ptr<Location> location,
+					 std::unique_ptr<SimpleStmt> init,
+					 std::unique_ptr<Expr> cond,
+					 std::unique_ptr<SimpleStmt> step)
+	: BaseAST{ast_for_clause, std::move(location)}, m_init{std::move(init)},
+	  m_cond{std::move(cond)}, m_step{std::move(step)}
+{
+}
+
+auto ForClause::get_decl() const -> const VarDecl&
+{
+	assert(m_decl);
+	return *m_decl;
+}
+
+auto ForClause::get_init() const -> const SimpleStmt&
+{
+	assert(m_init);
+	return *m_init;
+}
+
+auto ForClause::get_cond() const -> const Expr&
+{
+	assert(m_cond);
+	return *m_cond;
+}
+
+auto ForClause::get_step() const -> const SimpleStmt&
+{
+	assert(m_step);
+	return *m_step;
+}
+
+/// LoopHint
+LoopHint::LoopHint(std::unique_ptr<Location> location,
+				   std::unique_ptr<Ident> name, std::unique_ptr<Ident> option)
+	: BaseAST{ast_loop_hint, std::move(location)}, m_name{std::move(name)},
+	  m_option{std::move(option)}
+{
+}
+
+LoopHint::LoopHint(std::unique_ptr<Location> location,
+				   std::unique_ptr<Ident> name, std::unique_ptr<Number> value)
+	: BaseAST{ast_loop_hint, std::move(location)}, m_name{std::move(name)},
+	  m_value{std::move(value)}
+{
+}
+
+auto LoopHint::get_name() const -> const Ident&
+{
+	assert(m_name);
+	return *m_name;
+}
+
+auto LoopHint::get_option() const -> const Ident&
+{
+	assert(m_option);
+	return *m_option;
+}
+
+auto LoopHint::get_value() const -> const Number&
+{
+	assert(m_value);
+	return *m_value;
+}
+
+/// LoopHintList
+LoopHintList::LoopHintList(std::unique_ptr<Location> location)
+	: BaseAST{ast_loop_hint_list, std::move(location)}, m_hints{}
+{
+}
+
+auto LoopHintList::begin() const -> Vector::const_iterator
+{
+	return m_hints.cbegin();
+}
+
+auto LoopHintList::end() const -> Vector::const_iterator
+{
+	return m_hints.cend();
+}
+
+void LoopHintList::add_hint(std::unique_ptr<LoopHint> hint)
+{
+	m_hints.push_back(std::move(hint));
+}
+
+void LoopHintList::merge(std::unique_ptr<LoopHintList> other)
+{
+	m_hints.insert(m_hints.end(),
+				   std::make_move_iterator(other->m_hints.begin()),
+				   std::make_move_iterator(other->m_hints.end()));
+}
+
 Stmt::Stmt(std::unique_ptr<Location> location, 
 	 std::unique_ptr<OpenStmt> open_stmt):
 	BaseAST { ast_stmt, std::move(location) },
@@ -194,12 +413,33 @@ Param::Param(std::unique_ptr<Location> location, std::unique_ptr<ScalarType> typ
 {
 }
 
+Param::Param(std::unique_ptr<Location> location, std::unique_ptr<ScalarType> type,
+	  std::unique_ptr<Pointer> pointer, std::unique_ptr<Ident> id,
+	  std::unique_ptr<ArrayDims> dims)
+	: BaseAST { ast_param, std::move(location)}, m_type{std::move(type)},
+	  m_pointer{std::move(pointer)}, m_id{std::move(id)},
+	  m_dims{std::move(dims)}
+{
+}
+
 auto Param::get_type() const -> const ScalarType&
 { return *m_type; }
 
 auto Param::get_ident() const -> const Ident&
 { return *m_id; }
 
+auto Param::get_pointer() const -> const Pointer&
+{
+	assert(m_pointer);
+	return *m_pointer;
+}
+
+auto Param::get_dims() const -> const ArrayDims&
+{
+	assert(m_dims);
+	return *m_dims;
+}
+
 
 /// ParamList
 ParamList::ParamList(std::unique_ptr<Location> location, Vector params)
@@ -319,7 +559,19 @@ FuncDef::FuncDef(std::unique_ptr<Location> location, std::unique_ptr<BuiltinType
 
 	  BaseAST{ast_funcdef, std::move(location)}, m_type{std::move(type)},
 	  m_ident{std::move(ident)}, m_paramlist{std::move(paramlist)},
-	  m_block{std::move(block)}
+	  m_block{std::move(block)}, m_has_labels{false}
+{
+}
+
+FuncDef::FuncDef(std::unique_ptr<Location> location, std::unique_ptr<BuiltinType> type,
+				 std::unique_ptr<Pointer> pointer,
+				 std::unique_ptr<Ident> ident,
+				 std::unique_ptr<ParamList> paramlist,
+				 std::unique_ptr<Block> block)
+	: BaseAST{ast_funcdef, std::move(location)}, m_type{std::move(type)},
+	  m_pointer{std::move(pointer)}, m_ident{std::move(ident)},
+	  m_paramlist{std::move(paramlist)}, m_block{std::move(block)},
+	  m_has_labels{false}
 {
 }
 
@@ -328,6 +580,12 @@ auto FuncDef::get_type() const -> const BuiltinType&
 	return *m_type;
 }
 
+auto FuncDef::get_return_pointer() const -> const Pointer&
+{
+	assert(m_pointer);
+	return *m_pointer;
+}
+
 auto FuncDef::get_ident() const -> const Ident&
 {
 	return *m_ident;
@@ -346,7 +604,7 @@ auto FuncDef::get_block() const -> const Block&
 Module::Module(std::unique_ptr<Location> location, ModuleType type,
 				   std::unique_ptr<FuncDef> func_def)
 	: BaseAST{ast_module, std::move(location)}, m_type{type},
-	  m_comp_unit{nullptr}, m_func_def{std::move(func_def)}, m_ident{nullptr}
+	  m_comp_unit{nullptr}, m_func_def{std::move(func_def)}, m_var_decl{nullptr}
 {}
 
 Module::Module(std::unique_ptr<Location> location,
@@ -354,23 +612,23 @@ Module::Module(std::unique_ptr<Location> location,
 			 std::unique_ptr<Module> comp_unit,
 			 std::unique_ptr<FuncDef> func_def)
 	: BaseAST{ast_module, std::move(location)}, m_type{type},
-	  m_comp_unit{std::move(comp_unit)}, m_func_def{std::move(func_def)}, m_ident{nullptr}
+	  m_comp_unit{std::move(comp_unit)}, m_func_def{std::move(func_def)}, m_var_decl{nullptr}
 {}
 
 Module::Module(std::unique_ptr<Location> location,
 			 ModuleType type,
-			 std::unique_ptr<Ident> ident)
+			 std::unique_ptr<VarDecl> var_decl)
 	: BaseAST{ast_module, std::move(location)}, m_type{type},
-	  m_comp_unit{}, m_func_def{}, m_ident{std::move(ident)}
+	  m_comp_unit{}, m_func_def{}, m_var_decl{std::move(var_decl)}
 {}
 
 
 Module::Module(std::unique_ptr<Location> location,
 			 ModuleType type,
 			 std::unique_ptr<Module> comp_unit,
-			 std::unique_ptr<Ident> ident)
-	: BaseAST{ast_comunit, std::move(location)}, m_type{type},
-	  m_comp_unit{std::move(comp_unit)}, m_func_def{}, m_ident{std::move(ident)}
+			 std::unique_ptr<VarDecl> var_decl)
+	: BaseAST{ast_module, std::move(location)}, m_type{type},
+	  m_comp_unit{std::move(comp_unit)}, m_func_def{}, m_var_decl{std::move(var_decl)}
 {}
 
 auto Module::get_func_def() const -> const FuncDef&
@@ -379,6 +637,31 @@ auto Module::get_func_def() const -> const FuncDef&
 	return *m_func_def;
 }
 
+auto Module::get_var_decl() const -> const VarDecl&
+{
+	assert(m_var_decl);
+	return *m_var_decl;
+}
+
+Module::Module(std::unique_ptr<Location> location,
+			 std::unique_ptr<StructDef> struct_def)
+	: BaseAST{ast_module, std::move(location)}, m_type{ModuleType::struct_def},
+	  m_struct_def{std::move(struct_def)}
+{}
+
+Module::Module(std::unique_ptr<Location> location,
+			 std::unique_ptr<Module> comp_unit,
+			 std::unique_ptr<StructDef> struct_def)
+	: BaseAST{ast_module, std::move(location)}, m_type{ModuleType::struct_def},
+	  m_comp_unit{std::move(comp_unit)}, m_struct_def{std::move(struct_def)}
+{}
+
+auto Module::get_struct_def() const -> const StructDef&
+{
+	assert(m_struct_def);
+	return *m_struct_def;
+}
+
 auto Module::get_module() const -> const Module&
 {
 	assert(m_comp_unit);
@@ -9,10 +9,17 @@ namespace toycc
 Driver::Driver(llvm::SourceMgr& src_mgr,
 			   std::shared_ptr<spdlog::async_logger> logger)
 	: m_ast{}, m_src_mgr{src_mgr}, m_bufferid{}, m_debug_trace{false},
-	  m_parser{}, m_location{}, m_logger { logger }
+	  m_parser{}, m_location{}, m_logger { logger },
+	  m_diag_counter { std::make_shared<DiagCounter>() },
+	  m_scanner { nullptr }, m_has_labels { false }
 {
 }
 
+Driver::~Driver()
+{
+	destroy_flex();
+}
+
 auto Driver::construct(std::string_view file_name)
 	-> std::expected<void, std::string>
 {
@@ -21,7 +28,14 @@ auto Driver::construct(std::string_view file_name)
 	{
 		return std::unexpected{std::format("Failed to open {} \n", file_name)};
 	}
-	m_bufferid = m_src_mgr.AddNewSourceBuffer(std::move(*buffer_or_error), llvm::SMLoc());
+
+	construct(std::move(*buffer_or_error));
+	return {};
+}
+
+void Driver::construct(std::unique_ptr<llvm::MemoryBuffer> buffer)
+{
+	m_bufferid = m_src_mgr.AddNewSourceBuffer(std::move(buffer), llvm::SMLoc());
 
 	set_flex(get_buffer(),
 			 static_cast<int>(
@@ -32,10 +46,9 @@ auto Driver::construct(std::string_view file_name)
 	m_location.set_end(buf_str);
 	m_location.set_src_mgr(&m_src_mgr);
 	m_location.set_logger(m_logger);
+	m_location.set_counter(m_diag_counter);
 
 	m_parser = std::make_unique<yy::parser>(*this);
-
-	return {};
 }
 
 auto Driver::get_buffer() const -> const char*
@@ -71,5 +84,18 @@ auto DriverFactory::produce_driver(std::string_view file_name)
 	return driver;
 }
 
+auto DriverFactory::produce_driver(std::string_view source,
+								   std::string_view buffer_name)
+	-> std::unique_ptr<Driver>
+{
+	std::unique_ptr<Driver> driver { new Driver { m_src_mgr, m_logger } };
+
+	driver->construct(llvm::MemoryBuffer::getMemBufferCopy(
+		llvm::StringRef { source.data(), source.size() },
+		llvm::StringRef { buffer_name.data(), buffer_name.size() }));
+
+	return driver;
+}
+
 }	//namespace toycc
 
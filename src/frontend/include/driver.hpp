@@ -6,14 +6,24 @@
 #include <string_view>
 #include <expected>
 #include <memory>
+#include <set>
+#include <string>
+#include <utility>
 #include <spdlog/spdlog.h>
 #include <spdlog/async.h>
 #include "ast.hpp"
 #include "bison_parser.hpp"
 #include "llvm_location.hpp"
 
+#ifndef YY_TYPEDEF_YY_SCANNER_T
+#define YY_TYPEDEF_YY_SCANNER_T
+typedef void* yyscan_t;
+#endif
+
+/// 可重入的flex扫描器, 状态保存在yyscanner中
 #define YY_DECL \
-	auto yylex(toycc::Driver& driver) -> yy::parser::symbol_type
+	auto yylex_r(toycc::Driver& driver, yyscan_t yyscanner) \
+		-> yy::parser::symbol_type
 
 YY_DECL;
 
@@ -33,6 +43,10 @@ private:
 		   std::shared_ptr<spdlog::async_logger> logger);
 
 public:
+	~Driver();
+	Driver(const Driver&) = delete;
+	auto operator=(const Driver&) -> Driver& = delete;
+
 	/*
 	 * @note 延迟构造，用于在非异常环境下处理构造函数错误
 	 * @return 出错时返回std::unexpected, 描述错误内容
@@ -40,6 +54,9 @@ public:
 	auto construct(std::string_view file_name)
 		-> std::expected<void, std::string>;
 
+	/// @brief 从内存中的源代码构造, buffer交由SourceMgr管理
+	void construct(std::unique_ptr<llvm::MemoryBuffer> buffer);
+
 	/**
 	 * @note 解析函数，只能调用一次
 	 * @return true 成功, false 失败
@@ -62,11 +79,18 @@ public:
 	{ return *m_parser; }
 
 	/**
-	 * @brief 设置flex的读取buffer, 和debug_trace模式
+	 * @brief 创建flex扫描器, 设置读取buffer和debug_trace模式
 	 * @note 在lexer.ll中定义
 	 */
 	void set_flex(const char* buffer, int buffer_size);
 
+	/// @brief 释放flex扫描器, 在lexer.ll中定义
+	void destroy_flex();
+
+	/// @brief 获取当前driver的flex扫描器
+	auto get_scanner() -> yyscan_t
+	{ return m_scanner; }
+
 	/// @brief 设置是否输出debug调用栈
 	void set_trace(bool debug_trace)
 	{ m_debug_trace = debug_trace; }
@@ -80,6 +104,24 @@ public:
 	/// @brief 解析时获取位置记录，在yylex中调用
 	auto get_location() -> LLVMLocation&;
 
+	/// @brief 本次编译的诊断信息计数, 由所有location共享
+	auto get_diag_counter() const -> std::shared_ptr<DiagCounter>
+	{ return m_diag_counter; }
+
+	/// @brief 解析到带标号的语句时调用, 标记所在的函数
+	void mark_label()
+	{ m_has_labels = true; }
+	/// @brief 归约函数定义时取出标记并重置
+	auto take_label_mark() -> bool
+	{ return std::exchange(m_has_labels, false); }
+
+	/// @brief 解析到对变量取地址时调用, 记录在所在的函数中
+	void mark_address_taken(std::string_view name)
+	{ m_address_taken.emplace(name); }
+	/// @brief 归约函数定义时取出记录并清空
+	auto take_address_taken() -> std::set<std::string, std::less<>>
+	{ return std::exchange(m_address_taken, {}); }
+
 private:
 	/// @brief 获取文件的内存映射
 	auto get_buffer() const -> const char*;
@@ -92,6 +134,10 @@ private:
 	std::unique_ptr<yy::parser> m_parser;
 	LLVMLocation m_location;
 	std::shared_ptr<spdlog::async_logger> m_logger;
+	std::shared_ptr<DiagCounter> m_diag_counter;
+	yyscan_t m_scanner;
+	bool m_has_labels;
+	std::set<std::string, std::less<>> m_address_taken;
 };
 
 
@@ -112,6 +158,14 @@ public:
 	auto produce_driver(std::string_view file_name)
 		-> std::expected<std::unique_ptr<Driver>, std::string>;
 
+	/**
+	 * @brief 直接分析内存中的源代码, 不读取文件
+	 * @param source 源代码, 会被复制
+	 * @param buffer_name 诊断信息中显示的文件名
+	 */
+	auto produce_driver(std::string_view source, std::string_view buffer_name)
+		-> std::unique_ptr<Driver>;
+
 private:
 	llvm::SourceMgr& m_src_mgr;
 	std::shared_ptr<spdlog::async_logger> m_logger;
@@ -119,3 +173,9 @@ private:
 
 }	//namespace toycc
 
+/// @brief 供parser调用, 转发到driver持有的扫描器
+inline auto yylex(toycc::Driver& driver) -> yy::parser::symbol_type
+{
+	return yylex_r(driver, driver.get_scanner());
+}
+
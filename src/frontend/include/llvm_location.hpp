@@ -2,16 +2,24 @@
 
 #include <llvm/Support/SMLoc.h>
 #include <llvm/Support/SourceMgr.h>
+#include <array>
+#include <atomic>
 #include <ostream>
 #include <spdlog/async.h>
 #include "base_ast.hpp"
 
+/// 开头为空的符号(如省略的LoopHintList)不计入范围
 #define YYLLOC_DEFAULT(Cur, Rhs, N)                                            \
 	do                                                                         \
 	{                                                                          \
 		if (N)                                                                 \
 		{                                                                      \
-			Cur.begin = YYRHSLOC(Rhs, 1).begin;                                \
+			int yyloc_first = 1;                                               \
+			while (yyloc_first < (N)                                           \
+				   && YYRHSLOC(Rhs, yyloc_first).begin                         \
+						  == YYRHSLOC(Rhs, yyloc_first).end)                   \
+				++yyloc_first;                                                 \
+			Cur.begin = YYRHSLOC(Rhs, yyloc_first).begin;                      \
 			Cur.end = YYRHSLOC(Rhs, N).end;                                    \
 		}                                                                      \
 		else                                                                   \
@@ -24,6 +32,22 @@
 namespace toycc
 {
 
+/**
+ * @brief 单次编译过程中各级别诊断信息的输出次数
+ * @note 由同一次编译的所有LLVMLocation共享, 可在多个线程中计数
+ */
+class DiagCounter
+{
+public:
+	void count(Location::DiagKind kind);
+
+	[[nodiscard]]
+	auto get(Location::DiagKind kind) const -> std::size_t;
+
+private:
+	std::array<std::atomic<std::size_t>, Location::dk_note + 1> m_counter {};
+};
+
 class LLVMLocation: public Location
 {
 	friend auto operator<< (std::ostream& o, const LLVMLocation& loc) -> std::ostream&;
@@ -68,17 +92,14 @@ public:
 	/// @note 与set_src_mgr类似
 	void set_logger(std::shared_ptr<spdlog::async_logger> logger);
 
+	/// @note 与set_src_mgr类似, 未设置时不计数
+	void set_counter(std::shared_ptr<DiagCounter> counter);
+
 	/// @brief 查询某个级别输出信息的次数
-	static
-	auto search_counter(Location::DiagKind kind) -> std::size_t;
+	[[nodiscard]]
+	auto search_counter(Location::DiagKind kind) const -> std::size_t;
 
 private:
-	static inline
-	std::unordered_map<Location::DiagKind, std::size_t> trace_counter;
-	
-	static
-	void count(Location::DiagKind kind);
-
 	static constexpr
 	auto cvt_kind_to_llvm(Location::DiagKind kind) -> llvm::SourceMgr::DiagKind;
 
@@ -86,6 +107,7 @@ private:
 	const llvm::SourceMgr* m_src_mgr;
 
 	std::shared_ptr<spdlog::async_logger> m_logger;
+	std::shared_ptr<DiagCounter> m_counter;
 };
 
 auto operator<< (std::ostream& o, const LLVMLocation& loc) -> std::ostream&;
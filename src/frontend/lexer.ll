@@ -21,7 +21,9 @@
 
 %}
 
-%option noyywrap nounput noinput batch debug
+%option noyywrap nounput noinput batch debug reentrant
+/* #pragma toycc 所在行的剩余部分 */
+%x PRAGMA
 
 blank	 		[ \t\r\n]+
 LineComment		\/\/[^\n]*\n
@@ -30,6 +32,7 @@ Ident			[a-zA-Z_][0-9a-zA-Z_]*
 Number			[0-9]+
 SignedInt		(signed\s+int)|(int)|(signed)
 UnsignedInt		(unsigned\s+int)|(unsigned)
+VectorLanes		2|4|8|16
 %%
 
 %{
@@ -44,6 +47,30 @@ UnsignedInt		(unsigned\s+int)|(unsigned)
 {LineComment}	LOC_UPDATE_NORMAL(loc);
 {LegacyComment} LOC_UPDATE_NORMAL(loc);
 
+"#pragma"[ \t]+"toycc"	{
+					BEGIN(PRAGMA);
+					LOC_UPDATE_RET_ACTION(loc, yy::parser::make_KW_PRAGMA_TOYCC(loc));
+				}
+<PRAGMA>[ \t\r]+	LOC_UPDATE_NORMAL(loc);
+<PRAGMA>\n|{LineComment}	{
+					BEGIN(INITIAL);
+					LOC_UPDATE_RET_ACTION(loc, yy::parser::make_PRAGMA_END(loc));
+				}
+<PRAGMA>{Ident}	LOC_UPDATE_RET_ACTION(loc, yy::parser::make_IDENT(std::string{yytext}, loc));
+<PRAGMA>{Number}	LOC_UPDATE_RET_ACTION(loc, yy::parser::make_INT_LITERAL(std::atoi(yytext), loc));
+<PRAGMA>"("		LOC_UPDATE_RET_ACTION(loc, yy::parser::make_DELIM_LPAREN(loc));
+<PRAGMA>")"		LOC_UPDATE_RET_ACTION(loc, yy::parser::make_DELIM_RPAREN(loc));
+<PRAGMA>.		{
+					driver.get_parser().error(loc, "expect loop hint");
+					return yy::parser::make_YYerror(loc);
+				}
+<PRAGMA><<EOF>>	{
+					BEGIN(INITIAL);
+					return yy::parser::make_PRAGMA_END(loc);
+				}
+
+"int"{VectorLanes}		LOC_UPDATE_RET_ACTION(loc, yy::parser::make_KW_SINT_VECTOR(std::atoi(yytext + 3), loc));
+"unsigned"{VectorLanes}	LOC_UPDATE_RET_ACTION(loc, yy::parser::make_KW_UINT_VECTOR(std::atoi(yytext + 8), loc));
 {SignedInt}		LOC_UPDATE_RET_ACTION(loc, yy::parser::make_KW_SINT(loc));
 {UnsignedInt}	LOC_UPDATE_RET_ACTION(loc, yy::parser::make_KW_UINT(loc));
 "void"			LOC_UPDATE_RET_ACTION(loc, yy::parser::make_KW_VOID(loc));
@@ -53,6 +80,17 @@ UnsignedInt		(unsigned\s+int)|(unsigned)
 "if"			LOC_UPDATE_RET_ACTION(loc, yy::parser::make_KW_IF(loc));
 "else"			LOC_UPDATE_RET_ACTION(loc, yy::parser::make_KW_ELSE(loc));
 "while"			LOC_UPDATE_RET_ACTION(loc, yy::parser::make_KW_WHILE(loc));
+"do"			LOC_UPDATE_RET_ACTION(loc, yy::parser::make_KW_DO(loc));
+"for"			LOC_UPDATE_RET_ACTION(loc, yy::parser::make_KW_FOR(loc));
+"break"			LOC_UPDATE_RET_ACTION(loc, yy::parser::make_KW_BREAK(loc));
+"continue"		LOC_UPDATE_RET_ACTION(loc, yy::parser::make_KW_CONTINUE(loc));
+"switch"		LOC_UPDATE_RET_ACTION(loc, yy::parser::make_KW_SWITCH(loc));
+"case"			LOC_UPDATE_RET_ACTION(loc, yy::parser::make_KW_CASE(loc));
+"default"		LOC_UPDATE_RET_ACTION(loc, yy::parser::make_KW_DEFAULT(loc));
+"goto"			LOC_UPDATE_RET_ACTION(loc, yy::parser::make_KW_GOTO(loc));
+"__attribute__"	LOC_UPDATE_RET_ACTION(loc, yy::parser::make_KW_ATTRIBUTE(loc));
+"restrict"		LOC_UPDATE_RET_ACTION(loc, yy::parser::make_KW_RESTRICT(loc));
+"struct"		LOC_UPDATE_RET_ACTION(loc, yy::parser::make_KW_STRUCT(loc));
 
 {Ident}			LOC_UPDATE_RET_ACTION(loc, yy::parser::make_IDENT(std::string{yytext}, loc));
 {Number}		LOC_UPDATE_RET_ACTION(loc, yy::parser::make_INT_LITERAL(std::atoi(yytext), loc));
@@ -60,8 +98,13 @@ UnsignedInt		(unsigned\s+int)|(unsigned)
 ")"				LOC_UPDATE_RET_ACTION(loc, yy::parser::make_DELIM_RPAREN(loc));
 "{"				LOC_UPDATE_RET_ACTION(loc, yy::parser::make_DELIM_LBRACE(loc));
 "}"				LOC_UPDATE_RET_ACTION(loc, yy::parser::make_DELIM_RBRACE(loc));
+"["				LOC_UPDATE_RET_ACTION(loc, yy::parser::make_DELIM_LBRACKET(loc));
+"]"				LOC_UPDATE_RET_ACTION(loc, yy::parser::make_DELIM_RBRACKET(loc));
 ","				LOC_UPDATE_RET_ACTION(loc, yy::parser::make_DELIM_COMMA(loc));
 ";"				LOC_UPDATE_RET_ACTION(loc, yy::parser::make_DELIM_SEMICOLON(loc));
+":"				LOC_UPDATE_RET_ACTION(loc, yy::parser::make_DELIM_COLON(loc));
+"."				LOC_UPDATE_RET_ACTION(loc, yy::parser::make_OP_DOT(loc));
+"->"			LOC_UPDATE_RET_ACTION(loc, yy::parser::make_OP_ARROW(loc));
 "+"				LOC_UPDATE_RET_ACTION(loc, yy::parser::make_OP_ADD(loc));
 "-" 			LOC_UPDATE_RET_ACTION(loc, yy::parser::make_OP_SUB(loc));
 "!" 			LOC_UPDATE_RET_ACTION(loc, yy::parser::make_OP_NOT(loc));
@@ -76,6 +119,7 @@ UnsignedInt		(unsigned\s+int)|(unsigned)
 "!="			LOC_UPDATE_RET_ACTION(loc, yy::parser::make_OP_NE(loc));
 "&&"			LOC_UPDATE_RET_ACTION(loc, yy::parser::make_OP_LAND(loc));
 "||"			LOC_UPDATE_RET_ACTION(loc, yy::parser::make_OP_LOR(loc));
+"&"				LOC_UPDATE_RET_ACTION(loc, yy::parser::make_OP_AMP(loc));
 "="				LOC_UPDATE_RET_ACTION(loc, yy::parser::make_OP_ASSIGN(loc));
 .				{
 					driver.get_parser().error(loc, "expect token");
@@ -92,8 +136,17 @@ namespace toycc
 
 void Driver::set_flex(const char* buffer, int buffer_size)
 {
-	yy_flex_debug = this->get_trace();
-	yy_scan_bytes(buffer, buffer_size);
+	yylex_init(&m_scanner);
+	yyset_debug(this->get_trace(), m_scanner);
+	yy_scan_bytes(buffer, buffer_size, m_scanner);
+}
+
+void Driver::destroy_flex()
+{
+	if (m_scanner == nullptr)
+		return;
+	yylex_destroy(m_scanner);
+	m_scanner = nullptr;
 }
 
 }	//namespace toycc
@@ -5,6 +5,16 @@
 namespace toycc
 {
 
+void DiagCounter::count(Location::DiagKind kind)
+{
+	m_counter[kind].fetch_add(1, std::memory_order_relaxed);
+}
+
+auto DiagCounter::get(Location::DiagKind kind) const -> std::size_t
+{
+	return m_counter[kind].load(std::memory_order_relaxed);
+}
+
 void LLVMLocation::set_begin(const char* buf)
 {
 	begin = llvm::SMLoc::getFromPointer(buf);
@@ -22,7 +32,8 @@ void LLVMLocation::report(Location::DiagKind kind, std::string_view msg) const
 	assert(m_src_mgr->getNumBuffers() > 0);
 
 	auto range = get_range();
-	count(kind);
+	if (m_counter)
+		m_counter->count(kind);
 	m_src_mgr->PrintMessage(begin, cvt_kind_to_llvm(kind), msg, range);
 }
 
@@ -36,6 +47,11 @@ void LLVMLocation::set_logger(std::shared_ptr<spdlog::async_logger> logger)
 	m_logger = logger;
 }
 
+void LLVMLocation::set_counter(std::shared_ptr<DiagCounter> counter)
+{
+	m_counter = counter;
+}
+
 auto LLVMLocation::get_range() const -> llvm::SMRange
 {
 	return llvm::SMRange { begin, end };
@@ -51,14 +67,10 @@ void LLVMLocation::update(std::size_t len)
 	end = llvm::SMLoc::getFromPointer(end.getPointer() + len);
 }
 
-auto LLVMLocation::search_counter(Location::DiagKind kind) -> std::size_t
-{
-	return trace_counter[kind];
-}
-
-void LLVMLocation::count(Location::DiagKind kind)
+auto LLVMLocation::search_counter(Location::DiagKind kind) const
+	-> std::size_t
 {
-	++trace_counter[kind];
+	return m_counter ? m_counter->get(kind) : 0;
 }
 
 constexpr
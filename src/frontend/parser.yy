@@ -44,16 +44,29 @@ namespace toycc { class Driver; }
 //关键字
 %token KW_RETURN
 %token KW_SINT KW_UINT KW_VOID 
+// intN/unsignedN, 语义值为通道数
+%token <int> KW_SINT_VECTOR KW_UINT_VECTOR
 %token KW_CONST KW_EVAL
-%token KW_WHILE
+%token KW_WHILE KW_DO KW_FOR
+%token KW_BREAK KW_CONTINUE
+%token KW_SWITCH KW_CASE KW_DEFAULT
+%token KW_GOTO
+%token KW_ATTRIBUTE		"__attribute__"
+%token KW_RESTRICT		"restrict"
+%token KW_STRUCT		"struct"
+%token KW_PRAGMA_TOYCC	"#pragma toycc"
+%token PRAGMA_END		"end of pragma"
 %token KW_IF KW_ELSE 
 // 字面量标识分隔符
 %token DELIM_LPAREN		"("
 %token DELIM_RPAREN		")"
 %token DELIM_LBRACE		"{"
 %token DELIM_RBRACE		"}"
+%token DELIM_LBRACKET	"["
+%token DELIM_RBRACKET	"]"
 %token DELIM_COMMA 		","
 %token DELIM_SEMICOLON	";"
+%token DELIM_COLON		":"
 
 // 操作符
 %token OP_ADD	"+"
@@ -70,19 +83,28 @@ namespace toycc { class Driver; }
 %token OP_NE	"!="
 %token OP_LAND	"&&"
 %token OP_LOR	"||"
+%token OP_AMP	"&"
 %token OP_ASSIGN "="
+%token OP_DOT	"."
+%token OP_ARROW	"->"
 
 %nterm <std::unique_ptr<toycc::CompUnit>>		CompUnit
 //basic
 %nterm <std::unique_ptr<toycc::Number>>			Number
 %nterm <std::unique_ptr<toycc::Ident>>			Ident
 %nterm <std::unique_ptr<toycc::LVal>>			LVal
+%nterm <std::unique_ptr<toycc::LVal>>			SubscriptLVal
 //语句
 %nterm <std::unique_ptr<toycc::Module>>			Module
 %nterm <std::unique_ptr<toycc::Stmt>>			Stmt
 %nterm <std::unique_ptr<toycc::OpenStmt>>		OpenStmt
 %nterm <std::unique_ptr<toycc::ClosedStmt>>		ClosedStmt
 %nterm <std::unique_ptr<toycc::SimpleStmt>>		SimpleStmt
+%nterm <std::unique_ptr<toycc::SimpleStmt>>		ForStep
+%nterm <std::unique_ptr<toycc::ForClause>>		ForClause
+%nterm <std::unique_ptr<toycc::LoopHint>>		LoopHint
+%nterm <std::unique_ptr<toycc::LoopHintList>>	LoopHintList
+%nterm <std::unique_ptr<toycc::LoopHintList>>	PragmaHints
 %nterm <std::unique_ptr<toycc::Decl>>			Decl
 %nterm <std::unique_ptr<toycc::Block>>			Block
 %nterm <std::unique_ptr<toycc::BlockItemList>>	BlockItemList
@@ -97,9 +119,13 @@ namespace toycc { class Driver; }
 %nterm <std::unique_ptr<toycc::VarDef>>			VarDef
 %nterm <std::unique_ptr<toycc::VarDefList>>		VarDefList
 %nterm <std::unique_ptr<toycc::InitVal>>		InitVal
+%nterm <std::unique_ptr<toycc::Pointer>>		Pointer
+%nterm <std::unique_ptr<toycc::ArrayDims>>		ArrayDims
+%nterm <std::unique_ptr<toycc::Attribute>>		Attribute
+%nterm <std::unique_ptr<toycc::StructDef>>		StructDef
+%nterm <std::unique_ptr<toycc::StructDef>>		StructFields
 //type
 %nterm <std::unique_ptr<toycc::ScalarType>>		ScalarType
-%nterm <std::unique_ptr<toycc::BuiltinType>>	BuiltinType
 
 %nterm <std::unique_ptr<toycc::Param>>			Param
 %nterm <std::unique_ptr<toycc::ParamList>>		ParamList
@@ -149,32 +175,89 @@ Module:
 			toycc::Module::extern_func,
 			std::move($1), std::move($2));
 	}
-	| Module Ident {
+	| Module VarDecl {
 		$$ = std::make_unique<toycc::Module>(CONSTRUCT_LOCATION(@$),
 			toycc::Module::extern_global_variable,
 			std::move($1), std::move($2));
 	}
-	| Ident {
+	| VarDecl {
 		$$ = std::make_unique<toycc::Module>(CONSTRUCT_LOCATION(@$),
 			toycc::Module::extern_global_variable,
 			std::move($1));
+	}
+	| Module StructDef ";" {
+		$$ = std::make_unique<toycc::Module>(CONSTRUCT_LOCATION(@$),
+			std::move($1), std::move($2));
+	}
+	| StructDef ";" {
+		$$ = std::make_unique<toycc::Module>(CONSTRUCT_LOCATION(@$),
+			std::move($1));
 	};
 
+// 结构体定义, 属性写在"}"之后, 如__attribute__((packed))
+StructDef
+	: StructFields "}" {
+		$$ = std::move($1);
+	}
+	| StructDef KW_ATTRIBUTE "(" "(" Ident ")" ")" {
+		auto attribute_ptr = std::make_unique<toycc::Attribute>(
+			CONSTRUCT_LOCATION(@2), std::move($5));
+		$$ = std::make_unique<toycc::StructDef>(CONSTRUCT_LOCATION(@$),
+			std::move($1), std::move(attribute_ptr));
+	};
+
+StructFields
+	: KW_STRUCT Ident "{" {
+		$$ = std::make_unique<toycc::StructDef>(CONSTRUCT_LOCATION(@$),
+			std::move($2));
+	}
+	| StructFields VarDecl {
+		$$ = std::make_unique<toycc::StructDef>(CONSTRUCT_LOCATION(@$),
+			std::move($1), std::move($2));
+	};
+
+// 返回类型分开书写, 读到"("之前不需要决定是函数定义还是全局变量
 FuncDef :
-//   1	   2 	3      4   	  5   6
-	BuiltinType Ident "(" ParamList ")" Block
+//   1	   2 	   3      4   	  5   6   7
+	ScalarType Pointer Ident "(" ParamList ")" Block
 	{
-		assert_same_ptr(toycc::BuiltinType,$1);
-		assert_same_ptr(toycc::Ident, $2);
-		assert_same_ptr(toycc::ParamList, $4);
-		assert_same_ptr(toycc::Block, $6);
+		assert_same_ptr(toycc::ScalarType,$1);
+		assert_same_ptr(toycc::Pointer, $2);
+		assert_same_ptr(toycc::Ident, $3);
+		assert_same_ptr(toycc::ParamList, $5);
+		assert_same_ptr(toycc::Block, $7);
+
+		auto type_ptr = std::make_unique<toycc::BuiltinType>(
+			CONSTRUCT_LOCATION(@1), ($1)->get_type(), ($1)->get_lanes(),
+			std::string{($1)->get_struct_name()});
+		auto funcdef_ptr = std::make_unique<toycc::FuncDef>(
+			CONSTRUCT_LOCATION(@$), std::move(type_ptr), std::move($2),
+			std::move($3), std::move($5), std::move($7)
+		);
+		funcdef_ptr->set_has_labels(driver.take_label_mark());
+		funcdef_ptr->set_address_taken(driver.take_address_taken());
 
+		$$ = std::move(funcdef_ptr);
+	}
+	| KW_VOID Ident "(" ParamList ")" Block
+	{
+		auto type_ptr = std::make_unique<toycc::BuiltinType>(
+			CONSTRUCT_LOCATION(@1), toycc::BuiltinTypeEnum::ty_void);
 		auto funcdef_ptr = std::make_unique<toycc::FuncDef>(
 			CONSTRUCT_LOCATION(@$),
-			std::move($1), std::move($2), std::move($4), std::move($6)
+			std::move(type_ptr), std::move($2), std::move($4), std::move($6)
 		);
+		funcdef_ptr->set_has_labels(driver.take_label_mark());
+		funcdef_ptr->set_address_taken(driver.take_address_taken());
 
 		$$ = std::move(funcdef_ptr);
+	}
+	// 以常量实参调用时在编译期求值
+	| KW_EVAL FuncDef
+	{
+		assert_same_ptr(toycc::FuncDef, $2);
+		$$ = std::move($2);
+		$$->set_eval(true);
 	};
 
 ParamList :
@@ -200,11 +283,12 @@ ParamList :
 	}
 
 Param :
-	ScalarType Ident
+	ScalarType Pointer Ident ArrayDims
 	{
 		assert_same_ptr(toycc::ScalarType, $1);
-		assert_same_ptr(toycc::Ident, $2);
-		auto param_ptr = std::make_unique<toycc::Param>(CONSTRUCT_LOCATION(@$), std::move($1), std::move($2));
+		assert_same_ptr(toycc::Ident, $3);
+		auto param_ptr = std::make_unique<toycc::Param>(CONSTRUCT_LOCATION(@$),
+			std::move($1), std::move($2), std::move($3), std::move($4));
 		$$ = std::move(param_ptr);
 	}
 
@@ -214,17 +298,18 @@ ScalarType
 	}
 	| KW_UINT {
 		$$ = std::make_unique<toycc::ScalarType>(CONSTRUCT_LOCATION(@$), toycc::BuiltinTypeEnum::ty_unsigned_int);
-	};
-
-BuiltinType
-	: ScalarType {
-		assert_same_ptr(toycc::ScalarType, $1);
-		// 直接构造，与文法原本语义不同
-		$$ = std::make_unique<toycc::BuiltinType>(CONSTRUCT_LOCATION(@$), ($1)->get_type());
 	}
-	| KW_VOID {
-		$$ = std::make_unique<toycc::BuiltinType>(CONSTRUCT_LOCATION(@$),
-			toycc::BuiltinTypeEnum::ty_void);
+	| KW_SINT_VECTOR {
+		$$ = std::make_unique<toycc::ScalarType>(CONSTRUCT_LOCATION(@$),
+			toycc::BuiltinTypeEnum::ty_signed_int, static_cast<unsigned>($1));
+	}
+	| KW_UINT_VECTOR {
+		$$ = std::make_unique<toycc::ScalarType>(CONSTRUCT_LOCATION(@$),
+			toycc::BuiltinTypeEnum::ty_unsigned_int, static_cast<unsigned>($1));
+	}
+	| KW_STRUCT Ident {
+		$$ = std::make_unique<toycc::ScalarType>(CONSTRUCT_LOCATION(@$),
+			std::string{($2)->get_value()});
 	};
 
 Decl
@@ -282,17 +367,60 @@ VarDecl
 	};
 
 VarDef 	
-	: Ident {
+	: Pointer Ident ArrayDims Attribute {
 		$$ = std::make_unique<toycc::VarDef>(CONSTRUCT_LOCATION(@$),
-			std::move($1)
+			std::move($1), std::move($2), std::move($3), std::move($4), nullptr
 		);
 	}
-	| Ident "=" InitVal {
+	| Pointer Ident ArrayDims Attribute "=" InitVal {
 		$$ = std::make_unique<toycc::VarDef>(CONSTRUCT_LOCATION(@$),
-			std::move($1), std::move($3)
+			std::move($1), std::move($2), std::move($3), std::move($4),
+			std::move($6)
 		);
 	};
 
+// 指针声明符, 每个"*"之后可以有restrict限定
+Pointer
+	: /* empty */ {
+		$$ = std::make_unique<toycc::Pointer>(CONSTRUCT_LOCATION(@$));
+	}
+	| Pointer "*" {
+		$$ = std::move($1);
+		$$->add_level(false);
+	}
+	| Pointer "*" KW_RESTRICT {
+		$$ = std::move($1);
+		$$->add_level(true);
+	};
+
+// 数组的各维大小, 由代码生成阶段求值
+ArrayDims
+	: /* empty */ {
+		$$ = std::make_unique<toycc::ArrayDims>(CONSTRUCT_LOCATION(@$));
+	}
+	| ArrayDims "[" ConstExpr "]" {
+		$$ = std::move($1);
+		$$->add_dim(std::move($3));
+	}
+	| ArrayDims "[" "]" {
+		$$ = std::move($1);
+		$$->add_dim(nullptr);
+	};
+
+// 变量的属性, 可以为空
+Attribute
+	: /* empty */ {
+		$$ = nullptr;
+	}
+	| KW_ATTRIBUTE "(" "(" Ident "(" Number ")" ")" ")" {
+		$$ = std::make_unique<toycc::Attribute>(CONSTRUCT_LOCATION(@$),
+			std::move($4), std::move($6));
+	}
+	| KW_ATTRIBUTE "(" "(" Ident ")" ")" {
+		$$ = std::make_unique<toycc::Attribute>(CONSTRUCT_LOCATION(@$),
+			std::move($4));
+	};
+
 VarDefList		
 	: /* empty */ {
 		$$ = std::make_unique<toycc::VarDefList>(CONSTRUCT_LOCATION(@$));
@@ -344,10 +472,32 @@ BlockItem
 			std::move($1));
 	};
 
+// 下标和成员访问只作用于变量, *p[i]解析为*(p[i]), *p.x解析为*(p.x)
 LVal
+	: SubscriptLVal {
+		$$ = std::move($1);
+	}
+	| "*" UnaryExpr {
+		assert_same_ptr(toycc::UnaryExpr, $2);
+		$$ = std::make_unique<toycc::LVal>(CONSTRUCT_LOCATION(@$), std::move($2));
+	};
+
+SubscriptLVal
 	: Ident {
 		assert_same_ptr(toycc::Ident, $1);
 		$$ = std::make_unique<toycc::LVal>(CONSTRUCT_LOCATION(@$), std::move($1));
+	}
+	| SubscriptLVal "[" Expr "]" {
+		$$ = std::make_unique<toycc::LVal>(CONSTRUCT_LOCATION(@$),
+			std::move($1), std::move($3));
+	}
+	| SubscriptLVal "." Ident {
+		$$ = std::make_unique<toycc::LVal>(CONSTRUCT_LOCATION(@$),
+			std::move($1), std::move($3), false);
+	}
+	| SubscriptLVal "->" Ident {
+		$$ = std::make_unique<toycc::LVal>(CONSTRUCT_LOCATION(@$),
+			std::move($1), std::move($3), true);
 	};
 
 SimpleStmt
@@ -373,16 +523,125 @@ SimpleStmt
 		$$ = std::make_unique<toycc::SimpleStmt>(CONSTRUCT_LOCATION(@$),
 			toycc::SimpleStmt::func_return);
 	}
+	| KW_BREAK DELIM_SEMICOLON {
+		$$ = std::make_unique<toycc::SimpleStmt>(CONSTRUCT_LOCATION(@$),
+			toycc::SimpleStmt::loop_break);
+	}
+	| KW_CONTINUE DELIM_SEMICOLON {
+		$$ = std::make_unique<toycc::SimpleStmt>(CONSTRUCT_LOCATION(@$),
+			toycc::SimpleStmt::loop_continue);
+	}
+	| KW_GOTO Ident DELIM_SEMICOLON {
+		$$ = std::make_unique<toycc::SimpleStmt>(CONSTRUCT_LOCATION(@$),
+			toycc::SimpleStmt::jump_goto, std::move($2));
+	}
+	| KW_GOTO "*" Expr DELIM_SEMICOLON {
+		$$ = std::make_unique<toycc::SimpleStmt>(CONSTRUCT_LOCATION(@$),
+			toycc::SimpleStmt::computed_goto, std::move($3));
+	}
 	| Block {
 		$$ = std::make_unique<toycc::SimpleStmt>(CONSTRUCT_LOCATION(@$),
 			toycc::SimpleStmt::block, std::move($1));
 	};
 
+// for语句的初始化和步进部分, 不带分号
+ForStep
+	: /* empty */ {
+		$$ = std::make_unique<toycc::SimpleStmt>(CONSTRUCT_LOCATION(@$),
+			toycc::SimpleStmt::expression);
+	}
+	| LVal "=" Expr {
+		$$ = std::make_unique<toycc::SimpleStmt>(CONSTRUCT_LOCATION(@$),
+			toycc::SimpleStmt::assign, std::move($1), std::move($3));
+	}
+	| Expr {
+		$$ = std::make_unique<toycc::SimpleStmt>(CONSTRUCT_LOCATION(@$),
+			toycc::SimpleStmt::expression, std::move($1));
+	};
+
+ForClause
+	// 1	2	3	4	5
+	: ForStep ";" ";" ForStep {
+		$$ = std::make_unique<toycc::ForClause>(CONSTRUCT_LOCATION(@$),
+			std::move($1), nullptr, std::move($4));
+	}
+	| ForStep ";" Expr ";" ForStep {
+		$$ = std::make_unique<toycc::ForClause>(CONSTRUCT_LOCATION(@$),
+			std::move($1), std::move($3), std::move($5));
+	}
+	// VarDecl包含分号
+	| VarDecl ";" ForStep {
+		$$ = std::make_unique<toycc::ForClause>(CONSTRUCT_LOCATION(@$),
+			std::move($1), nullptr, std::move($3));
+	}
+	| VarDecl Expr ";" ForStep {
+		$$ = std::make_unique<toycc::ForClause>(CONSTRUCT_LOCATION(@$),
+			std::move($1), std::move($2), std::move($4));
+	};
+
+LoopHint
+	: Ident "(" Ident ")" {
+		$$ = std::make_unique<toycc::LoopHint>(CONSTRUCT_LOCATION(@$),
+			std::move($1), std::move($3));
+	}
+	| Ident "(" Number ")" {
+		$$ = std::make_unique<toycc::LoopHint>(CONSTRUCT_LOCATION(@$),
+			std::move($1), std::move($3));
+	};
+
+// 同一行#pragma toycc中的提示
+PragmaHints
+	: LoopHint {
+		$$ = std::make_unique<toycc::LoopHintList>(CONSTRUCT_LOCATION(@$));
+		$$->add_hint(std::move($1));
+	}
+	| PragmaHints LoopHint {
+		$$ = std::move($1);
+		$$->add_hint(std::move($2));
+	};
+
+// 循环语句之前的#pragma toycc, 可以为空
+LoopHintList
+	: /* empty */ {
+		$$ = std::make_unique<toycc::LoopHintList>(CONSTRUCT_LOCATION(@$));
+	}
+	| LoopHintList KW_PRAGMA_TOYCC PragmaHints PRAGMA_END {
+		$$ = std::move($1);
+		$$->merge(std::move($3));
+	};
+
 OpenStmt:
-	// 1 		2	3	 4	 5
-	KW_WHILE "(" Expr ")" OpenStmt {
+	// 1 			2		3	4	 5	 6
+	LoopHintList KW_WHILE "(" Expr ")" OpenStmt {
+		$$ = std::make_unique<toycc::OpenStmt>(CONSTRUCT_LOCATION(@$),
+			toycc::BranchType::while_stmt, std::move($4), std::move($6));
+		$$->set_loop_hints(std::move($1));
+	}
+	| LoopHintList KW_FOR "(" ForClause ")" OpenStmt {
+		$$ = std::make_unique<toycc::OpenStmt>(CONSTRUCT_LOCATION(@$),
+			toycc::BranchType::for_stmt, std::move($4), std::move($6));
+		$$->set_loop_hints(std::move($1));
+	}
+	| KW_SWITCH "(" Expr ")" OpenStmt {
+		$$ = std::make_unique<toycc::OpenStmt>(CONSTRUCT_LOCATION(@$),
+			toycc::BranchType::switch_stmt, std::move($3), std::move($5));
+	}
+	// case的值由代码生成阶段求值, 需要是整数常量表达式
+	| KW_CASE Expr ":" OpenStmt {
+		$$ = std::make_unique<toycc::OpenStmt>(CONSTRUCT_LOCATION(@$),
+			toycc::BranchType::case_stmt, std::move($2), std::move($4));
+		driver.mark_label();
+	}
+	| KW_DEFAULT ":" OpenStmt {
 		$$ = std::make_unique<toycc::OpenStmt>(CONSTRUCT_LOCATION(@$),
-			toycc::BranchType::while_stmt, std::move($3), std::move($5));
+			toycc::BranchType::default_stmt,
+			std::unique_ptr<toycc::Expr>{}, std::move($3));
+		driver.mark_label();
+	}
+	| Ident ":" OpenStmt {
+		$$ = std::make_unique<toycc::OpenStmt>(CONSTRUCT_LOCATION(@$),
+			toycc::BranchType::label_stmt, std::move($1), std::move($3));
+		driver.mark_label();
 	}
 	| KW_IF "(" Expr ")" Stmt {
 		$$ = std::make_unique<toycc::OpenStmt>(CONSTRUCT_LOCATION(@$),
@@ -396,9 +655,41 @@ OpenStmt:
 	};
 
 ClosedStmt:
-	KW_WHILE "(" Expr ")" ClosedStmt {
+	LoopHintList KW_WHILE "(" Expr ")" ClosedStmt {
+		$$ = std::make_unique<toycc::ClosedStmt>(CONSTRUCT_LOCATION(@$),
+			toycc::BranchType::while_stmt, std::move($4), std::move($6));
+		$$->set_loop_hints(std::move($1));
+	}
+	| LoopHintList KW_FOR "(" ForClause ")" ClosedStmt {
 		$$ = std::make_unique<toycc::ClosedStmt>(CONSTRUCT_LOCATION(@$),
-			toycc::BranchType::while_stmt, std::move($3), std::move($5));
+			toycc::BranchType::for_stmt, std::move($4), std::move($6));
+		$$->set_loop_hints(std::move($1));
+	}
+	| KW_SWITCH "(" Expr ")" ClosedStmt {
+		$$ = std::make_unique<toycc::ClosedStmt>(CONSTRUCT_LOCATION(@$),
+			toycc::BranchType::switch_stmt, std::move($3), std::move($5));
+	}
+	| KW_CASE Expr ":" ClosedStmt {
+		$$ = std::make_unique<toycc::ClosedStmt>(CONSTRUCT_LOCATION(@$),
+			toycc::BranchType::case_stmt, std::move($2), std::move($4));
+		driver.mark_label();
+	}
+	| KW_DEFAULT ":" ClosedStmt {
+		$$ = std::make_unique<toycc::ClosedStmt>(CONSTRUCT_LOCATION(@$),
+			toycc::BranchType::default_stmt,
+			std::unique_ptr<toycc::Expr>{}, std::move($3));
+		driver.mark_label();
+	}
+	| Ident ":" ClosedStmt {
+		$$ = std::make_unique<toycc::ClosedStmt>(CONSTRUCT_LOCATION(@$),
+			toycc::BranchType::label_stmt, std::move($1), std::move($3));
+		driver.mark_label();
+	}
+	// 1			2	 3		4		5	6	 7	 8
+	| LoopHintList KW_DO Stmt KW_WHILE "(" Expr ")" ";" {
+		$$ = std::make_unique<toycc::ClosedStmt>(CONSTRUCT_LOCATION(@$),
+			toycc::BranchType::do_while_stmt, std::move($3), std::move($6));
+		$$->set_loop_hints(std::move($1));
 	}
 	| SimpleStmt {
 		$$ = std::make_unique<toycc::ClosedStmt>(CONSTRUCT_LOCATION(@$),
@@ -461,6 +752,17 @@ UnaryExpr
 	| Ident "(" PassingParams ")" {
 		$$ = std::make_unique<toycc::UnaryExpr>(CONSTRUCT_LOCATION(@$),
 			toycc::UnaryExpr::call_with_params, std::move($1), std::move($3));
+	}
+	| "&&" Ident {
+		$$ = std::make_unique<toycc::UnaryExpr>(CONSTRUCT_LOCATION(@$),
+			toycc::UnaryExpr::label_address, std::move($2));
+	}
+	| "&" LVal {
+		// 被取地址的变量不能只存在于寄存器中, 带下标或成员时是内存中的对象
+		if (($2)->is_named() && !($2)->has_indices())
+			driver.mark_address_taken(($2)->get_id().get_value());
+		$$ = std::make_unique<toycc::UnaryExpr>(CONSTRUCT_LOCATION(@$),
+			toycc::UnaryExpr::address_of, std::move($2));
 	};
 
 PassingParams
@@ -1,3 +1,4 @@
+#include <utility>
 #include <llvm/IR/Type.h>
 #include <llvm/Support/Casting.h>
 #include <llvm/IR/DerivedTypes.h>
@@ -18,6 +19,249 @@ auto make_error_code(conversion_error e) -> std::error_code
 
 }	//namespace toycc::utils
 
+namespace
+{
+
+/// 转换格中的一项, 转换种类在构造ConversionTable时替换为策略
+struct ConversionRule
+{
+	utils::conversion_error kind = utils::conversion_error::unsupport_cvt;
+	TypeId result = TypeId::ty_void;
+};
+
+using Lattice =
+	std::array<ConversionRule, builtin_type_count * builtin_type_count>;
+
+constexpr auto get_builtin_info(TypeId id, std::uint32_t long_bit_width)
+	-> TypeInfo
+{
+	auto info = builtin_type_infos[to_index(id)];
+	if (info.kind == TypeInfo::integer_kind && info.bit_width == 0)
+		info.bit_width = long_bit_width;
+	return info;
+}
+
+/// 整数转换等级, _Bool最低
+constexpr auto get_int_rank(TypeId id) -> int
+{
+	switch(id)
+	{
+	case TypeId::ty_bool:
+		return 0;
+	case TypeId::ty_schar:
+	case TypeId::ty_uchar:
+		return 1;
+	case TypeId::ty_sshort:
+	case TypeId::ty_ushort:
+		return 2;
+	case TypeId::ty_sint:
+	case TypeId::ty_uint:
+		return 3;
+	case TypeId::ty_slong:
+	case TypeId::ty_ulong:
+		return 4;
+	case TypeId::ty_slong_long:
+	case TypeId::ty_ulong_long:
+		return 5;
+	default:
+		return -1;
+	}
+}
+
+/// 整数提升, 等级低于int的类型都可以由int表示
+constexpr auto promote(TypeId id) -> TypeId
+{
+	return get_int_rank(id) < get_int_rank(TypeId::ty_sint) ? TypeId::ty_sint
+															: id;
+}
+
+/// @note type_id.def中有符号整数之后紧跟同等级的无符号整数
+constexpr auto to_unsigned(TypeId id) -> TypeId
+{
+	if (!builtin_type_infos[to_index(id)].is_signed)
+		return id;
+	return static_cast<TypeId>(static_cast<std::uint32_t>(id) + 1);
+}
+
+/// 赋值时right转换到left
+constexpr auto make_value_rule(TypeId left, TypeId right,
+							   std::uint32_t long_bit_width) -> ConversionRule
+{
+	using enum utils::conversion_error;
+	auto left_info = get_builtin_info(left, long_bit_width);
+	auto right_info = get_builtin_info(right, long_bit_width);
+
+	if (left_info.kind == TypeInfo::void_kind
+		|| right_info.kind == TypeInfo::void_kind)
+		return { unsupport_cvt, TypeId::ty_void };
+	if (left == right)
+		return { none, left };
+
+	if (left_info.kind == TypeInfo::integer_kind
+		&& right_info.kind == TypeInfo::integer_kind)
+	{
+		if (left == TypeId::ty_bool)
+			return { bool_cvt, left };
+		if (left_info.bit_width > right_info.bit_width)
+			return { int_promotion, left };
+		if (left_info.bit_width < right_info.bit_width)
+			return { int_narrowing, left };
+		if (right_info.is_signed && !left_info.is_signed)
+			return { sign_to_unsign_same_width, left };
+		if (!right_info.is_signed && left_info.is_signed)
+			return { unsign_to_sign_same_width, left };
+		// 宽度和符号都相同, 例如64位平台上的long和long long
+		return { none, left };
+	}
+	if (left_info.kind == TypeInfo::floating_kind)
+	{
+		if (right_info.kind == TypeInfo::integer_kind)
+			return { float2int_cvt, left };
+		return { float_cvt, left };
+	}
+
+	return { unsupport_cvt, TypeId::ty_void };
+}
+
+/// 通常算术转换
+constexpr auto make_arithmetic_rule(TypeId left, TypeId right,
+									std::uint32_t long_bit_width)
+	-> ConversionRule
+{
+	using enum utils::conversion_error;
+	auto left_info = get_builtin_info(left, long_bit_width);
+	auto right_info = get_builtin_info(right, long_bit_width);
+
+	if (left_info.kind == TypeInfo::void_kind
+		|| right_info.kind == TypeInfo::void_kind)
+		return { unsupport_cvt, TypeId::ty_void };
+
+	if (left_info.kind == TypeInfo::floating_kind
+		|| right_info.kind == TypeInfo::floating_kind)
+	{
+		if (left_info.kind != right_info.kind)
+			return { float2int_cvt, left_info.kind == TypeInfo::floating_kind
+										? left : right };
+		if (left == right)
+			return { none, left };
+		return { float_cvt, left_info.bit_width > right_info.bit_width
+								? left : right };
+	}
+
+	auto left_promoted = promote(left);
+	auto right_promoted = promote(right);
+	auto kind = left == right && left == left_promoted ? none : int_promotion;
+	left_info = get_builtin_info(left_promoted, long_bit_width);
+	right_info = get_builtin_info(right_promoted, long_bit_width);
+
+	if (left_promoted == right_promoted)
+		return { kind, left_promoted };
+	if (left_info.is_signed == right_info.is_signed)
+		return { kind, get_int_rank(left_promoted) > get_int_rank(right_promoted)
+						   ? left_promoted : right_promoted };
+
+	auto [ signed_id, unsigned_id ] = left_info.is_signed
+		? std::pair { left_promoted, right_promoted }
+		: std::pair { right_promoted, left_promoted };
+	if (get_int_rank(unsigned_id) >= get_int_rank(signed_id))
+		return { kind, unsigned_id };
+	// 有符号类型能表示无符号类型的所有值
+	if (get_builtin_info(signed_id, long_bit_width).bit_width
+		> get_builtin_info(unsigned_id, long_bit_width).bit_width)
+		return { kind, signed_id };
+	return { kind, to_unsigned(signed_id) };
+}
+
+template <typename Func>
+constexpr auto make_lattice(Func make_rule, std::uint32_t long_bit_width)
+	-> Lattice
+{
+	Lattice result {};
+	for (std::size_t left = 0; left < builtin_type_count; ++left)
+		for (std::size_t right = 0; right < builtin_type_count; ++right)
+			result[left * builtin_type_count + right] =
+				make_rule(static_cast<TypeId>(left), static_cast<TypeId>(right),
+						  long_bit_width);
+	return result;
+}
+
+constexpr Lattice value_lattice_long32 = make_lattice(make_value_rule, 32);
+constexpr Lattice value_lattice_long64 = make_lattice(make_value_rule, 64);
+constexpr Lattice arithmetic_lattice_long32 =
+	make_lattice(make_arithmetic_rule, 32);
+constexpr Lattice arithmetic_lattice_long64 =
+	make_lattice(make_arithmetic_rule, 64);
+
+constexpr auto lattice_at(const Lattice& lattice, TypeId left, TypeId right)
+	-> ConversionRule
+{
+	return lattice[to_index(left) * builtin_type_count + to_index(right)];
+}
+
+static_assert(lattice_at(arithmetic_lattice_long64, TypeId::ty_sint,
+						 TypeId::ty_uint).result == TypeId::ty_uint);
+static_assert(lattice_at(arithmetic_lattice_long64, TypeId::ty_slong,
+						 TypeId::ty_uint).result == TypeId::ty_slong);
+static_assert(lattice_at(arithmetic_lattice_long32, TypeId::ty_slong,
+						 TypeId::ty_uint).result == TypeId::ty_ulong);
+static_assert(lattice_at(arithmetic_lattice_long64, TypeId::ty_schar,
+						 TypeId::ty_sshort).result == TypeId::ty_sint);
+static_assert(lattice_at(value_lattice_long64, TypeId::ty_uint,
+						 TypeId::ty_sint).kind
+			  == utils::conversion_error::sign_to_unsign_same_width);
+
+/// 依据ConversionConfig将转换格替换为策略
+auto apply_config(const Lattice& lattice, const ConversionConfig& config)
+	-> std::array<ConversionEntry, builtin_type_count * builtin_type_count>
+{
+	std::array<ConversionEntry, builtin_type_count * builtin_type_count> result;
+	for (std::size_t i = 0; i < lattice.size(); ++i)
+	{
+		auto status = config.get_status(lattice[i].kind);
+		result[i] = ConversionEntry {
+			.status = status,
+			.error = lattice[i].kind,
+			.result = status == ConversionStatus::failure ? TypeId::ty_void
+														  : lattice[i].result,
+		};
+	}
+	return result;
+}
+
+}	//namespace
+
+auto ConversionConfig::get_status(utils::conversion_error kind) const
+	-> ConversionStatus
+{
+	switch(kind)
+	{
+	case utils::conversion_error::none:
+		return ConversionStatus::success;
+#define CVT_KIND(kind, msg)                                                    \
+	case utils::conversion_error::kind:                                        \
+		return kind##_status;
+
+#include "conversion.def"
+
+#undef CVT_KIND
+	case utils::conversion_error::unsupport_cvt:
+	default:
+		return ConversionStatus::failure;
+	}
+}
+
+ConversionTable::ConversionTable(const ConversionConfig& config,
+								 std::uint32_t long_bit_width)
+{
+	assert(long_bit_width == 32 || long_bit_width == 64);
+	auto is_long32 = long_bit_width == 32;
+	m_value = apply_config(
+		is_long32 ? value_lattice_long32 : value_lattice_long64, config);
+	m_arithmetic = apply_config(
+		is_long32 ? arithmetic_lattice_long32 : arithmetic_lattice_long64,
+		config);
+}
+
 void ConversionResult::set_success(llvm::Type* type)
 {
 	status = ConversionStatus::success;
@@ -44,6 +288,71 @@ void ConversionResult::set_failure(utils::conversion_error desc)
  *	INTERFACE PUBLIC
  */
 
+auto ConversionHelper::value_conversion(TypeId left, TypeId right,
+										const llvm::ConstantRange& range) const
+	-> ConversionResult
+{
+	const auto& entry = m_table.value(left, right);
+	if (entry.status == ConversionStatus::success
+		|| entry.error == utils::conversion_error::unsupport_cvt
+		|| !is_value_preserving(left, right, range))
+		return entry.to_result();
+
+	return { ConversionStatus::success, nullptr,
+			 utils::conversion_error::none, left };
+}
+
+auto ConversionHelper::is_value_preserving(TypeId left, TypeId right,
+										   const llvm::ConstantRange& range) const
+	-> bool
+{
+	// 足够容纳所有内建整数类型的值
+	constexpr std::uint32_t wide_bit_width = 128;
+
+	if (!is_builtin(left) || !is_builtin(right))
+		return false;
+	auto left_info = builtin_type_infos[to_index(left)];
+	auto right_info = builtin_type_infos[to_index(right)];
+	if (right_info.kind != TypeInfo::integer_kind
+		|| range.getBitWidth() > wide_bit_width)
+		return false;
+	if (left_info.bit_width == 0)
+		left_info.bit_width = m_long_bit_width;
+
+	auto wide_range = right_info.is_signed ? range.signExtend(wide_bit_width)
+										   : range.zeroExtend(wide_bit_width);
+	auto make_range = [](std::int64_t lower, llvm::APInt upper) {
+		return llvm::ConstantRange {
+			llvm::APInt(wide_bit_width, static_cast<std::uint64_t>(lower), true),
+			upper + 1
+		};
+	};
+
+	llvm::ConstantRange allowed = llvm::ConstantRange::getEmpty(wide_bit_width);
+	if (left == TypeId::ty_bool)
+	{
+		allowed = make_range(0, llvm::APInt(wide_bit_width, 1));
+	}
+	else if (left_info.kind == TypeInfo::integer_kind)
+	{
+		auto width = left_info.bit_width;
+		allowed = left_info.is_signed
+			? llvm::ConstantRange {
+				llvm::APInt::getSignedMinValue(width).sext(wide_bit_width),
+				llvm::APInt::getSignedMaxValue(width).sext(wide_bit_width) + 1 }
+			: make_range(0, llvm::APInt::getMaxValue(width).zext(wide_bit_width));
+	}
+	else if (left_info.kind == TypeInfo::floating_kind)
+	{
+		// 绝对值不超过2^尾数位数的整数可以被精确表示
+		auto mantissa = left_info.bit_width == 32 ? 24u : 53u;
+		auto bound = llvm::APInt::getOneBitSet(wide_bit_width, mantissa);
+		allowed = llvm::ConstantRange { -bound, bound + 1 };
+	}
+
+	return allowed.contains(wide_range);
+}
+
 auto ConversionHelper::value_conversion(llvm::Type* left, llvm::Type* right)
 	-> ConversionResult
 {
@@ -78,8 +387,8 @@ auto ConversionHelper::arithmetic_conversion(llvm::Type* left,
 
 auto ConversionHelper::convert_to_bool(llvm::Type* left) -> bool
 {
-	(void)left;
-	return true;
+	return left->isIntegerTy() || left->isFloatingPointTy()
+		|| left->isPointerTy();
 }
 
 
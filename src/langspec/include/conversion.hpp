@@ -1,9 +1,13 @@
 #pragma once
+#include <array>
+#include <cstdint>
 #include <expected>
 #include <system_error>
 #include <memory>
+#include <llvm/IR/ConstantRange.h>
 #include <llvm/IR/Value.h>
 #include <llvm/IR/Type.h>
+#include "type_id.hpp"
 
 namespace toycc
 {
@@ -87,6 +91,8 @@ struct ConversionResult
 	ConversionStatus status;
 	llvm::Type* result_type = nullptr;
 	std::error_code ec;
+	/// 以TypeId查询时的结果类型, 失败时为ty_void
+	TypeId result_id = TypeId::ty_void;
 
     // 辅助构造函数
 	static auto success(llvm::Type* type) -> ConversionResult
@@ -111,6 +117,20 @@ struct ConversionResult
 
 };
 
+/// ConversionTable中的一项, 查询结果只需要一次数组访问
+struct ConversionEntry
+{
+	ConversionStatus status = ConversionStatus::failure;
+	utils::conversion_error error = utils::conversion_error::unsupport_cvt;
+	TypeId result = TypeId::ty_void;
+
+	[[nodiscard]]
+	auto to_result() const -> ConversionResult
+	{
+		return { status, nullptr, error, result };
+	}
+};
+
 struct ConversionConfig
 {
 #define CVT_KIND(kind, msg) \
@@ -142,6 +162,56 @@ struct ConversionConfig
 		}
 
 	}
+
+	/// @brief 查询转换种类对应的策略, none总是成功, unsupport_cvt总是失败
+	[[nodiscard]]
+	auto get_status(utils::conversion_error kind) const -> ConversionStatus;
+};
+
+/**
+ * @brief 内建类型之间的转换表, 以(目标类型, 源类型)的TypeId为下标
+ * @details 转换种类和结果类型组成的转换格在编译期由conversion.def和
+ *          type_id.def生成(long的宽度为32和64各一份), 构造时依据
+ *          ConversionConfig将转换种类替换为对应的策略
+ * @note 派生类型(指针, 数组)不在表中, 查询结果为unsupport_cvt
+ */
+class ConversionTable
+{
+public:
+	/**
+	 * @param config 构造后config的修改不会影响转换表
+	 * @param long_bit_width 目标平台上long的宽度, 只支持32和64
+	 */
+	ConversionTable(const ConversionConfig& config,
+					std::uint32_t long_bit_width);
+
+	/// @brief 赋值时right转换到left
+	[[nodiscard]]
+	auto value(TypeId left, TypeId right) const -> const ConversionEntry&
+	{
+		if (!is_builtin(left) || !is_builtin(right))
+			return s_unsupported;
+		return m_value[to_index(left) * builtin_type_count + to_index(right)];
+	}
+
+	/// @brief 算术运算中left和right的通常算术转换
+	[[nodiscard]]
+	auto arithmetic(TypeId left, TypeId right) const -> const ConversionEntry&
+	{
+		if (!is_builtin(left) || !is_builtin(right))
+			return s_unsupported;
+		return m_arithmetic[to_index(left) * builtin_type_count
+							+ to_index(right)];
+	}
+
+private:
+	using Entries =
+		std::array<ConversionEntry, builtin_type_count * builtin_type_count>;
+
+	static constexpr ConversionEntry s_unsupported {};
+
+	Entries m_value;
+	Entries m_arithmetic;
 };
 
 
@@ -157,11 +227,15 @@ public:
      * @brief 构造函数
      * @param config 配置对象
      * @param context LLVM 上下文
+     * @param long_bit_width 目标平台上long的宽度
      */
     ConversionHelper(std::shared_ptr<ConversionConfig> config,
-                     llvm::LLVMContext& context):
+                     llvm::LLVMContext& context,
+					 std::uint32_t long_bit_width = 64):
 		m_config { config },
-		m_context { context }
+		m_context { context },
+		m_long_bit_width { long_bit_width },
+		m_table { *config, long_bit_width }
 	{}
 
 	virtual ~ConversionHelper() = default;
@@ -188,8 +262,47 @@ public:
     auto arithmetic_conversion(llvm::Type* left, llvm::Type* right)
         -> ConversionResult;
 
+	/**
+	 * @brief 以TypeId查询值变换, 结果来自转换表
+	 * @note 与llvm::Type*版本不同, 可以区分有无符号
+	 */
+	[[nodiscard]]
+	auto value_conversion(TypeId left, TypeId right) const -> ConversionResult
+	{ return m_table.value(left, right).to_result(); }
+
+	/**
+	 * @brief 依据源值的取值范围查询值变换
+	 * @details 整数间或整数到浮点的转换能够保持range中所有值时,
+	 *          视为没有发生转换, 不再应用配置的策略
+	 * @param range 源值的取值范围, 按right的符号解释
+	 */
+	[[nodiscard]]
+	auto value_conversion(TypeId left, TypeId right,
+						  const llvm::ConstantRange& range) const
+		-> ConversionResult;
+
+	/// @brief range中的值转换为left后是否保持不变
+	[[nodiscard]]
+	auto is_value_preserving(TypeId left, TypeId right,
+							 const llvm::ConstantRange& range) const -> bool;
+
+	/// @brief 以TypeId查询通常算术转换, 结果来自转换表
+	[[nodiscard]]
+	auto arithmetic_conversion(TypeId left, TypeId right) const
+		-> ConversionResult
+	{ return m_table.arithmetic(left, right).to_result(); }
+
+	[[nodiscard]]
+	auto get_table() const -> const ConversionTable&
+	{ return m_table; }
+
+	/// @brief 配置对象被修改后重新生成转换表
+	void reload_config()
+	{ m_table = ConversionTable { *m_config, m_long_bit_width }; }
+
 	/**
 	 * @brief 查询类型转换到bool是否合法
+	 * @note 只有标量(整数, 浮点数和指针)可以作为条件, 向量需要先归约为标量
 	 */
 	[[nodiscard]]
 	auto convert_to_bool(llvm::Type* left) -> bool;
@@ -222,6 +335,8 @@ protected:
 private:
     std::shared_ptr<ConversionConfig> m_config; // 配置对象
     llvm::LLVMContext& m_context;               // LLVM 上下文
+	std::uint32_t m_long_bit_width;
+	ConversionTable m_table;
 };
 
 }	//toycc
@@ -1,8 +1,13 @@
 #pragma once
+#include <atomic>
+#include <memory>
+#include <shared_mutex>
 #include <unordered_map>
 #include <string_view>
+#include <vector>
 #include <llvm/IR/Value.h>
 #include <llvm/IR/Instructions.h>
+#include "type_id.hpp"
 
 namespace toycc
 {
@@ -14,6 +19,8 @@ struct SymbolEntry
 		eval_value,
 		alloca_value,
 		func_value,
+		ssa_value,		// 不分配内存, 当前值由SSABuilder维护
+		address_value,	// 全局变量和局部数组, value为对象的地址
 	};
 
 	SymbolEntry(EntryType type_, llvm::Value* value_):
@@ -26,23 +33,87 @@ struct SymbolEntry
 		type { alloca_value }, alloca { alloca_ }
 	{}
 
+	SymbolEntry(llvm::Type* ssa_type_):
+		type { ssa_value }, ssa_type { ssa_type_ }
+	{}
+
 	
 	EntryType type;
 	union
 	{
-		llvm::Value* value;			// eval
+		llvm::Value* value;			// eval, address
 		llvm::AllocaInst* alloca;
+		llvm::Type* ssa_type;		// ssa, 变量的类型
 	};
+	/// 变量(数组)的类型或函数的返回类型
+	TypeId type_id = TypeId::ty_sint;
+	/// 函数的参数类型
+	std::vector<TypeId> param_type_ids;
 };
 
 
+/**
+ * @brief 全局符号表
+ * @details 分为两个阶段使用:
+ *          1. 声明阶段: 通过insert填充, 内部加锁, 可以并发插入;
+ *          2. 调用freeze后转换为只读的开放寻址哈希索引, 此后find不再加锁,
+ *             多个线程可以同时查询(函数体的并行生成阶段)
+ */
 class GlobalSymbolTable final
 {
 public:
-	auto find(std::string_view name) -> std::shared_ptr<SymbolEntry>;
+	GlobalSymbolTable() = default;
+	GlobalSymbolTable(const GlobalSymbolTable&) = delete;
+	auto operator=(const GlobalSymbolTable&) -> GlobalSymbolTable& = delete;
+
+	[[nodiscard]]
+	auto find(std::string_view name) const -> std::shared_ptr<SymbolEntry>;
+
+	/**
+	 * @brief 不复制shared_ptr的查询, 避免多线程下引用计数的缓存行争用
+	 * @return 未找到返回nullptr, 指针在符号表析构前有效
+	 */
+	[[nodiscard]]
+	auto find_ptr(std::string_view name) const -> SymbolEntry*;
+
+	/**
+	 * @return 存在同名符号或符号表已冻结时返回false
+	 * @note name指向的字符串需要比符号表存活更久
+	 */
 	auto insert(std::string_view name, std::shared_ptr<SymbolEntry> entry) -> bool;
+
+	/**
+	 * @brief 结束声明阶段，构建只读哈希索引
+	 * @note 重复调用没有效果
+	 */
+	void freeze();
+
+	[[nodiscard]]
+	auto is_frozen() const -> bool
+	{ return m_frozen.load(std::memory_order_acquire); }
+
+	[[nodiscard]]
+	auto size() const -> std::size_t;
+
 private:
+	/// 冻结后索引的槽位, entry为nullptr代表空槽
+	struct Slot
+	{
+		std::size_t hash;
+		std::string_view name;
+		const std::shared_ptr<SymbolEntry>* entry;
+	};
+
+	[[nodiscard]]
+	auto find_slot(std::string_view name) const -> const Slot*;
+
+private:
+	mutable std::shared_mutex m_mutex;
 	std::unordered_map<std::string_view, std::shared_ptr<SymbolEntry>> m_table;
+
+	std::atomic<bool> m_frozen { false };
+	std::vector<Slot> m_index;
+	std::size_t m_mask { 0 };
 };
 
 
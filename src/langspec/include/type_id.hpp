@@ -0,0 +1,73 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace toycc
+{
+
+/**
+ * @brief toycc中的类型编号, 同一个TypeMgr中相同的类型编号相同
+ * @details 内建类型的编号固定(见type_id.def), 可以直接用作表的下标;
+ *          派生类型(指针, 数组)由TypeMgr按需分配
+ */
+enum class TypeId : std::uint32_t
+{
+#define BUILTIN_TYPE(id, name, kind, is_signed, bit_width) \
+	id,
+#include "type_id.def"
+	builtin_end,	// 第一个派生类型的编号
+};
+
+struct TypeInfo
+{
+	enum Kind : std::uint8_t
+	{
+		void_kind,
+		integer_kind,
+		floating_kind,
+		pointer_kind,
+		array_kind,
+		vector_kind,
+		struct_kind,
+	};
+
+	Kind kind;
+	bool is_signed;
+	/// 整数和浮点类型的宽度
+	std::uint32_t bit_width;
+	/// 指针指向的类型或数组/向量的元素类型
+	TypeId element;
+	/// 数组的元素个数或向量的通道数; 结构体为TypeMgr中结构体信息的编号
+	std::uint64_t count;
+};
+
+inline constexpr std::size_t builtin_type_count =
+	static_cast<std::size_t>(TypeId::builtin_end);
+
+/// @note long的宽度为0, 由TypeMgr依据目标平台确定
+inline constexpr std::array<TypeInfo, builtin_type_count> builtin_type_infos {{
+#define BUILTIN_TYPE(id, name, kind, is_signed, bit_width) \
+	{ TypeInfo::kind, is_signed, bit_width, TypeId::ty_void, 0 },
+#include "type_id.def"
+}};
+
+inline constexpr std::array<const char*, builtin_type_count> builtin_type_names {{
+#define BUILTIN_TYPE(id, name, kind, is_signed, bit_width) \
+	name,
+#include "type_id.def"
+}};
+
+[[nodiscard]] constexpr
+auto to_index(TypeId id) -> std::size_t
+{
+	return static_cast<std::size_t>(id);
+}
+
+[[nodiscard]] constexpr
+auto is_builtin(TypeId id) -> bool
+{
+	return id < TypeId::builtin_end;
+}
+
+}	//namespace toycc
@@ -1,15 +1,138 @@
 #pragma once
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <llvm/IR/DataLayout.h>
 #include <llvm/IR/Type.h>
 #include <llvm/IR/LLVMContext.h>
 #include <llvm/Target/TargetMachine.h>
+#include "type_id.hpp"
 
 namespace toycc
 {
 
+/// @brief 结构体的成员
+struct StructField
+{
+	std::string name;
+	TypeId type;
+	/// 在llvm::StructType中的下标, 重排后与声明顺序不同
+	unsigned index = 0;
+	/// 相对于结构体起始地址的字节偏移
+	std::uint64_t offset = 0;
+};
+
+struct StructInfo
+{
+	std::string name;
+	/// 按内存中的顺序排列
+	std::vector<StructField> fields;
+	bool packed = false;
+	/// 成员按对齐和大小重新排列以减少填充
+	bool reordered = false;
+	/// 定义结构体的成员之前是不完整类型, 只能用于指针
+	bool complete = false;
+};
+
+/**
+ * @brief 管理toycc的类型
+ * @details 类型以TypeId表示, 派生类型在首次请求时分配编号(intern),
+ *          对应的llvm::Type在首次使用时创建并缓存
+ * @note 不是线程安全的, 每个CodeGenContext拥有独立的实例
+ */
 class TypeMgr
 {
 public:
 	TypeMgr(llvm::LLVMContext& context, llvm::TargetMachine* target_machine);
+	TypeMgr(llvm::LLVMContext& context, const llvm::DataLayout& data_layout);
+	TypeMgr(const TypeMgr&) = delete;
+	auto operator=(const TypeMgr&) -> TypeMgr& = delete;
+
+	[[nodiscard]]
+	auto get_info(TypeId id) const -> const TypeInfo&;
+	[[nodiscard]]
+	auto is_integer(TypeId id) const -> bool
+	{ return get_info(id).kind == TypeInfo::integer_kind; }
+	[[nodiscard]]
+	auto is_floating(TypeId id) const -> bool
+	{ return get_info(id).kind == TypeInfo::floating_kind; }
+	[[nodiscard]]
+	auto is_pointer(TypeId id) const -> bool
+	{ return get_info(id).kind == TypeInfo::pointer_kind; }
+	[[nodiscard]]
+	auto is_array(TypeId id) const -> bool
+	{ return get_info(id).kind == TypeInfo::array_kind; }
+	[[nodiscard]]
+	auto is_vector(TypeId id) const -> bool
+	{ return get_info(id).kind == TypeInfo::vector_kind; }
+	[[nodiscard]]
+	auto is_struct(TypeId id) const -> bool
+	{ return get_info(id).kind == TypeInfo::struct_kind; }
+	/// @note 只对整数, 浮点和向量类型有意义, 向量取元素的符号
+	[[nodiscard]]
+	auto is_signed(TypeId id) const -> bool
+	{ return get_info(id).is_signed; }
+	/// @brief 用于诊断信息的类型名
+	[[nodiscard]]
+	auto get_name(TypeId id) const -> std::string;
+
+	/// @brief 指向pointee的指针类型
+	[[nodiscard]]
+	auto get_pointer(TypeId pointee) -> TypeId;
+	/// @brief 包含count个element的数组类型
+	[[nodiscard]]
+	auto get_array(TypeId element, std::uint64_t count) -> TypeId;
+	/// @brief 包含lanes个element通道的定长向量类型
+	/// @note element必须为整数类型
+	[[nodiscard]]
+	auto get_vector(TypeId element, std::uint64_t lanes) -> TypeId;
+
+	/**
+	 * @brief 创建名为name的不完整结构体类型
+	 * @details 结构体是名义类型, 每次调用得到不同的类型;
+	 *          对应的llvm::StructType在此时以不透明类型创建
+	 * @note 调用者保证name没有被定义过
+	 */
+	auto create_struct(std::string_view name) -> TypeId;
+	/// @return 未定义时返回std::nullopt
+	[[nodiscard]]
+	auto find_struct(std::string_view name) const -> std::optional<TypeId>;
+	/**
+	 * @brief 设置结构体的成员, 之后结构体成为完整类型
+	 * @details 依据DataLayout计算成员的偏移; reorder时按对齐从大到小,
+	 *          其次按大小从大到小稳定排序, 对齐相同的成员保持声明顺序,
+	 *          此时除了结尾的填充以外不存在空洞
+	 * @param fields 按声明顺序排列, 只需填写name和type, 类型必须是完整类型
+	 */
+	void set_struct_body(TypeId id, std::vector<StructField> fields,
+						 bool packed, bool reorder);
+	[[nodiscard]]
+	auto get_struct(TypeId id) const -> const StructInfo&;
+	/// @return 没有名为name的成员时返回nullptr
+	[[nodiscard]]
+	auto find_field(TypeId id, std::string_view name) const
+		-> const StructField*;
+	/// @brief 按定义顺序排列的所有结构体类型
+	[[nodiscard]]
+	auto get_struct_types() const -> const std::vector<TypeId>&
+	{ return m_struct_types; }
+	/// @brief 不完整的结构体不能定义变量或作为成员
+	[[nodiscard]]
+	auto is_complete(TypeId id) const -> bool;
+	/**
+	 * @brief 结构体布局的文本报告
+	 * @details 每个成员的偏移和大小, 成员之间的空洞, 结尾的填充
+	 *          以及占用的缓存行个数
+	 */
+	[[nodiscard]]
+	auto format_struct_layout(TypeId id) const -> std::string;
+
+	/// @brief 类型对应的llvm::Type, 首次调用时创建
+	[[nodiscard]]
+	auto get_llvm_type(TypeId id) const -> llvm::Type*;
 
 	auto get_void() const -> llvm::Type*;
 	auto get_bool() const -> llvm::Type*;
@@ -28,6 +151,10 @@ public:
 	auto get_float() const -> llvm::Type*;
 	auto get_double() const -> llvm::Type*;
 
+	[[nodiscard]]
+	auto get_data_layout() const -> const llvm::DataLayout&
+	{ return m_data_layout; }
+
 private:
 	auto gen_long_bit_width() -> int
 	{
@@ -41,27 +168,26 @@ private:
 			return 32;
 	}
 
+	/// @brief 为新的派生类型分配编号
+	auto add_type(const TypeInfo& info) -> TypeId;
+	auto create_llvm_type(const TypeInfo& info) const -> llvm::Type*;
+
 private:
 	llvm::LLVMContext& m_context;
 	llvm::DataLayout m_data_layout;
 
-	llvm::Type* m_void_ty;
-	// integer
-	llvm::Type* m_bool_ty;	//_Bool before c23
-	llvm::Type* m_schar_ty;
-	llvm::Type* m_uchar_ty;
-	llvm::Type* m_sshort_ty;
-	llvm::Type* m_ushort_ty;
-	llvm::Type* m_sint_ty;
-	llvm::Type* m_uint_ty;
-	llvm::Type* m_slong_ty;
-	llvm::Type* m_ulong_ty;
-	llvm::Type* m_slong_long_ty;
-	llvm::Type* m_ulong_long_ty;
-	// floating point
-	llvm::Type* m_float_ty;
-	llvm::Type* m_double_ty;
+	/// 以TypeId为下标, 前builtin_type_count项为内建类型
+	std::vector<TypeInfo> m_types;
+	/// 与m_types对应, 未创建时为nullptr
+	mutable std::vector<llvm::Type*> m_llvm_types;
+
+	std::unordered_map<TypeId, TypeId> m_pointer_types;
+	std::map<std::pair<TypeId, std::uint64_t>, TypeId> m_array_types;
+	std::map<std::pair<TypeId, std::uint64_t>, TypeId> m_vector_types;
+	/// 以TypeInfo::count为下标
+	std::vector<StructInfo> m_structs;
+	std::vector<TypeId> m_struct_types;
+	std::map<std::string, TypeId, std::less<>> m_struct_names;
 };
 
 }	//namespace toycc
-
@@ -1,27 +1,104 @@
 #include "symbol_table.hpp"
+#include <mutex>
 
 namespace toycc
 {
 
-auto GlobalSymbolTable::find(std::string_view name)
+auto GlobalSymbolTable::find(std::string_view name) const
 	-> std::shared_ptr<SymbolEntry>
 {
+	if (is_frozen())
+	{
+		auto slot = find_slot(name);
+		return slot == nullptr ? nullptr : *slot->entry;
+	}
+
+	std::shared_lock lock { m_mutex };
 	auto itr = m_table.find(name);
 	if (itr == m_table.end())
 		return nullptr;
 	return itr->second;
 }
 
+auto GlobalSymbolTable::find_ptr(std::string_view name) const -> SymbolEntry*
+{
+	if (is_frozen())
+	{
+		auto slot = find_slot(name);
+		return slot == nullptr ? nullptr : slot->entry->get();
+	}
+
+	std::shared_lock lock { m_mutex };
+	auto itr = m_table.find(name);
+	if (itr == m_table.end())
+		return nullptr;
+	return itr->second.get();
+}
+
 auto GlobalSymbolTable::insert(std::string_view name,
 							   std::shared_ptr<SymbolEntry> entry) -> bool
 {
+	std::unique_lock lock { m_mutex };
+	if (is_frozen())
+		return false;
+
 	auto [ _, success ] = m_table.emplace(name, entry);
 	return success;
 }
 
+void GlobalSymbolTable::freeze()
+{
+	std::unique_lock lock { m_mutex };
+	if (is_frozen())
+		return;
+
+	// 负载因子不超过0.5, 保证线性探测的平均长度很短
+	std::size_t capacity = 2;
+	while (capacity < m_table.size() * 2)
+		capacity <<= 1;
+
+	m_index.assign(capacity, Slot { 0, {}, nullptr });
+	m_mask = capacity - 1;
+
+	std::hash<std::string_view> hasher;
+	for (const auto& [name, entry] : m_table)
+	{
+		auto hash = hasher(name);
+		auto pos = hash & m_mask;
+		while (m_index[pos].entry != nullptr)
+			pos = (pos + 1) & m_mask;
+		m_index[pos] = Slot { hash, name, &entry };
+	}
+
+	m_frozen.store(true, std::memory_order_release);
+}
+
+auto GlobalSymbolTable::size() const -> std::size_t
+{
+	if (is_frozen())
+		return m_table.size();
+
+	std::shared_lock lock { m_mutex };
+	return m_table.size();
+}
+
+auto GlobalSymbolTable::find_slot(std::string_view name) const -> const Slot*
+{
+	assert(is_frozen());
+	auto hash = std::hash<std::string_view>{}(name);
+	for (auto pos = hash & m_mask; m_index[pos].entry != nullptr;
+		 pos = (pos + 1) & m_mask)
+	{
+		const auto& slot = m_index[pos];
+		if (slot.hash == hash && slot.name == name)
+			return &slot;
+	}
+	return nullptr;
+}
+
 LocalSymbolTable::LocalSymbolTable(LocalSymbolTable* upper_table):
 	m_upper { upper_table }, m_func { upper_table->m_func },
-	m_global_table { nullptr }
+	m_global_table { upper_table->m_global_table }
 {
 	assert(upper_table->m_func != nullptr);
 }
@@ -1,41 +1,296 @@
 #include "type_mgr.hpp"
 
+#include <algorithm>
+#include <cassert>
+#include <format>
+#include <functional>
+#include <llvm/IR/DerivedTypes.h>
+
 namespace toycc
 {
+
+namespace
+{
+
+/// 布局报告中按64字节的缓存行统计
+constexpr std::uint64_t cache_line_size = 64;
+
+}	//namespace
+
 TypeMgr::TypeMgr(llvm::LLVMContext& context, llvm::TargetMachine* target_machine):
-	m_context { context },
-	m_data_layout { target_machine->createDataLayout() },
-	m_void_ty { llvm::Type::getVoidTy(context) }, 
-	m_bool_ty { llvm::Type::getIntNTy(context, 8) },
-	m_schar_ty { llvm::Type::getIntNTy(context, 8) },
-	m_uchar_ty { llvm::Type::getIntNTy(context, 8) },
-	m_sshort_ty { llvm::Type::getIntNTy(context, 16) },
-	m_ushort_ty { llvm::Type::getIntNTy(context, 16) },
-	m_sint_ty { llvm::Type::getIntNTy(context, 32) },
-	m_uint_ty { llvm::Type::getIntNTy(context, 32) },
-	m_slong_ty { llvm::Type::getIntNTy(context, gen_long_bit_width()) },
-	m_ulong_ty { llvm::Type::getIntNTy(context, gen_long_bit_width()) },
-	m_slong_long_ty { llvm::Type::getIntNTy(context, 64) },
-	m_ulong_long_ty { llvm::Type::getIntNTy(context, 64) },
-	m_float_ty { llvm::Type::getFloatTy(context) },
-	m_double_ty { llvm::Type::getFloatTy(context) }
+	TypeMgr { context, target_machine->createDataLayout() }
 {}
 
+TypeMgr::TypeMgr(llvm::LLVMContext& context, const llvm::DataLayout& data_layout):
+	m_context { context },
+	m_data_layout { data_layout },
+	m_types { builtin_type_infos.begin(), builtin_type_infos.end() },
+	m_llvm_types(builtin_type_count, nullptr)
+{
+	// long的宽度与指针相同
+	auto long_bit_width = static_cast<std::uint32_t>(gen_long_bit_width());
+	m_types[to_index(TypeId::ty_slong)].bit_width = long_bit_width;
+	m_types[to_index(TypeId::ty_ulong)].bit_width = long_bit_width;
+}
+
+auto TypeMgr::get_info(TypeId id) const -> const TypeInfo&
+{
+	assert(to_index(id) < m_types.size());
+	return m_types[to_index(id)];
+}
+
+auto TypeMgr::get_name(TypeId id) const -> std::string
+{
+	if (is_builtin(id))
+		return builtin_type_names[to_index(id)];
+
+	const auto& info = get_info(id);
+	switch(info.kind)
+	{
+	case TypeInfo::pointer_kind:
+		return get_name(info.element) + "*";
+	case TypeInfo::array_kind:
+		return std::format("{}[{}]", get_name(info.element), info.count);
+	case TypeInfo::vector_kind:
+		// 与源码中的写法一致, 如int4, unsigned8
+		return std::format("{}{}", info.is_signed ? "int" : "unsigned",
+						   info.count);
+	case TypeInfo::struct_kind:
+		return "struct " + m_structs[info.count].name;
+	default:
+		assert(false && "Unkown derived type");
+		return "unkown";
+	}
+}
+
+auto TypeMgr::get_pointer(TypeId pointee) -> TypeId
+{
+	auto itr = m_pointer_types.find(pointee);
+	if (itr != m_pointer_types.end())
+		return itr->second;
+
+	auto id = add_type({ TypeInfo::pointer_kind, false,
+						 m_data_layout.getPointerSizeInBits(), pointee, 0 });
+	m_pointer_types.emplace(pointee, id);
+	return id;
+}
+
+auto TypeMgr::get_array(TypeId element, std::uint64_t count) -> TypeId
+{
+	auto key = std::make_pair(element, count);
+	auto itr = m_array_types.find(key);
+	if (itr != m_array_types.end())
+		return itr->second;
+
+	auto id = add_type({ TypeInfo::array_kind, false, 0, element, count });
+	m_array_types.emplace(key, id);
+	return id;
+}
+
+auto TypeMgr::get_vector(TypeId element, std::uint64_t lanes) -> TypeId
+{
+	assert(is_integer(element) && lanes > 0);
+	auto key = std::make_pair(element, lanes);
+	auto itr = m_vector_types.find(key);
+	if (itr != m_vector_types.end())
+		return itr->second;
+
+	const auto& element_info = get_info(element);
+	auto id = add_type({ TypeInfo::vector_kind, element_info.is_signed,
+						 0, element, lanes });
+	m_vector_types.emplace(key, id);
+	return id;
+}
+
+auto TypeMgr::create_struct(std::string_view name) -> TypeId
+{
+	assert(!m_struct_names.contains(name));
+	auto id = add_type({ TypeInfo::struct_kind, false, 0, TypeId::ty_void,
+						 m_structs.size() });
+	m_structs.emplace_back().name = name;
+	m_struct_types.push_back(id);
+	m_struct_names.emplace(name, id);
+	// 成员未知, 先创建不透明类型, 允许成员中出现指向自身的指针
+	m_llvm_types[to_index(id)] =
+		llvm::StructType::create(m_context, std::format("struct.{}", name));
+	return id;
+}
+
+auto TypeMgr::find_struct(std::string_view name) const -> std::optional<TypeId>
+{
+	auto itr = m_struct_names.find(name);
+	if (itr == m_struct_names.end())
+		return std::nullopt;
+	return itr->second;
+}
+
+void TypeMgr::set_struct_body(TypeId id, std::vector<StructField> fields,
+							  bool packed, bool reorder)
+{
+	auto& info = m_structs[get_info(id).count];
+	assert(!info.complete);
+	if (reorder)
+	{
+		auto key = [this, packed](const StructField& field) {
+			auto type = get_llvm_type(field.type);
+			// packed时所有成员按1字节对齐, 只按大小排列
+			auto align = packed ? std::uint64_t { 1 }
+								: m_data_layout.getABITypeAlign(type).value();
+			return std::make_pair(align, static_cast<std::uint64_t>(
+											 m_data_layout.getTypeAllocSize(type)));
+		};
+		std::ranges::stable_sort(fields, std::ranges::greater {}, key);
+	}
+
+	std::vector<llvm::Type*> elements;
+	elements.reserve(fields.size());
+	for (const auto& field : fields)
+	{
+		assert(is_complete(field.type));
+		elements.push_back(get_llvm_type(field.type));
+	}
+	auto struct_type = llvm::cast<llvm::StructType>(get_llvm_type(id));
+	struct_type->setBody(elements, packed);
+
+	auto layout = m_data_layout.getStructLayout(struct_type);
+	for (unsigned i = 0; auto& field : fields)
+	{
+		field.index = i;
+		field.offset = static_cast<std::uint64_t>(layout->getElementOffset(i));
+		++i;
+	}
+	info.fields = std::move(fields);
+	info.packed = packed;
+	info.reordered = reorder;
+	info.complete = true;
+}
+
+auto TypeMgr::get_struct(TypeId id) const -> const StructInfo&
+{
+	assert(is_struct(id));
+	return m_structs[get_info(id).count];
+}
+
+auto TypeMgr::find_field(TypeId id, std::string_view name) const
+	-> const StructField*
+{
+	const auto& fields = get_struct(id).fields;
+	auto itr = std::ranges::find(fields, name, &StructField::name);
+	return itr == fields.end() ? nullptr : &*itr;
+}
+
+auto TypeMgr::is_complete(TypeId id) const -> bool
+{
+	const auto& info = get_info(id);
+	switch(info.kind)
+	{
+	case TypeInfo::void_kind:
+		return false;
+	case TypeInfo::array_kind:
+		return is_complete(info.element);
+	case TypeInfo::struct_kind:
+		return m_structs[info.count].complete;
+	default:
+		return true;
+	}
+}
+
+auto TypeMgr::format_struct_layout(TypeId id) const -> std::string
+{
+	const auto& info = get_struct(id);
+	auto layout = m_data_layout.getStructLayout(
+		llvm::cast<llvm::StructType>(get_llvm_type(id)));
+	auto size = static_cast<std::uint64_t>(layout->getSizeInBytes());
+
+	auto result = std::format("struct {}: size {}, align {}", info.name, size,
+							  layout->getAlignment().value());
+	if (info.packed)
+		result += ", packed";
+	if (info.reordered)
+		result += ", reordered";
+	result += "\n";
+
+	std::uint64_t end = 0;
+	std::uint64_t holes = 0;
+	for (const auto& field : info.fields)
+	{
+		if (field.offset > end)
+		{
+			result += std::format("  {:>6} | {:>6} | <hole>\n", end,
+								  field.offset - end);
+			holes += field.offset - end;
+		}
+		auto field_size = static_cast<std::uint64_t>(
+			m_data_layout.getTypeAllocSize(get_llvm_type(field.type)));
+		result += std::format("  {:>6} | {:>6} | {} {}\n", field.offset,
+							  field_size, get_name(field.type), field.name);
+		end = field.offset + field_size;
+	}
+	auto padding = size - end;
+	if (padding != 0)
+		result += std::format("  {:>6} | {:>6} | <padding>\n", end, padding);
+	result += std::format("  holes: {} bytes, padding: {} bytes, "
+						  "cache lines: {}\n", holes, padding,
+						  (size + cache_line_size - 1) / cache_line_size);
+	return result;
+}
+
+auto TypeMgr::get_llvm_type(TypeId id) const -> llvm::Type*
+{
+	assert(to_index(id) < m_llvm_types.size());
+	auto& type = m_llvm_types[to_index(id)];
+	if (type == nullptr)
+		type = create_llvm_type(get_info(id));
+	return type;
+}
+
+auto TypeMgr::add_type(const TypeInfo& info) -> TypeId
+{
+	auto id = static_cast<TypeId>(m_types.size());
+	m_types.push_back(info);
+	m_llvm_types.push_back(nullptr);
+	return id;
+}
+
+auto TypeMgr::create_llvm_type(const TypeInfo& info) const -> llvm::Type*
+{
+	switch(info.kind)
+	{
+	case TypeInfo::void_kind:
+		return llvm::Type::getVoidTy(m_context);
+	case TypeInfo::integer_kind:
+		return llvm::Type::getIntNTy(m_context, info.bit_width);
+	case TypeInfo::floating_kind:
+		return info.bit_width == 32 ? llvm::Type::getFloatTy(m_context)
+									: llvm::Type::getDoubleTy(m_context);
+	case TypeInfo::pointer_kind:
+		return llvm::PointerType::get(m_context, 0);
+	case TypeInfo::array_kind:
+		return llvm::ArrayType::get(get_llvm_type(info.element), info.count);
+	case TypeInfo::vector_kind:
+		return llvm::FixedVectorType::get(get_llvm_type(info.element),
+										  static_cast<unsigned>(info.count));
+	default:
+		assert(false && "Unkown TypeInfo kind");
+		return nullptr;
+	}
+}
+
 #define GET_TYPE(type_name)                                                    \
 	auto TypeMgr::get_##type_name() const->llvm::Type*                         \
 	{                                                                          \
-		return m_##type_name##_ty;                                             \
+		return get_llvm_type(TypeId::ty_##type_name);                          \
 	}
 
 #define GET_SIGN_TYPE(type_name)                                               \
 	auto TypeMgr::get_signed_##type_name() const->llvm::Type*                  \
 	{                                                                          \
-		return m_s##type_name##_ty;                                            \
+		return get_llvm_type(TypeId::ty_s##type_name);                         \
 	}                                                                          \
                                                                                \
 	auto TypeMgr::get_unsigned_##type_name() const->llvm::Type*                \
 	{                                                                          \
-		return m_u##type_name##_ty;                                            \
+		return get_llvm_type(TypeId::ty_u##type_name);                         \
 	}
 
 GET_TYPE(void)
@@ -50,5 +305,7 @@ GET_SIGN_TYPE(long_long)
 GET_TYPE(float)
 GET_TYPE(double)
 
-}	//namespace toycc
+#undef GET_TYPE
+#undef GET_SIGN_TYPE
 
+}	//namespace toycc
@@ -0,0 +1,92 @@
+#ifndef TOYCC_H
+#define TOYCC_H
+
+/**
+ * @file toycc.h
+ * @brief libtoycc的C接口, 语义与toycc.hpp中的toycc::compile相同
+ * @note 结果对象由toycc_compile创建, 需要通过toycc_result_free释放,
+ *       结果中返回的指针在释放前一直有效
+ */
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum toycc_output_kind
+{
+	TOYCC_OUTPUT_LLVM_IR,
+	TOYCC_OUTPUT_LLVM_BC,
+	TOYCC_OUTPUT_ASSEMBLY,
+	TOYCC_OUTPUT_OBJECT,
+} toycc_output_kind;
+
+typedef enum toycc_diag_kind
+{
+	TOYCC_DIAG_ERROR,
+	TOYCC_DIAG_WARNING,
+	TOYCC_DIAG_REMARK,
+	TOYCC_DIAG_NOTE,
+} toycc_diag_kind;
+
+typedef struct toycc_options
+{
+	toycc_output_kind output;
+	/* 为NULL或空字符串时使用默认值 */
+	const char* triple;
+	const char* cpu;
+	const char* features;
+	int position_independent;
+	unsigned opt_level;
+	unsigned codegen_threads;
+	unsigned codegen_job_size;
+	int direct_ssa;
+	int dump_struct_layout;
+	unsigned eval_step_limit;
+	unsigned eval_depth_limit;
+	int trace;
+	int verbose;
+} toycc_options;
+
+typedef struct toycc_result toycc_result;
+
+/** @brief 将options设置为默认值 */
+void toycc_options_init(toycc_options* options);
+
+/**
+ * @brief 编译size字节的源代码
+ * @param options 为NULL时使用默认值
+ * @return 总是返回非NULL的结果对象
+ */
+toycc_result* toycc_compile(const char* source, size_t size,
+							const char* source_name,
+							const toycc_options* options);
+
+int toycc_result_success(const toycc_result* result);
+
+/** @return 编译产物, 长度写入size */
+const char* toycc_result_output(const toycc_result* result, size_t* size);
+
+/** @return 结构体布局报告, 长度写入size; 未设置dump_struct_layout时为空 */
+const char* toycc_result_struct_layout(const toycc_result* result,
+									   size_t* size);
+
+size_t toycc_result_diag_count(const toycc_result* result);
+toycc_diag_kind toycc_result_diag_kind(const toycc_result* result,
+									   size_t index);
+const char* toycc_result_diag_file(const toycc_result* result, size_t index);
+unsigned toycc_result_diag_line(const toycc_result* result, size_t index);
+unsigned toycc_result_diag_column(const toycc_result* result, size_t index);
+const char* toycc_result_diag_message(const toycc_result* result,
+									  size_t index);
+const char* toycc_result_diag_rendered(const toycc_result* result,
+									   size_t index);
+
+void toycc_result_free(toycc_result* result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TOYCC_H */
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @file toycc.hpp
+ * @brief libtoycc的C++接口, 从内存中的源代码编译到内存中的输出
+ * @note 接口中不出现LLVM与spdlog的类型, 每次调用互不影响, 可在多个线程中同时调用
+ */
+
+namespace toycc
+{
+
+/// @brief 编译产物的格式
+enum class OutputKind
+{
+	llvm_ir,	///< 文本形式的LLVM IR
+	llvm_bc,	///< LLVM bitcode
+	assembly,	///< 目标平台汇编
+	object,		///< 目标平台可重定位目标文件
+};
+
+struct CompileOptions
+{
+	OutputKind output = OutputKind::object;
+	/// 目标三元组, 为空时使用主机三元组
+	std::string triple;
+	/// 目标CPU, 为空时使用通用CPU
+	std::string cpu;
+	/// 目标特性字符串, 如 "+sse2,+avx"
+	std::string features;
+	/// 是否生成位置无关代码, 否则使用目标平台默认的重定位模型
+	bool position_independent = false;
+	/// 优化级别
+	unsigned opt_level = 0;
+	/// 并行生成函数体的线程个数, 0代表在调用线程中生成
+	unsigned codegen_threads = 0;
+	/// 并行生成时每个任务包含的函数个数, 输出与线程个数无关
+	unsigned codegen_job_size = 32;
+	/// 局部标量变量直接生成SSA形式, 不经过alloca/load/store
+	bool direct_ssa = false;
+	/// 在CompileResult::struct_layout中输出所有结构体的布局
+	bool dump_struct_layout = false;
+	/// 编译期求值eval函数时执行的语句数上限
+	unsigned eval_step_limit = 1048576;
+	/// 编译期求值eval函数时的调用深度上限
+	unsigned eval_depth_limit = 512;
+	/// 输出词法, 语法分析的追踪信息到标准错误
+	bool trace = false;
+	/// 输出编译器内部日志到标准错误
+	bool verbose = false;
+};
+
+struct Diagnostic
+{
+	enum Kind
+	{
+		error,
+		warning,
+		remark,
+		note,
+	};
+
+	Kind kind;
+	/// 源代码名称, 与编译时传入的名称相同
+	std::string file;
+	/// 从1开始的行号, 0代表没有位置信息
+	unsigned line;
+	/// 从1开始的列号, 0代表没有位置信息
+	unsigned column;
+	std::string message;
+	/// 与命令行输出格式相同的完整诊断信息, 包括源代码行和位置标记
+	std::string rendered;
+};
+
+struct CompileResult
+{
+	bool success;
+	/// 编译产物, 格式由CompileOptions::output决定, 失败时为空
+	std::string output;
+	std::vector<Diagnostic> diagnostics;
+	/// 结构体的成员偏移, 空洞, 填充和缓存行占用, 见CompileOptions::dump_struct_layout
+	std::string struct_layout;
+};
+
+/**
+ * @brief 编译一段源代码
+ * @param source 源代码
+ * @param source_name 诊断信息中使用的文件名
+ */
+[[nodiscard]]
+auto compile(std::string_view source, std::string_view source_name,
+			 const CompileOptions& options) -> CompileResult;
+
+}	//namespace toycc
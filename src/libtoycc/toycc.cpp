@@ -0,0 +1,348 @@
+#include "toycc.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <expected>
+#include <format>
+#include <mutex>
+
+#include <llvm/ADT/SmallVector.h>
+#include <llvm/IR/DiagnosticInfo.h>
+#include <llvm/IR/DiagnosticPrinter.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/MC/TargetRegistry.h>
+#include <llvm/Support/CodeGen.h>
+#include <llvm/Support/SourceMgr.h>
+#include <llvm/Support/TargetSelect.h>
+#include <llvm/Support/raw_ostream.h>
+#include <llvm/Target/TargetMachine.h>
+#include <llvm/Target/TargetOptions.h>
+#include <llvm/TargetParser/Host.h>
+#include <llvm/TargetParser/Triple.h>
+#include <spdlog/async.h>
+#include <spdlog/sinks/null_sink.h>
+#include <spdlog/sinks/stdout_color_sinks.h>
+
+#include "codegen_context.hpp"
+#include "conversion.hpp"
+#include "driver.hpp"
+#include "emit_target.hpp"
+#include "parallel_codegen.hpp"
+
+namespace toycc
+{
+
+namespace
+{
+
+/**
+ * @brief 初始化LLVM目标组件和日志线程池
+ * @note 只在第一次调用时执行, 线程池由库持有, 不使用spdlog的全局注册表
+ */
+auto initialize() -> std::shared_ptr<spdlog::details::thread_pool>
+{
+	static std::once_flag once;
+	static std::shared_ptr<spdlog::details::thread_pool> pool;
+
+	std::call_once(once, [] {
+		llvm::InitializeAllTargetInfos();
+		llvm::InitializeAllTargets();
+		llvm::InitializeAllTargetMCs();
+		llvm::InitializeAllAsmPrinters();
+		llvm::InitializeAllAsmParsers();
+		pool = std::make_shared<spdlog::details::thread_pool>(8192, 1);
+	});
+
+	return pool;
+}
+
+/// @brief 每次编译独立的logger, 不注册到spdlog
+auto create_logger(std::string name, const CompileOptions& options,
+				   std::shared_ptr<spdlog::details::thread_pool> pool)
+	-> std::shared_ptr<spdlog::async_logger>
+{
+	spdlog::sink_ptr sink;
+	if (options.verbose)
+		sink = std::make_shared<spdlog::sinks::stderr_color_sink_mt>();
+	else
+		sink = std::make_shared<spdlog::sinks::null_sink_mt>();
+
+	auto logger = std::make_shared<spdlog::async_logger>(
+		std::move(name), sink, pool, spdlog::async_overflow_policy::block);
+	if (!options.verbose)
+		logger->set_level(spdlog::level::off);
+
+	return logger;
+}
+
+constexpr
+auto cvt_diag_kind(llvm::SourceMgr::DiagKind kind) -> Diagnostic::Kind
+{
+	switch(kind)
+	{
+	case llvm::SourceMgr::DK_Error:
+		return Diagnostic::error;
+	case llvm::SourceMgr::DK_Warning:
+		return Diagnostic::warning;
+	case llvm::SourceMgr::DK_Remark:
+		return Diagnostic::remark;
+	case llvm::SourceMgr::DK_Note:
+		return Diagnostic::note;
+	default:
+		assert(false && "unkown DiagKind");
+	}
+}
+
+constexpr
+auto cvt_output_kind(OutputKind kind) -> EmitTarget::TargetType
+{
+	switch(kind)
+	{
+	case OutputKind::llvm_ir:
+		return EmitTarget::llvm_ir;
+	case OutputKind::llvm_bc:
+		return EmitTarget::llvm_bin;
+	case OutputKind::assembly:
+		return EmitTarget::assembly;
+	case OutputKind::object:
+		return EmitTarget::object;
+	default:
+		return EmitTarget::unkown;
+	}
+}
+
+constexpr
+auto cvt_opt_level(unsigned opt_level) -> llvm::CodeGenOptLevel
+{
+	switch(opt_level)
+	{
+	case 0:
+		return llvm::CodeGenOptLevel::None;
+	case 1:
+		return llvm::CodeGenOptLevel::Less;
+	case 2:
+		return llvm::CodeGenOptLevel::Default;
+	default:
+		return llvm::CodeGenOptLevel::Aggressive;
+	}
+}
+
+/// @brief SourceMgr的诊断回调, ctx为CompileResult::diagnostics
+void collect_diagnostic(const llvm::SMDiagnostic& diag, void* ctx)
+{
+	auto& diagnostics = *static_cast<std::vector<Diagnostic>*>(ctx);
+
+	std::string rendered;
+	llvm::raw_string_ostream os { rendered };
+	diag.print(nullptr, os, false);
+
+	diagnostics.push_back(Diagnostic {
+		.kind = cvt_diag_kind(diag.getKind()),
+		.file = diag.getFilename().str(),
+		.line = diag.getLineNo() > 0 ? static_cast<unsigned>(diag.getLineNo())
+									 : 0,
+		.column = diag.getColumnNo() >= 0
+					  ? static_cast<unsigned>(diag.getColumnNo()) + 1
+					  : 0,
+		.message = diag.getMessage().str(),
+		.rendered = std::move(rendered),
+	});
+}
+
+/// @brief 没有源代码位置的诊断信息
+auto make_diagnostic(Diagnostic::Kind kind, std::string_view file,
+					 std::string message) -> Diagnostic
+{
+	constexpr std::array kind_names { "error", "warning", "remark", "note" };
+	auto rendered = std::format("{}: {}: {}\n", file, kind_names[kind],
+								message);
+	return Diagnostic {
+		.kind = kind,
+		.file = std::string { file },
+		.line = 0,
+		.column = 0,
+		.message = std::move(message),
+		.rendered = std::move(rendered),
+	};
+}
+
+auto make_error(std::string_view file, std::string message) -> Diagnostic
+{
+	return make_diagnostic(Diagnostic::error, file, std::move(message));
+}
+
+/// @brief collect_llvm_diagnostic的上下文
+struct LLVMDiagContext
+{
+	std::vector<Diagnostic>& diagnostics;
+	std::string_view file;
+};
+
+/**
+ * @brief LLVMContext的诊断回调, ctx为LLVMDiagContext
+ * @details 优化器无法执行循环提示要求的变换时产生警告, 没有调试信息,
+ *          使用函数名代替源代码位置; 不收集remark和note
+ */
+void collect_llvm_diagnostic(const llvm::DiagnosticInfo& info, void* ctx)
+{
+	auto& diag_ctx = *static_cast<LLVMDiagContext*>(ctx);
+	Diagnostic::Kind kind;
+	switch(info.getSeverity())
+	{
+	case llvm::DS_Error:
+		kind = Diagnostic::error;
+		break;
+	case llvm::DS_Warning:
+		kind = Diagnostic::warning;
+		break;
+	default:
+		return;
+	}
+
+	std::string message;
+	llvm::raw_string_ostream os { message };
+	if (auto opt_info =
+			llvm::dyn_cast<llvm::DiagnosticInfoOptimizationBase>(&info))
+	{
+		os << "In function '" << opt_info->getFunction().getName()
+		   << "': " << opt_info->getMsg();
+	}
+	else
+	{
+		llvm::DiagnosticPrinterRawOStream printer { os };
+		info.print(printer);
+	}
+	diag_ctx.diagnostics.push_back(
+		make_diagnostic(kind, diag_ctx.file, std::move(message)));
+}
+
+auto create_target_machine(const CompileOptions& options)
+	-> std::expected<std::shared_ptr<llvm::TargetMachine>, std::string>
+{
+	//三元组包括: 架构, 供应商, 操作系统环境
+	auto triple = llvm::Triple { options.triple.empty()
+									 ? llvm::sys::getDefaultTargetTriple()
+									 : options.triple };
+
+	std::string error_str;
+	auto target = llvm::TargetRegistry::lookupTarget(triple.getTriple(),
+													 error_str);
+	if (!target)
+		return std::unexpected { error_str };
+
+	std::optional<llvm::Reloc::Model> reloc_model;
+	if (options.position_independent)
+		reloc_model = llvm::Reloc::PIC_;
+
+	auto tm = target->createTargetMachine(
+		triple.getTriple(), options.cpu, options.features,
+		llvm::TargetOptions {}, reloc_model, std::nullopt,
+		cvt_opt_level(options.opt_level));
+	if (tm == nullptr)
+	{
+		return std::unexpected { std::format(
+			"Failed to create target machine for {}", triple.getTriple()) };
+	}
+
+	return std::shared_ptr<llvm::TargetMachine> { tm };
+}
+
+auto has_error(const std::vector<Diagnostic>& diagnostics) -> bool
+{
+	return std::ranges::any_of(diagnostics, [](const Diagnostic& diag) {
+		return diag.kind == Diagnostic::error;
+	});
+}
+
+}	//namespace
+
+auto compile(std::string_view source, std::string_view source_name,
+			 const CompileOptions& options) -> CompileResult
+{
+	CompileResult result { false, {}, {}, {} };
+
+	auto pool = initialize();
+	auto front_logger = create_logger("front", options, pool);
+	auto backend_logger = create_logger("backend", options, pool);
+
+	auto tm_or_error = create_target_machine(options);
+	if (!tm_or_error)
+	{
+		result.diagnostics.push_back(
+			make_error(source_name, std::move(tm_or_error.error())));
+		return result;
+	}
+	auto tm = std::move(*tm_or_error);
+
+	// 本次编译的源码管理, 诊断信息只收集到result中
+	llvm::SourceMgr src_mgr;
+	src_mgr.setDiagHandler(collect_diagnostic, &result.diagnostics);
+
+	// 词法，语法分析
+	DriverFactory driver_factory { src_mgr, front_logger };
+	auto driver = driver_factory.produce_driver(source, source_name);
+	driver->set_trace(options.trace);
+	if (!driver->parse())
+	{
+		if (!has_error(result.diagnostics))
+			result.diagnostics.push_back(make_error(source_name, "Parse failed"));
+		return result;
+	}
+	auto ast = driver->get_ast_unique();
+
+	// 语义分析，中间代码生成
+	auto cg_context = std::make_shared<CodeGenContext>(
+		std::make_shared<ConversionConfig>(), src_mgr, tm, backend_logger);
+	CodeGenOptions cg_options {
+		.threads = options.codegen_threads,
+		.funcs_per_job = options.codegen_job_size,
+		.direct_ssa = options.direct_ssa,
+		.eval_step_limit = options.eval_step_limit,
+		.eval_depth_limit = options.eval_depth_limit,
+	};
+	ParallelCodeGen codegen { cg_context, cg_options };
+	auto module = codegen(*ast);
+	if (module == nullptr)
+	{
+		if (!has_error(result.diagnostics))
+		{
+			result.diagnostics.push_back(
+				make_error(source_name, "Code generation failed"));
+		}
+		return result;
+	}
+	if (options.dump_struct_layout)
+	{
+		const auto& type_mgr = cg_context->get_type_mgr();
+		for (auto type : type_mgr.get_struct_types())
+		{
+			if (type_mgr.is_complete(type))
+				result.struct_layout += type_mgr.format_struct_layout(type);
+		}
+	}
+
+	// 生成目标 (llvm-ir, bitcode, 汇编或二进制)
+	LLVMDiagContext llvm_diag_ctx { result.diagnostics, source_name };
+	module->getContext().setDiagnosticHandlerCallBack(collect_llvm_diagnostic,
+													  &llvm_diag_ctx);
+	EmitTarget emit { source_name, tm, false,
+					  std::to_string(options.opt_level), backend_logger };
+	emit.set_target_type(cvt_output_kind(options.output));
+
+	llvm::SmallVector<char, 0> buffer;
+	llvm::raw_svector_ostream os { buffer };
+	auto void_or_error = emit.emit(std::move(module), os);
+	if (!void_or_error)
+	{
+		result.diagnostics.push_back(
+			make_error(source_name, std::move(void_or_error.error())));
+		return result;
+	}
+
+	result.output.assign(buffer.begin(), buffer.end());
+	result.success = true;
+	return result;
+}
+
+}	//namespace toycc
@@ -0,0 +1,159 @@
+#include "toycc.h"
+#include "toycc.hpp"
+
+/// C接口的结果对象, 持有C++接口的结果
+struct toycc_result
+{
+	toycc::CompileResult result;
+};
+
+namespace
+{
+
+auto cvt_output_kind(toycc_output_kind kind) -> toycc::OutputKind
+{
+	switch(kind)
+	{
+	case TOYCC_OUTPUT_LLVM_IR:
+		return toycc::OutputKind::llvm_ir;
+	case TOYCC_OUTPUT_LLVM_BC:
+		return toycc::OutputKind::llvm_bc;
+	case TOYCC_OUTPUT_ASSEMBLY:
+		return toycc::OutputKind::assembly;
+	case TOYCC_OUTPUT_OBJECT:
+	default:
+		return toycc::OutputKind::object;
+	}
+}
+
+auto cvt_options(const toycc_options& options) -> toycc::CompileOptions
+{
+	auto to_string = [](const char* str) {
+		return str == nullptr ? std::string {} : std::string { str };
+	};
+
+	return toycc::CompileOptions {
+		.output = cvt_output_kind(options.output),
+		.triple = to_string(options.triple),
+		.cpu = to_string(options.cpu),
+		.features = to_string(options.features),
+		.position_independent = options.position_independent != 0,
+		.opt_level = options.opt_level,
+		.codegen_threads = options.codegen_threads,
+		.codegen_job_size = options.codegen_job_size,
+		.direct_ssa = options.direct_ssa != 0,
+		.dump_struct_layout = options.dump_struct_layout != 0,
+		.eval_step_limit = options.eval_step_limit,
+		.eval_depth_limit = options.eval_depth_limit,
+		.trace = options.trace != 0,
+		.verbose = options.verbose != 0,
+	};
+}
+
+}	//namespace
+
+extern "C" {
+
+void toycc_options_init(toycc_options* options)
+{
+	*options = toycc_options {
+		.output = TOYCC_OUTPUT_OBJECT,
+		.triple = nullptr,
+		.cpu = nullptr,
+		.features = nullptr,
+		.position_independent = 0,
+		.opt_level = 0,
+		.codegen_threads = 0,
+		.codegen_job_size = 32,
+		.direct_ssa = 0,
+		.dump_struct_layout = 0,
+		.eval_step_limit = 1048576,
+		.eval_depth_limit = 512,
+		.trace = 0,
+		.verbose = 0,
+	};
+}
+
+toycc_result* toycc_compile(const char* source, size_t size,
+							const char* source_name,
+							const toycc_options* options)
+{
+	toycc_options default_options;
+	if (options == nullptr)
+	{
+		toycc_options_init(&default_options);
+		options = &default_options;
+	}
+
+	auto result = new toycc_result {};
+	result->result = toycc::compile(
+		std::string_view { source, size },
+		source_name == nullptr ? "<source>" : source_name,
+		cvt_options(*options));
+	return result;
+}
+
+int toycc_result_success(const toycc_result* result)
+{
+	return result->result.success ? 1 : 0;
+}
+
+const char* toycc_result_output(const toycc_result* result, size_t* size)
+{
+	if (size != nullptr)
+		*size = result->result.output.size();
+	return result->result.output.data();
+}
+
+const char* toycc_result_struct_layout(const toycc_result* result,
+									   size_t* size)
+{
+	if (size != nullptr)
+		*size = result->result.struct_layout.size();
+	return result->result.struct_layout.c_str();
+}
+
+size_t toycc_result_diag_count(const toycc_result* result)
+{
+	return result->result.diagnostics.size();
+}
+
+toycc_diag_kind toycc_result_diag_kind(const toycc_result* result,
+									   size_t index)
+{
+	return static_cast<toycc_diag_kind>(result->result.diagnostics[index].kind);
+}
+
+const char* toycc_result_diag_file(const toycc_result* result, size_t index)
+{
+	return result->result.diagnostics[index].file.c_str();
+}
+
+unsigned toycc_result_diag_line(const toycc_result* result, size_t index)
+{
+	return result->result.diagnostics[index].line;
+}
+
+unsigned toycc_result_diag_column(const toycc_result* result, size_t index)
+{
+	return result->result.diagnostics[index].column;
+}
+
+const char* toycc_result_diag_message(const toycc_result* result,
+									  size_t index)
+{
+	return result->result.diagnostics[index].message.c_str();
+}
+
+const char* toycc_result_diag_rendered(const toycc_result* result,
+									   size_t index)
+{
+	return result->result.diagnostics[index].rendered.c_str();
+}
+
+void toycc_result_free(toycc_result* result)
+{
+	delete result;
+}
+
+}	//extern "C"
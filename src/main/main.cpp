@@ -1,21 +1,15 @@
 #include <llvm/CodeGen/CommandFlags.h>
-#include <llvm/MC/TargetRegistry.h>
 #include <llvm/Support/CommandLine.h>
+#include <llvm/Support/FileSystem.h>
 #include <llvm/Support/InitLLVM.h>
-#include <llvm/Support/TargetSelect.h>
-#include <llvm/Target/TargetMachine.h>
-#include <llvm/TargetParser/Host.h>
-#include <llvm/TargetParser/Triple.h>
-#include <spdlog/sinks/stdout_color_sinks.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/raw_ostream.h>
 
-#include "driver.hpp"
-#include "codegen_visitor.hpp"
-#include "emit_target.hpp"
-#include "codegen_context.hpp"
-#include "conversion.hpp"
+#include "toycc.hpp"
 
 
-//帮助codegen 生成target_options
+//注册-mcpu, -mattr, -filetype, -relocation-model等codegen选项
 static llvm::codegen::RegisterCodeGenFlags CGF;
 
 /// 定义命令行选项
@@ -64,153 +58,163 @@ static llvm::cl::opt<std::string> optimization {
 	llvm::cl::init("0")
 };
 
-auto create_target_machine() -> std::shared_ptr<llvm::TargetMachine>
-{
-	//三元组包括: 架构, 供应商, 操作系统环境
-	auto triple = llvm::Triple {
-		llvm::sys::getDefaultTargetTriple()
-	};
+/// 并行生成函数体的线程个数
+static llvm::cl::opt<unsigned> codegen_threads {
+	"cg-threads",
+	llvm::cl::desc("Number of threads lowering function bodies "
+				   "(0 lowers into a single module on the main thread)"),
+	llvm::cl::init(0)
+};
 
-	//初始化目标选项, 优化代码选项
-	auto target_options =
-		llvm::codegen::InitTargetOptionsFromCodeGenFlags(triple);
+/// 并行生成时每个任务包含的函数个数
+static llvm::cl::opt<unsigned> codegen_job_size {
+	"cg-job-size",
+	llvm::cl::desc("Number of functions per parallel codegen job"),
+	llvm::cl::init(32)
+};
 
-	//获取用户指定的CPU和特性字符串 (sse2, avx)
-	auto cpu_str = llvm::codegen::getCPUStr();
-	auto feature_str = llvm::codegen::getFeaturesStr();
+/// 直接生成SSA形式的局部变量
+static llvm::cl::opt<bool> direct_ssa {
+	"direct-ssa",
+	llvm::cl::desc("Build SSA form for local scalars directly "
+				   "instead of using alloca/load/store"),
+	llvm::cl::init(false)
+};
 
-	std::string error_str;
-	//查找目标架构如`x86_64`
-	auto target = llvm::TargetRegistry::lookupTarget(llvm::codegen::getMArch(), triple, error_str);
-	if (!target)
-	{
-		spdlog::error("{}", error_str);
-		return nullptr;
-	}
-	
-	// 创建目标机器
-	// getTriple 返回三元组字符串表示
-	// 指定目标的重定位模型：静态，动态(位置无关)
-	auto tm_rowptr = target->createTargetMachine(
-		triple.getTriple(), cpu_str, feature_str, target_options,
-		std::optional<llvm::Reloc::Model>{llvm::codegen::getRelocModel()});
-	auto tm = std::shared_ptr<llvm::TargetMachine> (tm_rowptr);
-
-	return tm;
-}
+/// 输出结构体布局
+static llvm::cl::opt<bool> dump_struct_layout {
+	"fdump-struct-layout",
+	llvm::cl::desc("Print the layout of every structure "
+				   "(offsets, holes, padding and cache lines) to stderr"),
+	llvm::cl::init(false)
+};
 
-/**
- * @brief 词法分析，语法分析
- * @ret 错误返回nullptr
- */
-auto frontend_procedure(llvm::SourceMgr& src_mgr, std::string_view file, auto& global_sink)
-	-> std::unique_ptr<toycc::CompUnit>
-{
-	// 初始化编译器前端logger
-	auto front_logger = std::make_shared<spdlog::async_logger>("front", global_sink,
-		spdlog::thread_pool(), spdlog::async_overflow_policy::block);
-	spdlog::register_logger(front_logger);
+/// eval函数编译期求值的上限
+static llvm::cl::opt<unsigned> eval_step_limit {
+	"feval-steps",
+	llvm::cl::desc("Maximum number of statements executed when evaluating "
+				   "an eval function at compile time"),
+	llvm::cl::init(1048576)
+};
+
+static llvm::cl::opt<unsigned> eval_depth_limit {
+	"feval-depth",
+	llvm::cl::desc("Maximum nesting depth of eval function calls "
+				   "evaluated at compile time"),
+	llvm::cl::init(512)
+};
 
-	toycc::DriverFactory driver_factory { src_mgr, front_logger };
+/// 输出编译器内部日志
+static llvm::cl::opt<bool> verbose {
+	"verbose",
+	llvm::cl::desc("Print compiler internal logs to stderr"),
+	llvm::cl::init(false)
+};
 
-	auto driver_or_error = driver_factory.produce_driver(file);
-	if (!driver_or_error)
+/// @brief 由命令行参数决定输出格式
+auto get_output_kind() -> toycc::OutputKind
+{
+	switch(llvm::codegen::getFileType())
 	{
-		front_logger->error("{}", driver_or_error.error());
-		return nullptr;
+	case llvm::CodeGenFileType::AssemblyFile:
+		return emit_llvm ? toycc::OutputKind::llvm_ir
+						 : toycc::OutputKind::assembly;
+	case llvm::CodeGenFileType::ObjectFile:
+		return emit_llvm ? toycc::OutputKind::llvm_bc
+						 : toycc::OutputKind::object;
+	default:
+		return emit_llvm ? toycc::OutputKind::llvm_ir
+						 : toycc::OutputKind::object;
 	}
-
-	auto driver = std::move(*driver_or_error);
-	driver->set_trace(trace_debug);
-
-	if (!driver->parse())
-		return nullptr;
-
-	return driver->get_ast_unique();
 }
 
-/**
- * @brief 语义分析，中间代码生成
- */
-auto backend_procedure(std::shared_ptr<toycc::CodeGenContext> cgc, auto ast)
-	-> std::unique_ptr<llvm::Module>
+/// @brief 未指定-o时, 使用去掉目录和后缀的输入文件名加上对应后缀
+auto get_output_name(toycc::OutputKind kind) -> std::string
 {
-	toycc::CodeGenVisitor visitor{cgc};
+	if (!output_file.empty())
+		return output_file.getValue();
 
-	auto success = visitor.visit(ast.get());
-	if (!success)
+	std::string result = llvm::sys::path::stem(input_file.getValue()).str();
+	switch(kind)
 	{
-		llvm::errs() << "Error happens, terminate compile\n";
-		return nullptr;
+	case toycc::OutputKind::llvm_ir:
+		return result + ".ll";
+	case toycc::OutputKind::llvm_bc:
+		return result + ".bc";
+	case toycc::OutputKind::assembly:
+		return result + ".s";
+	case toycc::OutputKind::object:
+		return result + ".o";
 	}
-
-	return visitor.get_result();
+	return result;
 }
 
 auto main(int argc, char* argv[]) -> int
 {
-	// 初始化LLVM的目标支持组件
 	llvm::InitLLVM X(argc, argv);
-	llvm::InitializeAllTargets();
-	llvm::InitializeAllTargetMCs();
-	llvm::InitializeAllAsmPrinters();
-	llvm::InitializeAllAsmParsers();
-	// 初始化spdlog
-	spdlog::init_thread_pool(8192, 1);
-	// 全局日志输出目标，为标注彩色输出(包括错误输出)
-	auto global_sink = std::make_shared<spdlog::sinks::stdout_color_sink_st>();
 
 	// 解析命令行选项
 	llvm::cl::ParseCommandLineOptions(argc, argv,
 									  "Simple LLVM CommandLine Example\n");
-	auto tm = create_target_machine();
-	if (tm == nullptr)
-		return 1;
 
-	// 全局的源码管理
-	llvm::SourceMgr src_mgr;
-
-	// 后端日志记录，包含主函数的日志输出
-	auto backend_logger = std::make_shared<spdlog::async_logger>("backend", global_sink,
-			spdlog::thread_pool(), spdlog::async_overflow_policy::block);
-	spdlog::register_logger(backend_logger);
-
-	std::shared_ptr<toycc::ConversionConfig> cvt_config =
-		std::make_shared<toycc::ConversionConfig>();
-
-	auto cg_context = std::make_shared<toycc::CodeGenContext>(
-		cvt_config, src_mgr, tm, backend_logger);
-
-	// 词法，语法分析
-	auto ast = frontend_procedure(src_mgr, input_file.getValue(), global_sink);
-	if (ast == nullptr)
+	unsigned opt_level = 0;
+	if (llvm::StringRef { optimization.getValue() }.getAsInteger(10, opt_level))
 	{
-		backend_logger->info("frontend procedure detected user error");
+		llvm::errs() << "Invalid optimization level -O"
+					 << optimization.getValue() << "\n";
 		return 1;
 	}
 
-	// 语义分析，中间代码生成
-	auto module = backend_procedure(cg_context, std::move(ast));
-	if (module == nullptr)
+	auto buffer_or_error = llvm::MemoryBuffer::getFile(input_file.getValue());
+	if (!buffer_or_error)
 	{
-		backend_logger->info("backend procedure detected user error");
+		llvm::errs() << "Failed to open " << input_file.getValue() << ": "
+					 << buffer_or_error.getError().message() << "\n";
 		return 1;
 	}
 
-	//生成目标文件 (llvm-ir, 汇编或二进制.o)
-	toycc::EmitTarget emit{input_file.getValue(), tm, emit_llvm.getValue(),
-						   optimization.getValue(), backend_logger};
+	toycc::CompileOptions options {
+		.output = get_output_kind(),
+		.triple = mtriple.getValue(),
+		.cpu = llvm::codegen::getCPUStr(),
+		.features = llvm::codegen::getFeaturesStr(),
+		.position_independent =
+			llvm::codegen::getExplicitRelocModel() == llvm::Reloc::PIC_,
+		.opt_level = opt_level,
+		.codegen_threads = codegen_threads.getValue(),
+		.codegen_job_size = codegen_job_size.getValue(),
+		.direct_ssa = direct_ssa.getValue(),
+		.dump_struct_layout = dump_struct_layout.getValue(),
+		.eval_step_limit = eval_step_limit.getValue(),
+		.eval_depth_limit = eval_depth_limit.getValue(),
+		.trace = trace_debug.getValue(),
+		.verbose = verbose.getValue(),
+	};
 
-	if (!output_file.empty())
-		emit.set_target_name(output_file.getValue());
+	auto result = toycc::compile((*buffer_or_error)->getBuffer(),
+								 input_file.getValue(), options);
+	for (const auto& diag : result.diagnostics)
+		llvm::errs() << diag.rendered;
 
-	auto void_or_error = emit(std::move(module));
-	if (!void_or_error)
+	if (!result.success)
 	{
-		backend_logger->error("{}", void_or_error.error());
+		llvm::errs() << "Error happens, terminate compile\n";
 		return 1;
 	}
+	// 与诊断信息一起输出, 不混入"-o -"写到标准输出的编译产物
+	llvm::errs() << result.struct_layout;
+
+	//生成目标文件 (llvm-ir, 汇编或二进制.o)
+	auto output_name = get_output_name(options.output);
+	std::error_code ec;
+	llvm::raw_fd_ostream os { output_name, ec, llvm::sys::fs::OF_None };
+	if (ec)
+	{
+		llvm::errs() << "Could not open file " << output_name << ": "
+					 << ec.message() << "\n";
+		return 1;
+	}
+	os << result.output;
 
 	return 0;
 }
-
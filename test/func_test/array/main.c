@@ -0,0 +1,45 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+extern int hist[16];
+extern unsigned int seed;
+extern int grid[4][5];
+
+int fill_hist(int n);
+int matrix(int n);
+int count_primes(int n);
+int sorted_digits(void);
+
+int main([[maybe_unused]] int argc, char* argv[])
+{
+#define CHECK_RESULT(prog, ret, expected)                                      \
+	if ((ret) != (expected))                                                   \
+	{                                                                          \
+		printf("%s: array error. %s = %d, expected = %d\n", prog, #ret,        \
+			   (ret), (expected));                                             \
+		exit(1);                                                               \
+	}
+
+	CHECK_RESULT(argv[0], (int)seed, 12345);
+	CHECK_RESULT(argv[0], fill_hist(1000), 1000);
+	// 与同一线性同余生成器的结果比较
+	int expected[16] = { 0 };
+	unsigned int s = 12345;
+	for (int i = 0; i < 1000; ++i)
+	{
+		s = s * 1103515245u + 12345u;
+		++expected[s / 65536 % 32768 % 16];
+	}
+	for (int i = 0; i < 16; ++i)
+		CHECK_RESULT(argv[0], hist[i], expected[i]);
+
+	CHECK_RESULT(argv[0], matrix(3), 178);
+	CHECK_RESULT(argv[0], grid[3][3], 24);
+	CHECK_RESULT(argv[0], grid[2][4], 20);
+	CHECK_RESULT(argv[0], count_primes(100), 25);
+	CHECK_RESULT(argv[0], count_primes(2), 0);
+	CHECK_RESULT(argv[0], sorted_digits(), 59);
+
+	printf("%s: success\n", argv[0]);
+	return 0;
+}
@@ -0,0 +1,94 @@
+int hist[16];
+unsigned int seed = 12345;
+int grid[4][5] __attribute__((aligned(32)));
+
+unsigned int next_rand()
+{
+	seed = seed * 1103515245 + 12345;
+	return seed / 65536 % 32768;
+}
+
+int fill_hist(int n)
+{
+	for (int i = 0; i < 16; i = i + 1)
+		hist[i] = 0;
+	for (int i = 0; i < n; i = i + 1)
+	{
+		int b = next_rand() % 16;
+		hist[b] = hist[b] + 1;
+	}
+	int total = 0;
+	for (int i = 0; i < 16; i = i + 1)
+		total = total + hist[i];
+	return total;
+}
+
+int sum_row(int row[], int n)
+{
+	int s = 0;
+	for (int i = 0; i < n; i = i + 1)
+		s = s + row[i];
+	return s;
+}
+
+int trace(int m[][5], int n)
+{
+	int s = 0;
+	for (int i = 0; i < n; i = i + 1)
+		s = s + m[i][i];
+	return s;
+}
+
+int matrix(int n)
+{
+	int local[4][5];
+	for (int i = 0; i < 4; i = i + 1)
+		for (int j = 0; j < 5; j = j + 1)
+			local[i][j] = i * n + j;
+	for (int i = 0; i < 4; i = i + 1)
+		for (int j = 0; j < 5; j = j + 1)
+			grid[i][j] = local[i][j] * 2;
+
+	int s = 0;
+	for (int i = 0; i < 4; i = i + 1)
+		s = s + sum_row(local[i], 5);
+	return s + trace(grid, 4);
+}
+
+int count_primes(int n)
+{
+	int sieve[100] __attribute__((aligned(16)));
+	for (int i = 0; i < n; i = i + 1)
+		sieve[i] = 1;
+	int count = 0;
+	for (int i = 2; i < n; i = i + 1)
+	{
+		if (!sieve[i])
+			continue;
+		count = count + 1;
+		for (int j = i * i; j < n; j = j + i)
+			sieve[j] = 0;
+	}
+	return count;
+}
+
+void sort(int a[], int n)
+{
+	for (int i = 0; i < n; i = i + 1)
+		for (int j = 0; j + 1 < n - i; j = j + 1)
+			if (a[j] > a[j + 1])
+			{
+				int t = a[j];
+				a[j] = a[j + 1];
+				a[j + 1] = t;
+			}
+}
+
+int sorted_digits()
+{
+	int a[10];
+	for (unsigned int i = 0; i < 10; i = i + 1)
+		a[i] = i * 7 % 10;
+	sort(a, 10);
+	return a[0] * 100 + a[5] * 10 + a[9];
+}
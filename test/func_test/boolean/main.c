@@ -0,0 +1,44 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+int less(int a, int b);
+int logical_not(int a);
+int double_not(int a);
+int count_true(int a, int b, int c);
+int both(int a, int b);
+int either(int a, int b);
+int int_condition(int n);
+int not_condition(int a);
+int compare_bools(int a, int b);
+
+int main([[maybe_unused]] int argc, char* argv[])
+{
+#define CHECK_RESULT(prog, ret, expected)                                      \
+	if ((ret) != (expected))                                                   \
+	{                                                                          \
+		printf("%s: boolean error. %s = %d, expected = %d\n", prog, #ret, ret, \
+			   expected);                                                      \
+		exit(1);                                                               \
+	}
+
+	CHECK_RESULT(argv[0], less(1, 2), 1);
+	CHECK_RESULT(argv[0], less(2, 1), 0);
+	CHECK_RESULT(argv[0], logical_not(0), 1);
+	CHECK_RESULT(argv[0], logical_not(5), 0);
+	CHECK_RESULT(argv[0], logical_not(-1), 0);
+	CHECK_RESULT(argv[0], double_not(7), 1);
+	CHECK_RESULT(argv[0], double_not(0), 0);
+	CHECK_RESULT(argv[0], count_true(1, -1, 3), 2);
+	CHECK_RESULT(argv[0], both(2, 3), 1);
+	CHECK_RESULT(argv[0], both(2, 0), 0);
+	CHECK_RESULT(argv[0], either(0, 4), 1);
+	CHECK_RESULT(argv[0], either(0, 0), 0);
+	CHECK_RESULT(argv[0], int_condition(3), 3);
+	CHECK_RESULT(argv[0], int_condition(0), -1);
+	CHECK_RESULT(argv[0], not_condition(2), 1);
+	CHECK_RESULT(argv[0], not_condition(-2), 0);
+	CHECK_RESULT(argv[0], compare_bools(1, 2), 1);
+	CHECK_RESULT(argv[0], compare_bools(1, -2), 0);
+
+	printf("%s: success\n", argv[0]);
+}
@@ -0,0 +1,57 @@
+int less(int a, int b)
+{
+	return a < b;
+}
+
+int logical_not(int a)
+{
+	return !a;
+}
+
+int double_not(int a)
+{
+	return !!a;
+}
+
+int count_true(int a, int b, int c)
+{
+	int count = a > 0;
+	count = count + (b > 0) + (c > 0);
+	return count;
+}
+
+int both(int a, int b)
+{
+	int result = a && b;
+	return result;
+}
+
+int either(int a, int b)
+{
+	return a || b;
+}
+
+int int_condition(int n)
+{
+	int steps = 0;
+	while (n)
+	{
+		n = n - 1;
+		steps = steps + 1;
+	}
+	if (steps)
+		return steps;
+	return -1;
+}
+
+int not_condition(int a)
+{
+	if (!(a < 0))
+		return 1;
+	return 0;
+}
+
+int compare_bools(int a, int b)
+{
+	return (a > 0) == (b > 0);
+}
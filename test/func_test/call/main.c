@@ -0,0 +1,31 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+int test_forward(int x);
+int add_one(int x);
+int test_backward(int x);
+int test_no_params();
+int fact(int n);
+int is_even(int n);
+int is_odd(int n);
+
+int main([[maybe_unused]] int argc, char* argv[])
+{
+#define CHECK_RESULT(prog, ret, expected)                                      \
+	if ((ret) != (expected))                                                   \
+	{                                                                          \
+		printf("%s: call error. %s = %d, expected = %d\n", prog, #ret, ret,    \
+			   expected);                                                      \
+		exit(1);                                                               \
+	}
+
+	CHECK_RESULT(argv[0], test_forward(1), 3);
+	CHECK_RESULT(argv[0], add_one(1), 2);
+	CHECK_RESULT(argv[0], test_backward(1), 4);
+	CHECK_RESULT(argv[0], test_no_params(), 7);
+	CHECK_RESULT(argv[0], fact(5), 120);
+	CHECK_RESULT(argv[0], is_even(10), 1);
+	CHECK_RESULT(argv[0], is_odd(7), 1);
+
+	printf("%s: success\n", argv[0]);
+}
@@ -0,0 +1,40 @@
+int test_forward(int x)
+{
+	return add_one(x) + 1;
+}
+
+int add_one(int x)
+{
+	return x + 1;
+}
+
+int test_backward(int x)
+{
+	return add_one(x) * 2;
+}
+
+int test_no_params()
+{
+	return test_forward(1) + test_backward(1);
+}
+
+int fact(int n)
+{
+	if (n <= 1)
+		return 1;
+	return n * fact(n - 1);
+}
+
+int is_even(int n)
+{
+	if (n == 0)
+		return 1;
+	return is_odd(n - 1);
+}
+
+int is_odd(int n)
+{
+	if (n == 0)
+		return 0;
+	return is_even(n - 1);
+}
@@ -0,0 +1,20 @@
+#!/usr/bin/env bash
+
+# 使用-direct-ssa重新编译其他功能测试, 结果应与默认模式相同
+source ../func.sh
+
+check_toycc $1
+
+mkdir -p bin
+
+for dir in return arithmetic block if_else while call short_circuit boolean unsigned loop switch goto array pointer vector struct eval range_fold; do
+	program=bin/$dir.out
+	$1 ../$dir/test.c -o bin/$dir.o --filetype=obj -direct-ssa
+	exit_if_failure "toycc compile $dir failed"
+
+	gcc -I../$dir ../$dir/main.c bin/$dir.o -o $program
+	exit_if_failure "gcc compile $dir failed"
+
+	$program
+	exit_if_failure "$program exit"
+done
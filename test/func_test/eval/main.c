@@ -0,0 +1,35 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+int get_fib_20();
+int get_gcd();
+int collatz_27();
+int digit_sum_const();
+int fib_at(int n);
+int gcd_at(int a, int b);
+int digit_sum_at(unsigned x);
+
+int main([[maybe_unused]] int argc, char* argv[])
+{
+#define CHECK_RESULT(prog, ret, expected)                                      \
+	if ((ret) != (expected))                                                   \
+	{                                                                          \
+		printf("%s: eval error. %s = %d, expected = %d\n", prog, #ret,         \
+			   (int)(ret), (int)(expected));                                   \
+		exit(1);                                                               \
+	}
+
+	CHECK_RESULT(argv[0], get_fib_20(), 6765);
+	CHECK_RESULT(argv[0], get_gcd(), 21);
+	CHECK_RESULT(argv[0], collatz_27(), 111);
+	CHECK_RESULT(argv[0], digit_sum_const(), 94);
+
+	// 运行时的结果与编译期相同
+	CHECK_RESULT(argv[0], fib_at(20), 6765);
+	CHECK_RESULT(argv[0], fib_at(0), 0);
+	CHECK_RESULT(argv[0], gcd_at(1071, 462), 21);
+	CHECK_RESULT(argv[0], digit_sum_at(987654u), 39);
+	CHECK_RESULT(argv[0], digit_sum_at(0u), 0);
+
+	return 0;
+}
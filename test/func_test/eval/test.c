@@ -0,0 +1,87 @@
+eval int fib(int n)
+{
+	int a = 0;
+	int b = 1;
+	while (n > 0)
+	{
+		int t = a + b;
+		a = b;
+		b = t;
+		n = n - 1;
+	}
+	return a;
+}
+
+eval int gcd(int a, int b)
+{
+	if (b == 0)
+		return a;
+	return gcd(b, a % b);
+}
+
+eval int collatz(int n)
+{
+	int steps = 0;
+	for (; n != 1; steps = steps + 1)
+	{
+		if (n % 2 == 0)
+		{
+			n = n / 2;
+			continue;
+		}
+		n = 3 * n + 1;
+	}
+	return steps;
+}
+
+eval int digit_sum(unsigned x)
+{
+	int sum = 0;
+	do
+	{
+		sum = sum + x % 10;
+		x = x / 10;
+	} while (x != 0);
+	return sum;
+}
+
+// 全局变量的初始值在编译期求值
+int fib_20 = fib(20);
+int gcd_value = gcd(1071, 462);
+
+int get_fib_20()
+{
+	return fib_20;
+}
+
+int get_gcd()
+{
+	return gcd_value;
+}
+
+int collatz_27()
+{
+	eval int steps = collatz(27);
+	return steps;
+}
+
+int digit_sum_const()
+{
+	return digit_sum(987654) + fib(10);
+}
+
+// 实参不是常量时在运行时调用
+int fib_at(int n)
+{
+	return fib(n);
+}
+
+int gcd_at(int a, int b)
+{
+	return gcd(a, b);
+}
+
+int digit_sum_at(unsigned x)
+{
+	return digit_sum(x);
+}
@@ -0,0 +1,31 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+int sum_goto(int n);
+int find_pair(int n, int target);
+int collatz_steps(int n);
+int duff(int count);
+
+int main([[maybe_unused]] int argc, char* argv[])
+{
+#define CHECK_RESULT(prog, ret, expected)                                      \
+	if ((ret) != (expected))                                                   \
+	{                                                                          \
+		printf("%s: goto error. %s = %d, expected = %d\n", prog, #ret,         \
+			   (ret), (expected));                                             \
+		exit(1);                                                               \
+	}
+
+	CHECK_RESULT(argv[0], sum_goto(10), 55);
+	CHECK_RESULT(argv[0], sum_goto(0), 0);
+	CHECK_RESULT(argv[0], find_pair(10, 12), 206);
+	CHECK_RESULT(argv[0], find_pair(10, 97), -1);
+	CHECK_RESULT(argv[0], collatz_steps(1), 0);
+	CHECK_RESULT(argv[0], collatz_steps(6), 8);
+	CHECK_RESULT(argv[0], collatz_steps(27), 111);
+	CHECK_RESULT(argv[0], duff(1), 4);
+	CHECK_RESULT(argv[0], duff(4), 10);
+	CHECK_RESULT(argv[0], duff(7), 19);
+
+	printf("%s: success\n", argv[0]);
+}
@@ -0,0 +1,82 @@
+int sum_goto(int n)
+{
+	// 向后跳转构成循环
+	int sum = 0;
+again:
+	if (n <= 0)
+		goto done;
+	sum = sum + n;
+	n = n - 1;
+	goto again;
+done:
+	return sum;
+}
+
+int find_pair(int n, int target)
+{
+	// 跳出多层循环
+	int result = -1;
+	for (int i = 1; i < n; i = i + 1)
+		for (int j = i; j < n; j = j + 1)
+			if (i * j == target)
+			{
+				result = i * 100 + j;
+				goto out;
+			}
+out:
+	return result;
+}
+
+int collatz_steps(int n)
+{
+	// 每个处理程序末尾都有各自的间接跳转
+	unsigned int even = &&on_even;
+	unsigned int odd = &&on_odd;
+	unsigned int done = &&on_done;
+	int steps = 0;
+	unsigned int next = done;
+	if (n > 1)
+	{
+		if (n % 2)
+			next = odd;
+		else
+			next = even;
+	}
+	goto *next;
+on_even:
+	n = n / 2;
+	steps = steps + 1;
+	next = done;
+	if (n > 1)
+	{
+		if (n % 2)
+			next = odd;
+		else
+			next = even;
+	}
+	goto *next;
+on_odd:
+	// 奇数的3n+1总是偶数
+	n = 3 * n + 1;
+	steps = steps + 1;
+	goto *even;
+on_done:
+	return steps;
+}
+
+int duff(int count)
+{
+	// case标号位于循环体中
+	int n = (count + 3) / 4;
+	int total = 0;
+	switch (count % 4)
+	{
+	case 0: do { total = total + 1;
+	case 3:      total = total + 2;
+	case 2:      total = total + 3;
+	case 1:      total = total + 4;
+			n = n - 1;
+		} while (n > 0);
+	}
+	return total;
+}
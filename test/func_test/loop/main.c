@@ -0,0 +1,32 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+int sum_for(int n);
+int count_do(int n);
+int sum_even(int n);
+int first_multiple(int start, int m);
+int triangle(int n);
+int skip_do(int n);
+
+int main([[maybe_unused]] int argc, char* argv[])
+{
+#define CHECK_RESULT(prog, ret, expected)                                      \
+	if ((ret) != (expected))                                                   \
+	{                                                                          \
+		printf("%s: loop error. %s = %d, expected = %d\n", prog, #ret,         \
+			   (ret), (expected));                                             \
+		exit(1);                                                               \
+	}
+
+	CHECK_RESULT(argv[0], sum_for(10), 45);
+	CHECK_RESULT(argv[0], sum_for(0), 0);
+	CHECK_RESULT(argv[0], count_do(5), 5);
+	CHECK_RESULT(argv[0], count_do(0), 1);
+	CHECK_RESULT(argv[0], sum_even(10), 20);
+	CHECK_RESULT(argv[0], first_multiple(10, 7), 14);
+	CHECK_RESULT(argv[0], triangle(4), 10);
+	CHECK_RESULT(argv[0], triangle(0), 0);
+	CHECK_RESULT(argv[0], skip_do(6), 12);
+
+	printf("%s: success\n", argv[0]);
+}
@@ -0,0 +1,73 @@
+int sum_for(int n)
+{
+	int sum = 0;
+	for (int i = 0; i < n; i = i + 1)
+		sum = sum + i;
+	return sum;
+}
+
+int count_do(int n)
+{
+	// 循环体至少执行一次
+	int count = 0;
+	do
+	{
+		count = count + 1;
+		n = n - 1;
+	} while (n > 0);
+	return count;
+}
+
+int sum_even(int n)
+{
+	int sum = 0;
+	int i;
+	for (i = 0; i < n; i = i + 1)
+	{
+		if (i % 2)
+			continue;
+		sum = sum + i;
+	}
+	return sum;
+}
+
+int first_multiple(int start, int m)
+{
+	for (;;)
+	{
+		if (start % m == 0)
+			break;
+		start = start + 1;
+	}
+	return start;
+}
+
+int triangle(int n)
+{
+	int count = 0;
+	int i = 0;
+	while (i < n)
+	{
+		i = i + 1;
+		for (int j = 0; j < n; j = j + 1)
+		{
+			if (j >= i)
+				break;
+			count = count + 1;
+		}
+	}
+	return count;
+}
+
+int skip_do(int n)
+{
+	int sum = 0;
+	do
+	{
+		n = n - 1;
+		if (n == 3)
+			continue;
+		sum = sum + n;
+	} while (n > 0);
+	return sum;
+}
@@ -0,0 +1,54 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+extern int counter;
+
+int swap_locals(int x, int y);
+void axpy(int* restrict y, int* restrict x, int a, int n);
+int sum(int* begin, int* end);
+int index_of(int* data, int n, int value);
+void reverse(int* data, int n);
+int count_through(int** pp, int n);
+int advance(void);
+
+int main([[maybe_unused]] int argc, char* argv[])
+{
+#define CHECK_RESULT(prog, ret, expected)                                      \
+	if ((ret) != (expected))                                                   \
+	{                                                                          \
+		printf("%s: pointer error. %s = %d, expected = %d\n", prog, #ret,      \
+			   (ret), (expected));                                             \
+		exit(1);                                                               \
+	}
+
+	CHECK_RESULT(argv[0], swap_locals(3, 7), 73);
+
+	int y[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+	int x[8] = { 8, 7, 6, 5, 4, 3, 2, 1 };
+	axpy(y, x, 3, 8);
+	for (int i = 0; i < 8; ++i)
+		CHECK_RESULT(argv[0], y[i], (i + 1) + 3 * (8 - i));
+
+	CHECK_RESULT(argv[0], sum(x, x + 8), 36);
+	CHECK_RESULT(argv[0], sum(x + 2, x + 5), 15);
+	CHECK_RESULT(argv[0], sum(x, x), 0);
+
+	CHECK_RESULT(argv[0], index_of(x, 8, 5), 3);
+	CHECK_RESULT(argv[0], index_of(x, 8, 9), -1);
+
+	reverse(x, 8);
+	for (int i = 0; i < 8; ++i)
+		CHECK_RESULT(argv[0], x[i], i + 1);
+	reverse(x, 1);
+	CHECK_RESULT(argv[0], x[0], 1);
+
+	int* p = x;
+	CHECK_RESULT(argv[0], count_through(&p, 5), 30);
+	CHECK_RESULT(argv[0], p == NULL, 1);
+
+	CHECK_RESULT(argv[0], advance(), 5);
+	CHECK_RESULT(argv[0], advance(), 10);
+	CHECK_RESULT(argv[0], counter, 10);
+
+	return 0;
+}
@@ -0,0 +1,80 @@
+int counter;
+int* cursor;
+
+void swap(int* a, int* b)
+{
+	int t = *a;
+	*a = *b;
+	*b = t;
+}
+
+int swap_locals(int x, int y)
+{
+	swap(&x, &y);
+	return x * 10 + y;
+}
+
+void axpy(int* restrict y, int* restrict x, int a, int n)
+{
+	for (int i = 0; i < n; i = i + 1)
+		y[i] = y[i] + a * x[i];
+}
+
+int sum(int* begin, int* end)
+{
+	int s = 0;
+	for (int* p = begin; p < end; p = p + 1)
+		s = s + *p;
+	return s;
+}
+
+int* find(int* data, int n, int value)
+{
+	for (int i = 0; i < n; i = i + 1)
+	{
+		if (data[i] == value)
+			return data + i;
+	}
+	return 0;
+}
+
+int index_of(int* data, int n, int value)
+{
+	int* p = find(data, n, value);
+	if (!p)
+		return -1;
+	return p - data;
+}
+
+void reverse(int* data, int n)
+{
+	int* lo = data;
+	int* hi = data + n - 1;
+	while (lo < hi)
+	{
+		swap(lo, hi);
+		lo = lo + 1;
+		hi = hi - 1;
+	}
+}
+
+int count_through(int** pp, int n)
+{
+	int buf[8];
+	for (int i = 0; i < 8; i = i + 1)
+		buf[i] = i * i;
+	*pp = &buf[0];
+	int s = 0;
+	for (int i = 0; i < n; i = i + 1)
+		s = s + *(*pp + i);
+	*pp = 0;
+	return s;
+}
+
+int advance()
+{
+	cursor = &counter;
+	*cursor = *cursor + 5;
+	cursor = 0;
+	return counter;
+}
@@ -0,0 +1,31 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+int index_sum(int* p, int a, int b);
+int index_rem(int* p, int a);
+int distance(int* p, int* q);
+int negate_sum(int a);
+
+int main([[maybe_unused]] int argc, char* argv[])
+{
+#define CHECK_RESULT(prog, ret, expected)                                      \
+	if ((ret) != (expected))                                                   \
+	{                                                                          \
+		printf("%s: range_fold error. %s = %d, expected = %d\n", prog, #ret,   \
+			   (int)(ret), (int)(expected));                                   \
+		exit(1);                                                               \
+	}
+
+	int data[] = { 10, 11, 12, 13, 14, 15, 16, 17, 18 };
+	int* middle = data + 4;
+
+	CHECK_RESULT(argv[0], index_sum(middle, -1, 3), 11);
+	CHECK_RESULT(argv[0], index_sum(middle, 2, 2), 18);
+	CHECK_RESULT(argv[0], index_rem(middle, -3), 11);
+	CHECK_RESULT(argv[0], index_rem(middle, 7), 17);
+	CHECK_RESULT(argv[0], distance(middle, data), -4);
+	CHECK_RESULT(argv[0], distance(data, middle), 4);
+	CHECK_RESULT(argv[0], negate_sum(5), -5);
+
+	printf("%s: success\n", argv[0]);
+}
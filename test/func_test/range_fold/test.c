@@ -0,0 +1,26 @@
+// x + 0, x * 1等被化简为已有的值, 其范围不能按+或*重新推导
+
+int index_sum(int* p, int a, int b)
+{
+	// a * b + 0化简为a * b, 为负数时需要符号扩展
+	return p[a * b + 0];
+}
+
+int index_rem(int* p, int a)
+{
+	// (a % 4) * 1化简为a % 4, 其范围为[-3, 3]而不是{0}
+	return p[(a % 4) * 1];
+}
+
+int distance(int* p, int* q)
+{
+	// 指针之差为sdiv exact, 加0后不能被当作除以0
+	int d = (q - p) + 0;
+	return d;
+}
+
+int negate_sum(int a)
+{
+	// -(a - 0)化简后仍为sub 0, x
+	return -(a - 0);
+}
@@ -0,0 +1,38 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+int and_guard(int a, int n);
+int or_guard(int a, int n);
+int while_guard(int a, int n);
+int mixed(int a, int b, int c);
+int nested(int a, int b, int c);
+
+int main([[maybe_unused]] int argc, char* argv[])
+{
+#define CHECK_RESULT(prog, ret, expected)                                      \
+	if ((ret) != (expected))                                                   \
+	{                                                                          \
+		printf("%s: short circuit error. %s = %d, expected = %d\n", prog,     \
+			   #ret, ret, expected);                                           \
+		exit(1);                                                               \
+	}
+
+	// 除数为0时右操作数不能被求值
+	CHECK_RESULT(argv[0], and_guard(10, 0), 0);
+	CHECK_RESULT(argv[0], and_guard(10, 2), 1);
+	CHECK_RESULT(argv[0], and_guard(10, 20), 0);
+	CHECK_RESULT(argv[0], or_guard(10, 0), 1);
+	CHECK_RESULT(argv[0], or_guard(10, 2), 1);
+	CHECK_RESULT(argv[0], or_guard(10, 20), 0);
+	CHECK_RESULT(argv[0], while_guard(10, 0), 0);
+	CHECK_RESULT(argv[0], while_guard(10, 1), 10);
+	CHECK_RESULT(argv[0], mixed(1, 1, 0), 1);
+	CHECK_RESULT(argv[0], mixed(1, 0, 0), 0);
+	CHECK_RESULT(argv[0], mixed(0, 0, 1), 1);
+	CHECK_RESULT(argv[0], nested(1, 0, 0), 0);
+	CHECK_RESULT(argv[0], nested(0, 1, 1), 0);
+	CHECK_RESULT(argv[0], nested(2, 0, 1), 1);
+	CHECK_RESULT(argv[0], nested(0, 0, 1), 0);
+
+	printf("%s: success\n", argv[0]);
+}
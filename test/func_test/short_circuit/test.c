@@ -0,0 +1,38 @@
+int and_guard(int a, int n)
+{
+	if (n != 0 && a / n > 1)
+		return 1;
+	return 0;
+}
+
+int or_guard(int a, int n)
+{
+	if (n == 0 || a / n > 1)
+		return 1;
+	return 0;
+}
+
+int while_guard(int a, int n)
+{
+	int count = 0;
+	while (n != 0 && a / n > 0)
+	{
+		count = count + 1;
+		n = n + 1;
+	}
+	return count;
+}
+
+int mixed(int a, int b, int c)
+{
+	if (a > 0 && b > 0 || c > 0)
+		return 1;
+	return 0;
+}
+
+int nested(int a, int b, int c)
+{
+	if ((a > 0 || b > 0) && (c != 0 && a / c > 0))
+		return 1;
+	return 0;
+}
@@ -0,0 +1,67 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+// 与test.c中的定义布局相同
+struct node
+{
+	int value;
+	struct node* next;
+};
+
+struct point
+{
+	int x;
+	int y;
+	int tags[3];
+};
+
+void link(struct node* nodes, int n);
+int list_sum(struct node* head);
+struct node* find(struct node* head, int value);
+int point_area(struct point* p);
+void move_point(struct point* p, int dx, int dy);
+int fill_table(int* data);
+int origin_sum();
+
+int main([[maybe_unused]] int argc, char* argv[])
+{
+#define CHECK_RESULT(prog, ret, expected)                                      \
+	if ((ret) != (expected))                                                   \
+	{                                                                          \
+		printf("%s: struct error. %s = %d, expected = %d\n", prog, #ret,       \
+			   (int)(ret), (int)(expected));                                   \
+		exit(1);                                                               \
+	}
+
+	struct node nodes[5];
+	for (int i = 0; i < 5; ++i)
+	{
+		nodes[i].value = (i + 1) * 3;
+		nodes[i].next = NULL;
+	}
+	link(nodes, 5);
+	CHECK_RESULT(argv[0], nodes[4].next == NULL, 1);
+	CHECK_RESULT(argv[0], nodes[2].next == &nodes[3], 1);
+	CHECK_RESULT(argv[0], list_sum(nodes), 45);
+	CHECK_RESULT(argv[0], list_sum(&nodes[3]), 27);
+	CHECK_RESULT(argv[0], find(nodes, 9) == &nodes[2], 1);
+	CHECK_RESULT(argv[0], find(nodes, 10) == NULL, 1);
+
+	struct point p = { 4, 5, { 1, 2, 3 } };
+	CHECK_RESULT(argv[0], point_area(&p), 28);
+	// 副本的修改不影响原对象
+	CHECK_RESULT(argv[0], p.x, 4);
+	move_point(&p, -1, 2);
+	CHECK_RESULT(argv[0], p.x, 3);
+	CHECK_RESULT(argv[0], p.y, 7);
+	CHECK_RESULT(argv[0], p.tags[0], 2);
+	CHECK_RESULT(argv[0], p.tags[2], 3);
+
+	int data[4] = { 7, -2, 5, 1 };
+	CHECK_RESULT(argv[0], fill_table(data), 116);
+
+	CHECK_RESULT(argv[0], origin_sum(), 12);
+	CHECK_RESULT(argv[0], origin_sum(), 19);
+
+	return 0;
+}
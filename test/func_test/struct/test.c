@@ -0,0 +1,87 @@
+struct node
+{
+	int value;
+	struct node* next;
+};
+
+struct point
+{
+	int x;
+	int y;
+	int tags[3];
+};
+
+// 只在本文件中使用, 成员按对齐重排: data在前, id和weight共用一个8字节
+struct record
+{
+	int id;
+	int* data;
+	int weight;
+} __attribute__((reorder));
+
+struct record table[4];
+struct point origin;
+
+void link(struct node* nodes, int n)
+{
+	for (int i = 0; i + 1 < n; i = i + 1)
+		nodes[i].next = &nodes[i + 1];
+	nodes[n - 1].next = 0;
+}
+
+int list_sum(struct node* head)
+{
+	int sum = 0;
+	struct node* p = head;
+	while (p)
+	{
+		sum = sum + p->value;
+		p = p->next;
+	}
+	return sum;
+}
+
+struct node* find(struct node* head, int value)
+{
+	struct node* p = head;
+	while (p && p->value != value)
+		p = p->next;
+	return p;
+}
+
+int point_area(struct point* p)
+{
+	struct point copy;
+	copy = *p;
+	copy.x = copy.x + 1;
+	return copy.x * copy.y + copy.tags[2];
+}
+
+void move_point(struct point* p, int dx, int dy)
+{
+	p->x = p->x + dx;
+	p->y = p->y + dy;
+	p->tags[0] = p->tags[0] + 1;
+}
+
+int fill_table(int* data)
+{
+	for (int i = 0; i < 4; i = i + 1)
+	{
+		table[i].id = i;
+		table[i].data = &data[i];
+		table[i].weight = i * 10;
+	}
+	int total = 0;
+	for (int i = 0; i < 4; i = i + 1)
+		total = total + table[i].weight * *table[i].data + table[i].id;
+	return total;
+}
+
+int origin_sum()
+{
+	int before = origin.x + origin.y;
+	origin.x = 3;
+	origin.y = 4;
+	return before + origin.x * origin.y;
+}
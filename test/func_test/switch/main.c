@@ -0,0 +1,45 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+int dense(int n);
+int sparse(int n);
+int fallthrough(int n);
+int count_kinds(int n);
+int nested(int a, int b);
+unsigned int wide(unsigned int n);
+
+int main([[maybe_unused]] int argc, char* argv[])
+{
+#define CHECK_RESULT(prog, ret, expected)                                      \
+	if ((ret) != (expected))                                                   \
+	{                                                                          \
+		printf("%s: switch error. %s = %d, expected = %d\n", prog, #ret,       \
+			   (int)(ret), (int)(expected));                                   \
+		exit(1);                                                               \
+	}
+
+	CHECK_RESULT(argv[0], dense(0), 3);
+	CHECK_RESULT(argv[0], dense(5), 9);
+	CHECK_RESULT(argv[0], dense(7), 6);
+	CHECK_RESULT(argv[0], dense(8), -1);
+	CHECK_RESULT(argv[0], dense(-1), -1);
+	CHECK_RESULT(argv[0], sparse(-5), 1);
+	CHECK_RESULT(argv[0], sparse(100), 3);
+	CHECK_RESULT(argv[0], sparse(100000), 5);
+	CHECK_RESULT(argv[0], sparse(7), 0);
+	CHECK_RESULT(argv[0], fallthrough(1), 111);
+	CHECK_RESULT(argv[0], fallthrough(2), 110);
+	CHECK_RESULT(argv[0], fallthrough(3), 1000);
+	CHECK_RESULT(argv[0], fallthrough(9), 100);
+	CHECK_RESULT(argv[0], count_kinds(12), 6014);
+	CHECK_RESULT(argv[0], nested(0, 0), 4);
+	CHECK_RESULT(argv[0], nested(3, 0), 4);
+	CHECK_RESULT(argv[0], nested(1, 0), 1);
+	CHECK_RESULT(argv[0], nested(1, 1), 2);
+	CHECK_RESULT(argv[0], nested(2, 1), 3);
+	CHECK_RESULT(argv[0], wide(4294967295u), 1);
+	CHECK_RESULT(argv[0], wide(0u), 2);
+	CHECK_RESULT(argv[0], wide(5u), 0);
+
+	printf("%s: success\n", argv[0]);
+}
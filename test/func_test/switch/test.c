@@ -0,0 +1,97 @@
+int dense(int n)
+{
+	// 连续的case生成跳转表
+	switch (n)
+	{
+	case 0: return 3;
+	case 1: return 1;
+	case 2: return 4;
+	case 3: return 1;
+	case 4: return 5;
+	case 5: return 9;
+	case 6: return 2;
+	case 7: return 6;
+	}
+	return -1;
+}
+
+int sparse(int n)
+{
+	// 稀疏的case生成二分查找
+	int r;
+	switch (n)
+	{
+	case -5: r = 1; break;
+	case 1: r = 2; break;
+	case 100: r = 3; break;
+	case 1000: r = 4; break;
+	case 100000: r = 5; break;
+	default: r = 0;
+	}
+	return r;
+}
+
+int fallthrough(int n)
+{
+	int r = 0;
+	switch (n)
+	{
+	case 1: r = r + 1;
+	case 2: r = r + 10;
+	default: r = r + 100; break;
+	case 3: r = r + 1000;
+	}
+	return r;
+}
+
+int count_kinds(int n)
+{
+	// continue跳过switch继续外层循环
+	int odd = 0;
+	int sum = 0;
+	for (int i = 0; i < n; i = i + 1)
+	{
+		switch (i % 4)
+		{
+		case 1:
+		case 3:
+			odd = odd + 1;
+			continue;
+		case 2:
+			if (i > 8)
+				break;
+			sum = sum + i;
+		}
+		sum = sum + 1;
+	}
+	return odd * 1000 + sum;
+}
+
+int nested(int a, int b)
+{
+	switch (a)
+	case 1:
+	case 2:
+		switch (b)
+		{
+		case 0: return 1;
+		default:
+			switch (a + b)
+			{
+			case 2: return 2;
+			}
+			return 3;
+		}
+	return 4;
+}
+
+unsigned int wide(unsigned int n)
+{
+	// case的值转换为控制表达式的类型
+	switch (n)
+	{
+	case -1: return 1;
+	case 0: return 2;
+	}
+	return 0;
+}
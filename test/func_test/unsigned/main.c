@@ -0,0 +1,34 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+unsigned int udiv(unsigned int a, unsigned int b);
+unsigned int urem(unsigned int a, unsigned int b);
+int sdiv(int a, int b);
+int ult(unsigned int a, unsigned int b);
+int mixed_lt(int a, unsigned int b);
+unsigned int max_unsigned();
+unsigned int negate(unsigned int a);
+int count_up(int n);
+
+int main([[maybe_unused]] int argc, char* argv[])
+{
+#define CHECK_RESULT(prog, ret, expected)                                      \
+	if ((ret) != (expected))                                                   \
+	{                                                                          \
+		printf("%s: unsigned error. %s = %u, expected = %u\n", prog, #ret,     \
+			   (unsigned)(ret), (unsigned)(expected));                         \
+		exit(1);                                                               \
+	}
+
+	CHECK_RESULT(argv[0], udiv(4000000000u, 2u), 2000000000u);
+	CHECK_RESULT(argv[0], urem(4000000001u, 2u), 1u);
+	CHECK_RESULT(argv[0], sdiv(-7, 2), -3);
+	CHECK_RESULT(argv[0], ult(1u, 4000000000u), 1);
+	CHECK_RESULT(argv[0], ult(4000000000u, 1u), 0);
+	CHECK_RESULT(argv[0], mixed_lt(-1, 1u), 0);
+	CHECK_RESULT(argv[0], max_unsigned(), 4294967295u);
+	CHECK_RESULT(argv[0], negate(1u), 4294967295u);
+	CHECK_RESULT(argv[0], count_up(10), 10);
+
+	printf("%s: success\n", argv[0]);
+}
@@ -0,0 +1,44 @@
+unsigned int udiv(unsigned int a, unsigned int b)
+{
+	return a / b;
+}
+
+unsigned int urem(unsigned int a, unsigned int b)
+{
+	return a % b;
+}
+
+int sdiv(int a, int b)
+{
+	return a / b;
+}
+
+int ult(unsigned int a, unsigned int b)
+{
+	return a < b;
+}
+
+int mixed_lt(int a, unsigned int b)
+{
+	// a转换为无符号数后比较
+	return a < b;
+}
+
+unsigned int max_unsigned()
+{
+	unsigned int zero = 0;
+	return zero - 1;
+}
+
+unsigned int negate(unsigned int a)
+{
+	return -a;
+}
+
+int count_up(int n)
+{
+	int i = 0;
+	while (i < n)
+		i = i + 1;
+	return i;
+}
@@ -0,0 +1,65 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+int dot4(int* a, int* b);
+int count_less8(int* data, int limit);
+void clamp4(int* data, int lo, int hi);
+void reverse4(int* data);
+void interleave(int* a, int* b, int* out);
+int spread4(int* data);
+unsigned umax4(unsigned* data);
+int fold4(int* data);
+int negate_zero(int* data);
+int add_bias(int x);
+
+int main([[maybe_unused]] int argc, char* argv[])
+{
+#define CHECK_RESULT(prog, ret, expected)                                      \
+	if ((ret) != (expected))                                                   \
+	{                                                                          \
+		printf("%s: vector error. %s = %d, expected = %d\n", prog, #ret,       \
+			   (int)(ret), (int)(expected));                                   \
+		exit(1);                                                               \
+	}
+
+	int a[4] = { 1, 2, 3, 4 };
+	int b[4] = { 5, -6, 7, 8 };
+	CHECK_RESULT(argv[0], dot4(a, b), 46);
+
+	int data[8] = { 3, -1, 8, 0, 7, 2, 9, -4 };
+	CHECK_RESULT(argv[0], count_less8(data, 3), 4);
+	CHECK_RESULT(argv[0], count_less8(data, 10), 8);
+	CHECK_RESULT(argv[0], count_less8(data, -4), 0);
+
+	int c[4] = { -5, 2, 11, 7 };
+	clamp4(c, 0, 8);
+	CHECK_RESULT(argv[0], c[0], 0);
+	CHECK_RESULT(argv[0], c[1], 2);
+	CHECK_RESULT(argv[0], c[2], 8);
+	CHECK_RESULT(argv[0], c[3], 7);
+
+	reverse4(a);
+	for (int i = 0; i < 4; ++i)
+		CHECK_RESULT(argv[0], a[i], 4 - i);
+
+	int out[8];
+	int odd[4] = { 1, 3, 5, 7 };
+	int even[4] = { 2, 4, 6, 8 };
+	interleave(odd, even, out);
+	for (int i = 0; i < 8; ++i)
+		CHECK_RESULT(argv[0], out[i], i + 1);
+
+	CHECK_RESULT(argv[0], spread4(b), 14);
+	unsigned u[4] = { 7, 3000000000u, 12, 0 };
+	CHECK_RESULT(argv[0], umax4(u), 3000000000u);
+
+	int f[4] = { 1, 2, 3, 4 };
+	CHECK_RESULT(argv[0], fold4(f), 35);
+	int z[4] = { 0, 5, 0, -3 };
+	CHECK_RESULT(argv[0], negate_zero(z), -4);
+
+	CHECK_RESULT(argv[0], add_bias(5), 35);
+	CHECK_RESULT(argv[0], add_bias(1), 18);
+
+	return 0;
+}
@@ -0,0 +1,85 @@
+int4 bias = 2;
+
+int4 load4(int* p)
+{
+	int4 v;
+	for (int i = 0; i < 4; i = i + 1)
+		v[i] = p[i];
+	return v;
+}
+
+void store4(int* p, int4 v)
+{
+	for (int i = 0; i < 4; i = i + 1)
+		p[i] = v[i];
+}
+
+int dot4(int* a, int* b)
+{
+	return __builtin_reduce_add(load4(a) * load4(b));
+}
+
+int count_less8(int* data, int limit)
+{
+	int8 v;
+	for (int i = 0; i < 8; i = i + 1)
+		v[i] = data[i];
+	// 比较结果的每个通道为-1或0
+	return -__builtin_reduce_add(v < limit);
+}
+
+void clamp4(int* data, int lo, int hi)
+{
+	int4 v = load4(data);
+	v = __builtin_select(v < lo, lo, v);
+	v = __builtin_select(v > hi, hi, v);
+	store4(data, v);
+}
+
+void reverse4(int* data)
+{
+	int4 v = load4(data);
+	store4(data, __builtin_shufflevector(v, v, 3, 2, 1, 0));
+}
+
+void interleave(int* a, int* b, int* out)
+{
+	int8 v = __builtin_shufflevector(load4(a), load4(b), 0, 4, 1, 5, 2, 6, 3, 7);
+	for (int i = 0; i < 8; i = i + 1)
+		out[i] = v[i];
+}
+
+int spread4(int* data)
+{
+	int4 v = load4(data);
+	return __builtin_reduce_max(v) - __builtin_reduce_min(v);
+}
+
+unsigned umax4(unsigned* data)
+{
+	unsigned4 v;
+	for (int i = 0; i < 4; i = i + 1)
+		v[i] = data[i];
+	return __builtin_reduce_max(v);
+}
+
+int fold4(int* data)
+{
+	int4 v = load4(data);
+	return __builtin_reduce_mul(v) + __builtin_reduce_or(v)
+		- __builtin_reduce_and(v) + __builtin_reduce_xor(v);
+}
+
+int negate_zero(int* data)
+{
+	int4 v = load4(data);
+	// !v中为0的通道得到-1
+	return __builtin_reduce_add(-v + !v);
+}
+
+int add_bias(int x)
+{
+	int4 v = __builtin_splat(x, 4) + bias;
+	bias[1] = x;
+	return __builtin_reduce_add(v) + bias[1] + bias[0];
+}
@@ -1,3 +1,5 @@
+#include <chrono>
+#include <print>
 #include <gtest/gtest.h>
 #include <llvm/IR/LLVMContext.h>
 #include <llvm/IR/DerivedTypes.h>
@@ -164,4 +166,217 @@ TEST_F(ConversionHelperTest, I2IValueConversion)
     EXPECT_EQ(narrowing_fail.status, ConversionStatus::failure);
 }
 
+TEST_F(ConversionHelperTest, TypeIdValueConversion)
+{
+	auto same_type = helper->value_conversion(TypeId::ty_sint, TypeId::ty_sint);
+	EXPECT_EQ(same_type.status, ConversionStatus::success);
+	EXPECT_EQ(same_type.result_id, TypeId::ty_sint);
+
+	config->sign_to_unsign_same_width_status = ConversionStatus::warning;
+	config->int_narrowing_status = ConversionStatus::failure;
+	helper->reload_config();
+
+	// llvm::Type无法区分的有无符号转换
+	auto sign_to_unsign =
+		helper->value_conversion(TypeId::ty_uint, TypeId::ty_sint);
+	EXPECT_EQ(sign_to_unsign.status, ConversionStatus::warning);
+	EXPECT_EQ(sign_to_unsign.ec,
+			  utils::conversion_error::sign_to_unsign_same_width);
+	EXPECT_EQ(sign_to_unsign.result_id, TypeId::ty_uint);
+
+	auto unsign_to_sign =
+		helper->value_conversion(TypeId::ty_sint, TypeId::ty_uint);
+	EXPECT_EQ(unsign_to_sign.status, ConversionStatus::success);
+	EXPECT_EQ(unsign_to_sign.ec,
+			  utils::conversion_error::unsign_to_sign_same_width);
+
+	auto narrowing = helper->value_conversion(TypeId::ty_sshort, TypeId::ty_sint);
+	EXPECT_EQ(narrowing.status, ConversionStatus::failure);
+	EXPECT_EQ(narrowing.result_id, TypeId::ty_void);
+
+	auto to_bool = helper->value_conversion(TypeId::ty_bool, TypeId::ty_sint);
+	EXPECT_EQ(to_bool.ec, utils::conversion_error::bool_cvt);
+
+	auto from_void = helper->value_conversion(TypeId::ty_sint, TypeId::ty_void);
+	EXPECT_EQ(from_void.status, ConversionStatus::failure);
+	EXPECT_EQ(from_void.ec, utils::conversion_error::unsupport_cvt);
+
+	// 派生类型不在转换表中
+	auto derived = helper->value_conversion(TypeId::builtin_end, TypeId::ty_sint);
+	EXPECT_EQ(derived.status, ConversionStatus::failure);
+	EXPECT_EQ(derived.ec, utils::conversion_error::unsupport_cvt);
+}
+
+TEST_F(ConversionHelperTest, TypeIdArithmeticConversion)
+{
+	auto expect_common = [&](TypeId left, TypeId right, TypeId common) {
+		EXPECT_EQ(helper->arithmetic_conversion(left, right).result_id, common);
+		EXPECT_EQ(helper->arithmetic_conversion(right, left).result_id, common);
+	};
+
+	// 整数提升
+	expect_common(TypeId::ty_schar, TypeId::ty_sshort, TypeId::ty_sint);
+	expect_common(TypeId::ty_bool, TypeId::ty_uchar, TypeId::ty_sint);
+	// 同等级时转换为无符号数
+	expect_common(TypeId::ty_sint, TypeId::ty_uint, TypeId::ty_uint);
+	expect_common(TypeId::ty_uint, TypeId::ty_slong_long,
+				  TypeId::ty_slong_long);
+	expect_common(TypeId::ty_slong_long, TypeId::ty_ulong,
+				  TypeId::ty_ulong_long);
+	expect_common(TypeId::ty_slong, TypeId::ty_uint, TypeId::ty_slong);
+	expect_common(TypeId::ty_sint, TypeId::ty_float, TypeId::ty_float);
+	expect_common(TypeId::ty_float, TypeId::ty_double, TypeId::ty_double);
+
+	auto same_type = helper->arithmetic_conversion(TypeId::ty_sint,
+												   TypeId::ty_sint);
+	EXPECT_EQ(same_type.ec, utils::conversion_error::none);
+
+	config->int_promotion_status = ConversionStatus::failure;
+	helper->reload_config();
+	auto promotion = helper->arithmetic_conversion(TypeId::ty_sint,
+												   TypeId::ty_uint);
+	EXPECT_EQ(promotion.status, ConversionStatus::failure);
+	EXPECT_EQ(promotion.ec, utils::conversion_error::int_promotion);
+}
+
+TEST_F(ConversionHelperTest, LongWidthFollowsTarget)
+{
+	ConversionHelper helper32 { config, context, 32 };
+	// long与unsigned int同宽, 无法表示其所有值
+	EXPECT_EQ(helper32.arithmetic_conversion(TypeId::ty_slong,
+											 TypeId::ty_uint).result_id,
+			  TypeId::ty_ulong);
+	EXPECT_EQ(helper32.value_conversion(TypeId::ty_slong,
+										TypeId::ty_sint).ec,
+			  utils::conversion_error::none);
+	EXPECT_EQ(helper->value_conversion(TypeId::ty_slong, TypeId::ty_sint).ec,
+			  utils::conversion_error::int_promotion);
+}
+
+TEST_F(ConversionHelperTest, TableIsBuiltOncePerConfig)
+{
+	config->int_promotion_status = ConversionStatus::failure;
+	EXPECT_EQ(helper->value_conversion(TypeId::ty_slong_long,
+									   TypeId::ty_sint).status,
+			  ConversionStatus::success);
 
+	helper->reload_config();
+	EXPECT_EQ(helper->value_conversion(TypeId::ty_slong_long,
+									   TypeId::ty_sint).status,
+			  ConversionStatus::failure);
+}
+
+TEST_F(ConversionHelperTest, RangeAwareValueConversion)
+{
+	config->int_narrowing_status = ConversionStatus::warning;
+	config->sign_to_unsign_same_width_status = ConversionStatus::failure;
+	config->unsign_to_sign_same_width_status = ConversionStatus::warning;
+	config->float2int_cvt_status = ConversionStatus::warning;
+	config->bool_cvt_status = ConversionStatus::failure;
+	helper->reload_config();
+
+	auto single = [](std::int64_t value) {
+		return llvm::ConstantRange {
+			llvm::APInt(32, static_cast<std::uint64_t>(value), true) };
+	};
+	auto make_range = [](std::int64_t lower, std::int64_t upper) {
+		return llvm::ConstantRange {
+			llvm::APInt(32, static_cast<std::uint64_t>(lower), true),
+			llvm::APInt(32, static_cast<std::uint64_t>(upper), true) };
+	};
+
+	// char c = 10;
+	auto char_ok = helper->value_conversion(TypeId::ty_schar, TypeId::ty_sint,
+											single(10));
+	EXPECT_EQ(char_ok.status, ConversionStatus::success);
+	EXPECT_EQ(char_ok.ec, utils::conversion_error::none);
+	EXPECT_EQ(char_ok.result_id, TypeId::ty_schar);
+
+	auto char_overflow = helper->value_conversion(
+		TypeId::ty_schar, TypeId::ty_sint, single(200));
+	EXPECT_EQ(char_overflow.status, ConversionStatus::warning);
+	EXPECT_EQ(char_overflow.ec, utils::conversion_error::int_narrowing);
+
+	// unsigned x = 5;
+	auto unsigned_ok = helper->value_conversion(
+		TypeId::ty_uint, TypeId::ty_sint, single(5));
+	EXPECT_EQ(unsigned_ok.status, ConversionStatus::success);
+	auto unsigned_negative = helper->value_conversion(
+		TypeId::ty_uint, TypeId::ty_sint, single(-1));
+	EXPECT_EQ(unsigned_negative.status, ConversionStatus::failure);
+
+	// x % 16的范围
+	auto mod_range = helper->value_conversion(
+		TypeId::ty_uchar, TypeId::ty_sint, make_range(0, 16));
+	EXPECT_EQ(mod_range.status, ConversionStatus::success);
+	auto signed_mod_range = helper->value_conversion(
+		TypeId::ty_uchar, TypeId::ty_sint, make_range(-15, 16));
+	EXPECT_EQ(signed_mod_range.status, ConversionStatus::warning);
+
+	// 无符号数按无符号解释: 0xFFFFFFFF不能由int表示
+	auto large_unsigned = helper->value_conversion(
+		TypeId::ty_sint, TypeId::ty_uint, single(-1));
+	EXPECT_EQ(large_unsigned.status, ConversionStatus::warning);
+	auto small_unsigned = helper->value_conversion(
+		TypeId::ty_sint, TypeId::ty_uint, make_range(0, 100));
+	EXPECT_EQ(small_unsigned.status, ConversionStatus::success);
+
+	// 比较结果转换为_Bool
+	auto to_bool = helper->value_conversion(TypeId::ty_bool, TypeId::ty_sint,
+											make_range(0, 2));
+	EXPECT_EQ(to_bool.status, ConversionStatus::success);
+	auto int_to_bool = helper->value_conversion(
+		TypeId::ty_bool, TypeId::ty_sint, make_range(0, 3));
+	EXPECT_EQ(int_to_bool.status, ConversionStatus::failure);
+
+	auto exact_float = helper->value_conversion(
+		TypeId::ty_float, TypeId::ty_sint, single(1 << 24));
+	EXPECT_EQ(exact_float.status, ConversionStatus::success);
+	auto inexact_float = helper->value_conversion(
+		TypeId::ty_float, TypeId::ty_sint, single((1 << 24) + 1));
+	EXPECT_EQ(inexact_float.status, ConversionStatus::warning);
+
+	auto full = helper->value_conversion(TypeId::ty_schar, TypeId::ty_sint,
+										 llvm::ConstantRange::getFull(32));
+	EXPECT_EQ(full.status, ConversionStatus::warning);
+}
+
+/**
+ * 转换表与逐次比较llvm::Type的查询吞吐量
+ * 查询类型对在内建整数类型之间循环
+ */
+TEST_F(ConversionHelperTest, ConversionThroughput)
+{
+	constexpr int lookups = 1 << 22;
+	std::array int_ids { TypeId::ty_schar, TypeId::ty_sshort, TypeId::ty_sint,
+						 TypeId::ty_uint, TypeId::ty_slong_long };
+	std::array<llvm::Type*, int_ids.size()> int_types {
+		llvm::Type::getInt8Ty(context), llvm::Type::getInt16Ty(context),
+		llvm::Type::getInt32Ty(context), llvm::Type::getInt32Ty(context),
+		llvm::Type::getInt64Ty(context),
+	};
+
+	auto measure = [&](const char* name, auto&& lookup) {
+		std::size_t success = 0;
+		auto begin = std::chrono::steady_clock::now();
+		for (int i = 0; i < lookups; ++i)
+		{
+			auto left = static_cast<std::size_t>(i) % int_ids.size();
+			auto right = static_cast<std::size_t>(i / 7) % int_ids.size();
+			success += lookup(left, right).status != ConversionStatus::failure;
+		}
+		auto end = std::chrono::steady_clock::now();
+
+		std::chrono::duration<double> seconds = end - begin;
+		std::println("[ throughput ] {:>10}: {:.2f} Mconversions/s", name,
+					 lookups / seconds.count() / 1e6);
+		EXPECT_EQ(success, static_cast<std::size_t>(lookups));
+	};
+
+	measure("table", [&](std::size_t left, std::size_t right) {
+		return helper->value_conversion(int_ids[left], int_ids[right]);
+	});
+	measure("llvm::Type", [&](std::size_t left, std::size_t right) {
+		return helper->value_conversion(int_types[left], int_types[right]);
+	});
+}
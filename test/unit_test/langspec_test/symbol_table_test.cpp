@@ -1,4 +1,7 @@
 #include <gtest/gtest.h>
+#include <chrono>
+#include <print>
+#include <thread>
 #include <llvm/IR/Function.h>
 #include <llvm/IR/Module.h>
 #include <llvm/IR/IRBuilder.h>
@@ -45,6 +48,129 @@ TEST(GlobalSymbolTableTest, InsertAndFind)
     EXPECT_EQ(foundEntry4, evalEntry); // 仍应返回第一次插入的条目
 }
 
+TEST(GlobalSymbolTableTest, FreezeKeepsEntries)
+{
+	GlobalSymbolTable gtable;
+	vector<string> names;
+	for (int i = 0; i < 100; ++i)
+		names.push_back("symbol_" + to_string(i));
+
+	vector<llvm::Value*> dummy_values;
+	for (int i = 0; i < 100; ++i)
+	{
+		dummy_values.push_back(reinterpret_cast<llvm::Value*>(0x1000 + i * 8));
+		auto entry = std::make_shared<SymbolEntry>(SymbolEntry::func_value,
+												   dummy_values.back());
+		ASSERT_TRUE(gtable.insert(names[i], entry));
+	}
+
+	EXPECT_FALSE(gtable.is_frozen());
+	gtable.freeze();
+	EXPECT_TRUE(gtable.is_frozen());
+	EXPECT_EQ(gtable.size(), names.size());
+
+	for (int i = 0; i < 100; ++i)
+	{
+		auto entry = gtable.find(names[i]);
+		ASSERT_NE(entry, nullptr);
+		EXPECT_EQ(entry->value, dummy_values[i]);
+		EXPECT_EQ(gtable.find_ptr(names[i]), entry.get());
+	}
+
+	EXPECT_EQ(gtable.find("symbol_100"), nullptr);
+	EXPECT_EQ(gtable.find_ptr(""), nullptr);
+
+	// 冻结之后不能继续插入
+	auto late = std::make_shared<SymbolEntry>(SymbolEntry::func_value, nullptr);
+	EXPECT_FALSE(gtable.insert("late_symbol", late));
+	EXPECT_EQ(gtable.find("late_symbol"), nullptr);
+}
+
+TEST(GlobalSymbolTableTest, ConcurrentInsertBeforeFreeze)
+{
+	GlobalSymbolTable gtable;
+	constexpr int thread_count = 4;
+	constexpr int per_thread = 256;
+
+	vector<string> names;
+	for (int i = 0; i < thread_count * per_thread; ++i)
+		names.push_back("f" + to_string(i));
+
+	{
+		vector<jthread> threads;
+		for (int t = 0; t < thread_count; ++t)
+		{
+			threads.emplace_back([&, t] {
+				for (int i = t * per_thread; i < (t + 1) * per_thread; ++i)
+				{
+					auto entry = std::make_shared<SymbolEntry>(
+						SymbolEntry::func_value, nullptr);
+					EXPECT_TRUE(gtable.insert(names[i], entry));
+				}
+			});
+		}
+	}
+
+	gtable.freeze();
+	EXPECT_EQ(gtable.size(), names.size());
+	for (const auto& name : names)
+		EXPECT_NE(gtable.find_ptr(name), nullptr);
+}
+
+/**
+ * 冻结后的查询吞吐量随线程数的变化
+ * 每个线程查询相同次数, 吞吐量 = 总查询次数 / 墙钟时间
+ */
+TEST(GlobalSymbolTableTest, FrozenLookupThroughput)
+{
+	constexpr int symbol_count = 4096;
+	constexpr int lookups_per_thread = 1 << 21;
+
+	GlobalSymbolTable gtable;
+	vector<string> names;
+	for (int i = 0; i < symbol_count; ++i)
+		names.push_back("function_name_" + to_string(i));
+	for (const auto& name : names)
+	{
+		auto entry = std::make_shared<SymbolEntry>(SymbolEntry::func_value,
+												   nullptr);
+		gtable.insert(name, entry);
+	}
+	gtable.freeze();
+
+	unsigned max_threads = std::max(1u, std::thread::hardware_concurrency());
+	for (unsigned thread_count = 1; thread_count <= std::min(max_threads, 16u);
+		 thread_count *= 2)
+	{
+		std::atomic<std::size_t> found { 0 };
+		auto begin = std::chrono::steady_clock::now();
+		{
+			vector<jthread> threads;
+			for (unsigned t = 0; t < thread_count; ++t)
+			{
+				threads.emplace_back([&, t] {
+					std::size_t local_found = 0;
+					std::size_t pos = t * 7919;
+					for (int i = 0; i < lookups_per_thread; ++i)
+					{
+						pos = (pos + 2654435761u) % symbol_count;
+						local_found += gtable.find_ptr(names[pos]) != nullptr;
+					}
+					found += local_found;
+				});
+			}
+		}
+		auto end = std::chrono::steady_clock::now();
+
+		std::chrono::duration<double> seconds = end - begin;
+		auto total = static_cast<double>(lookups_per_thread) * thread_count;
+		std::println("[ throughput ] threads: {:2}, lookups: {:.0f}, "
+					 "{:.2f} Mlookups/s",
+					 thread_count, total, total / seconds.count() / 1e6);
+		EXPECT_EQ(found.load(), static_cast<std::size_t>(total));
+	}
+}
+
 class LocalSymbolTableTest: public ::testing::Test
 {
 protected:
@@ -0,0 +1,138 @@
+#include <gtest/gtest.h>
+#include <llvm/IR/DataLayout.h>
+#include <llvm/IR/DerivedTypes.h>
+#include <llvm/IR/LLVMContext.h>
+#include "type_mgr.hpp"
+
+using namespace toycc;
+
+namespace
+{
+
+constexpr const char* data_layout_64 =
+	"e-m:e-p270:32:32-p271:32:32-p272:64:64-i64:64-f80:128-n8:16:32:64-S128";
+constexpr const char* data_layout_32 =
+	"e-m:e-p:32:32-p270:32:32-p271:32:32-p272:64:64-f64:32:64-f80:32-n8:16:32-S128";
+
+}	//namespace
+
+TEST(TypeMgrTest, BuiltinTypes)
+{
+	llvm::LLVMContext context;
+	TypeMgr type_mgr { context, llvm::DataLayout { data_layout_64 } };
+
+	EXPECT_TRUE(type_mgr.is_signed(TypeId::ty_sint));
+	EXPECT_FALSE(type_mgr.is_signed(TypeId::ty_uint));
+	EXPECT_TRUE(type_mgr.is_integer(TypeId::ty_uint));
+	EXPECT_TRUE(type_mgr.is_floating(TypeId::ty_double));
+	EXPECT_EQ(type_mgr.get_name(TypeId::ty_uint), "unsigned int");
+
+	// 有无符号的类型编号不同, 对应同一个llvm类型
+	EXPECT_NE(TypeId::ty_sint, TypeId::ty_uint);
+	EXPECT_EQ(type_mgr.get_llvm_type(TypeId::ty_sint),
+			  type_mgr.get_llvm_type(TypeId::ty_uint));
+	EXPECT_TRUE(type_mgr.get_llvm_type(TypeId::ty_sint)->isIntegerTy(32));
+
+	EXPECT_TRUE(type_mgr.get_double()->isDoubleTy());
+	EXPECT_TRUE(type_mgr.get_float()->isFloatTy());
+}
+
+TEST(TypeMgrTest, LongWidthFollowsTarget)
+{
+	llvm::LLVMContext context;
+	TypeMgr type_mgr_64 { context, llvm::DataLayout { data_layout_64 } };
+	TypeMgr type_mgr_32 { context, llvm::DataLayout { data_layout_32 } };
+
+	EXPECT_EQ(type_mgr_64.get_info(TypeId::ty_slong).bit_width, 64u);
+	EXPECT_EQ(type_mgr_32.get_info(TypeId::ty_ulong).bit_width, 32u);
+	EXPECT_TRUE(type_mgr_64.get_signed_long()->isIntegerTy(64));
+	EXPECT_TRUE(type_mgr_32.get_signed_long()->isIntegerTy(32));
+}
+
+TEST(TypeMgrTest, DerivedTypesAreInterned)
+{
+	llvm::LLVMContext context;
+	TypeMgr type_mgr { context, llvm::DataLayout { data_layout_64 } };
+
+	auto int_ptr = type_mgr.get_pointer(TypeId::ty_sint);
+	EXPECT_FALSE(is_builtin(int_ptr));
+	EXPECT_EQ(type_mgr.get_pointer(TypeId::ty_sint), int_ptr);
+	EXPECT_NE(type_mgr.get_pointer(TypeId::ty_uint), int_ptr);
+	EXPECT_EQ(type_mgr.get_info(int_ptr).element, TypeId::ty_sint);
+	EXPECT_EQ(type_mgr.get_name(int_ptr), "int*");
+
+	auto array = type_mgr.get_array(TypeId::ty_uint, 4);
+	EXPECT_EQ(type_mgr.get_array(TypeId::ty_uint, 4), array);
+	EXPECT_NE(type_mgr.get_array(TypeId::ty_uint, 5), array);
+	EXPECT_EQ(type_mgr.get_name(array), "unsigned int[4]");
+
+	auto llvm_array = type_mgr.get_llvm_type(array);
+	ASSERT_TRUE(llvm_array->isArrayTy());
+	EXPECT_EQ(llvm_array->getArrayNumElements(), 4u);
+	EXPECT_TRUE(type_mgr.get_llvm_type(int_ptr)->isPointerTy());
+}
+
+TEST(TypeMgrTest, VectorTypes)
+{
+	llvm::LLVMContext context;
+	TypeMgr type_mgr { context, llvm::DataLayout { data_layout_64 } };
+
+	auto int4 = type_mgr.get_vector(TypeId::ty_sint, 4);
+	auto unsigned8 = type_mgr.get_vector(TypeId::ty_uint, 8);
+	EXPECT_EQ(type_mgr.get_vector(TypeId::ty_sint, 4), int4);
+	EXPECT_NE(type_mgr.get_array(TypeId::ty_sint, 4), int4);
+	EXPECT_TRUE(type_mgr.is_vector(int4));
+	EXPECT_TRUE(type_mgr.is_signed(int4));
+	EXPECT_FALSE(type_mgr.is_signed(unsigned8));
+	EXPECT_EQ(type_mgr.get_name(int4), "int4");
+	EXPECT_EQ(type_mgr.get_name(unsigned8), "unsigned8");
+
+	auto llvm_vector = llvm::dyn_cast<llvm::FixedVectorType>(
+		type_mgr.get_llvm_type(unsigned8));
+	ASSERT_NE(llvm_vector, nullptr);
+	EXPECT_EQ(llvm_vector->getNumElements(), 8u);
+	EXPECT_TRUE(llvm_vector->getElementType()->isIntegerTy(32));
+}
+
+TEST(TypeMgrTest, StructLayout)
+{
+	llvm::LLVMContext context;
+	TypeMgr type_mgr { context, llvm::DataLayout { data_layout_64 } };
+
+	auto make_fields = [&](TypeId self) {
+		return std::vector<StructField> {
+			{ .name = "flag", .type = TypeId::ty_bool },
+			{ .name = "next", .type = type_mgr.get_pointer(self) },
+			{ .name = "key", .type = TypeId::ty_sint },
+		};
+	};
+
+	auto plain = type_mgr.create_struct("plain");
+	EXPECT_FALSE(type_mgr.is_complete(plain));
+	EXPECT_EQ(type_mgr.find_struct("plain"), plain);
+	EXPECT_EQ(type_mgr.find_struct("other"), std::nullopt);
+	type_mgr.set_struct_body(plain, make_fields(plain), false, false);
+	EXPECT_TRUE(type_mgr.is_complete(plain));
+	EXPECT_EQ(type_mgr.get_name(plain), "struct plain");
+	EXPECT_EQ(type_mgr.find_field(plain, "next")->offset, 8u);
+	EXPECT_EQ(type_mgr.find_field(plain, "key")->offset, 16u);
+	EXPECT_EQ(type_mgr.find_field(plain, "none"), nullptr);
+	EXPECT_NE(type_mgr.format_struct_layout(plain).find("holes: 7 bytes"),
+			  std::string::npos);
+
+	// 按对齐重排后只剩结尾的填充
+	auto reordered = type_mgr.create_struct("reordered");
+	type_mgr.set_struct_body(reordered, make_fields(reordered), false, true);
+	EXPECT_EQ(type_mgr.find_field(reordered, "next")->index, 0u);
+	EXPECT_EQ(type_mgr.find_field(reordered, "key")->offset, 8u);
+	EXPECT_EQ(type_mgr.find_field(reordered, "flag")->offset, 12u);
+	EXPECT_EQ(type_mgr.get_data_layout().getTypeAllocSize(
+				  type_mgr.get_llvm_type(reordered)), 16u);
+
+	auto packed = type_mgr.create_struct("packed");
+	type_mgr.set_struct_body(packed, make_fields(packed), true, false);
+	EXPECT_EQ(type_mgr.find_field(packed, "key")->offset, 9u);
+	EXPECT_EQ(type_mgr.get_data_layout().getTypeAllocSize(
+				  type_mgr.get_llvm_type(packed)), 13u);
+	EXPECT_EQ(type_mgr.get_struct_types().size(), 3u);
+}
@@ -0,0 +1,860 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <format>
+#include <optional>
+#include <regex>
+#include <string_view>
+#include <vector>
+#include "toycc.h"
+#include "toycc.hpp"
+
+using namespace toycc;
+
+namespace
+{
+
+constexpr std::string_view good_source =
+	"int add(int a, int b)\n"
+	"{\n"
+	"\treturn a + b;\n"
+	"}\n";
+
+constexpr std::string_view bad_source =
+	"int f()\n"
+	"{\n"
+	"\treturn undefined_a;\n"
+	"}\n";
+
+/// @brief 以LLVM IR输出编译source
+auto compile_ir(std::string_view source, CompileOptions options = {})
+	-> CompileResult
+{
+	options.output = OutputKind::llvm_ir;
+	return compile(source, "test.c", options);
+}
+
+/// @return IR中全局变量name的整数初始值, 不是整数常量时返回std::nullopt
+auto get_global_int(std::string_view ir, std::string_view name)
+	-> std::optional<std::int64_t>
+{
+	std::regex pattern {
+		std::format(R"(@{} = (?:dso_local )?global i\d+ (-?\d+))", name) };
+	std::match_results<std::string_view::const_iterator> match;
+	if (!std::regex_search(ir.begin(), ir.end(), match, pattern))
+		return std::nullopt;
+	return std::stoll(match[1].str());
+}
+
+}	//namespace
+
+TEST(LibToyccTest, CompileToIRInMemory)
+{
+	CompileOptions options;
+	options.output = OutputKind::llvm_ir;
+
+	auto result = compile(good_source, "good.c", options);
+	ASSERT_TRUE(result.success);
+	EXPECT_TRUE(result.diagnostics.empty());
+	EXPECT_NE(result.output.find("define i32 @add"), std::string::npos);
+}
+
+TEST(LibToyccTest, CompileToObjectInMemory)
+{
+	auto result = compile(good_source, "good.c", CompileOptions {});
+	ASSERT_TRUE(result.success);
+	EXPECT_FALSE(result.output.empty());
+}
+
+TEST(LibToyccTest, StructuredDiagnostics)
+{
+	auto result = compile(bad_source, "bad.c", CompileOptions {});
+	EXPECT_FALSE(result.success);
+	EXPECT_TRUE(result.output.empty());
+	ASSERT_FALSE(result.diagnostics.empty());
+
+	const auto& diag = result.diagnostics.front();
+	EXPECT_EQ(diag.kind, Diagnostic::error);
+	EXPECT_EQ(diag.file, "bad.c");
+	EXPECT_EQ(diag.line, 3);
+	EXPECT_EQ(diag.column, 9);
+	EXPECT_NE(diag.message.find("undefined_a"), std::string::npos);
+	EXPECT_NE(diag.rendered.find("bad.c:3:9"), std::string::npos);
+}
+
+TEST(LibToyccTest, ParallelOutputMatchesSerial)
+{
+	CompileOptions options;
+	options.output = OutputKind::llvm_ir;
+	auto serial = compile(good_source, "good.c", options);
+
+	options.codegen_threads = 4;
+	options.codegen_job_size = 1;
+	auto parallel = compile(good_source, "good.c", options);
+
+	ASSERT_TRUE(serial.success);
+	ASSERT_TRUE(parallel.success);
+	EXPECT_EQ(serial.output, parallel.output);
+}
+
+TEST(LibToyccTest, ParallelDeclarationWarningsReportedOnce)
+{
+	// 每个任务都重复声明阶段, 其中的警告只由主线程报告
+	constexpr std::string_view source =
+		"struct s { int a __attribute__((hot)); } __attribute__((cold));\n"
+		"int g __attribute__((used));\n"
+		"int f1() { return 1; }\n"
+		"int f2() { return 2; }\n"
+		"int f3() { return 3; }\n";
+
+	CompileOptions options;
+	options.codegen_threads = 4;
+	options.codegen_job_size = 1;
+
+	auto result = compile_ir(source, options);
+	ASSERT_TRUE(result.success);
+	ASSERT_EQ(result.diagnostics.size(), 3);
+	for (const auto& diag : result.diagnostics)
+		EXPECT_EQ(diag.kind, Diagnostic::warning);
+	EXPECT_EQ(result.diagnostics[0].line, 1);
+	EXPECT_EQ(result.diagnostics[1].line, 1);
+	EXPECT_EQ(result.diagnostics[2].line, 2);
+}
+
+TEST(LibToyccTest, CApi)
+{
+	toycc_options options;
+	toycc_options_init(&options);
+	options.output = TOYCC_OUTPUT_LLVM_IR;
+
+	auto good = toycc_compile(good_source.data(), good_source.size(),
+							  "good.c", &options);
+	EXPECT_EQ(toycc_result_success(good), 1);
+	size_t size = 0;
+	auto output = toycc_result_output(good, &size);
+	EXPECT_NE(std::string_view(output, size).find("@add"),
+			  std::string_view::npos);
+	toycc_result_free(good);
+
+	auto bad = toycc_compile(bad_source.data(), bad_source.size(), "bad.c",
+							 nullptr);
+	EXPECT_EQ(toycc_result_success(bad), 0);
+	ASSERT_GT(toycc_result_diag_count(bad), 0);
+	EXPECT_EQ(toycc_result_diag_kind(bad, 0), TOYCC_DIAG_ERROR);
+	EXPECT_EQ(toycc_result_diag_line(bad, 0), 3);
+	toycc_result_free(bad);
+}
+
+TEST(LibToyccTest, DirectSSA)
+{
+	constexpr std::string_view source =
+		"int count(int n)\n"
+		"{\n"
+		"\tint result = 0;\n"
+		"\twhile (n > 0)\n"
+		"\t{\n"
+		"\t\tresult = result + 1;\n"
+		"\t\tn = n - 1;\n"
+		"\t}\n"
+		"\treturn result;\n"
+		"}\n";
+
+	CompileOptions options;
+	options.direct_ssa = true;
+
+	auto result = compile_ir(source, options);
+	ASSERT_TRUE(result.success);
+	EXPECT_EQ(result.output.find("alloca"), std::string::npos);
+	EXPECT_EQ(result.output.find("load"), std::string::npos);
+	EXPECT_NE(result.output.find("phi i32"), std::string::npos);
+}
+
+TEST(LibToyccTest, AllocasInEntryBlock)
+{
+	constexpr std::string_view source =
+		"int sum(int n)\n"
+		"{\n"
+		"\tint result = 0;\n"
+		"\twhile (n > 0)\n"
+		"\t{\n"
+		"\t\tint step = n;\n"
+		"\t\t{\n"
+		"\t\t\tint twice = step + step;\n"
+		"\t\t\tresult = result + twice;\n"
+		"\t\t}\n"
+		"\t\tn = n - 1;\n"
+		"\t}\n"
+		"\treturn result;\n"
+		"}\n";
+
+	auto result = compile_ir(source);
+	ASSERT_TRUE(result.success);
+
+	// 入口块在第一条跳转指令处结束
+	auto entry_end = result.output.find("br ");
+	ASSERT_NE(entry_end, std::string::npos);
+	EXPECT_EQ(result.output.find("alloca", entry_end), std::string::npos);
+	EXPECT_NE(result.output.find("%twice = alloca"), std::string::npos);
+	EXPECT_EQ(result.output.find("allocapt"), std::string::npos);
+}
+
+TEST(LibToyccTest, LifetimeMarkers)
+{
+	constexpr std::string_view source =
+		"int f(int n)\n"
+		"{\n"
+		"\tint result = 0;\n"
+		"\tif (n > 0)\n"
+		"\t{\n"
+		"\t\tint a = n + 1;\n"
+		"\t\tresult = a;\n"
+		"\t}\n"
+		"\telse\n"
+		"\t{\n"
+		"\t\tint b = n - 1;\n"
+		"\t\tresult = b;\n"
+		"\t}\n"
+		"\treturn result;\n"
+		"}\n";
+
+	auto result = compile_ir(source);
+	ASSERT_TRUE(result.success);
+
+	EXPECT_NE(result.output.find("call void @llvm.lifetime.start.p0(i64 4, ptr %a)"),
+			  std::string::npos);
+	EXPECT_NE(result.output.find("call void @llvm.lifetime.end.p0(i64 4, ptr %a)"),
+			  std::string::npos);
+	EXPECT_NE(result.output.find("call void @llvm.lifetime.end.p0(i64 4, ptr %b)"),
+			  std::string::npos);
+	// 函数作用域的变量不需要结束
+	EXPECT_EQ(result.output.find("@llvm.lifetime.end.p0(i64 4, ptr %result)"),
+			  std::string::npos);
+}
+
+TEST(LibToyccTest, LazyBoolean)
+{
+	constexpr std::string_view source =
+		"int f(int a, int b)\n"
+		"{\n"
+		"\tif (a < b)\n"
+		"\t\treturn 1;\n"
+		"\twhile (a)\n"
+		"\t\ta = a - 1;\n"
+		"\treturn 0;\n"
+		"}\n";
+
+	auto result = compile_ir(source);
+	ASSERT_TRUE(result.success);
+
+	// 条件中的比较直接用于跳转, 整数条件只需要一次比较
+	EXPECT_EQ(result.output.find("zext"), std::string::npos);
+	EXPECT_NE(result.output.find("icmp slt i32"), std::string::npos);
+	EXPECT_NE(result.output.find("icmp ne i32"), std::string::npos);
+}
+
+TEST(LibToyccTest, SignednessAwareLowering)
+{
+	constexpr std::string_view source =
+		"unsigned int f(unsigned int a, int b)\n"
+		"{\n"
+		"\tif (a < b)\n"
+		"\t\treturn a / b;\n"
+		"\treturn b / 2 + b * 3;\n"
+		"}\n";
+
+	auto result = compile_ir(source);
+	ASSERT_TRUE(result.success);
+
+	// 混合运算按无符号数处理, 有符号运算带有nsw
+	EXPECT_NE(result.output.find("icmp ult"), std::string::npos);
+	EXPECT_NE(result.output.find("udiv"), std::string::npos);
+	EXPECT_NE(result.output.find("sdiv"), std::string::npos);
+	EXPECT_NE(result.output.find("add nsw"), std::string::npos);
+	EXPECT_NE(result.output.find("mul nsw"), std::string::npos);
+}
+
+TEST(LibToyccTest, ConstantFolding)
+{
+	constexpr std::string_view source =
+		"int f(int a)\n"
+		"{\n"
+		"\tconst int n = 4 * 8 - 2;\n"
+		"\tconst int m = n / 3 + (n > 10);\n"
+		"\treturn a + m * 0 + (1 || a) + !(m - 11);\n"
+		"}\n";
+
+	auto result = compile_ir(source);
+	ASSERT_TRUE(result.success);
+
+	// 常量子表达式和常量短路运算不生成指令
+	EXPECT_EQ(result.output.find("mul"), std::string::npos);
+	EXPECT_EQ(result.output.find("sdiv"), std::string::npos);
+	EXPECT_EQ(result.output.find("icmp"), std::string::npos);
+	EXPECT_EQ(result.output.find("lor_"), std::string::npos);
+	EXPECT_NE(result.output.find("add nsw i32"), std::string::npos);
+}
+
+TEST(LibToyccTest, ConstRequiresConstantExpression)
+{
+	constexpr std::string_view source =
+		"int f(int a)\n"
+		"{\n"
+		"\tconst int c = a + 1;\n"
+		"\treturn c;\n"
+		"}\n";
+
+	auto result = compile_ir(source);
+	EXPECT_FALSE(result.success);
+	ASSERT_FALSE(result.diagnostics.empty());
+	EXPECT_EQ(result.diagnostics.front().line, 3);
+	EXPECT_NE(result.diagnostics.front().message.find("constant expression"),
+			  std::string::npos);
+}
+
+TEST(LibToyccTest, DeadBranchElimination)
+{
+	constexpr std::string_view source =
+		"int f(int a)\n"
+		"{\n"
+		"\tif (0) { a = a * 3; }\n"
+		"\tif (1) a = a + 1; else a = a - 1;\n"
+		"\twhile (0) a = a * 5;\n"
+		"\tif (a > 0 && 0) a = a * 7;\n"
+		"\treturn a;\n"
+		"\ta = a * 9;\n"
+		"}\n"
+		"int g(int a)\n"
+		"{\n"
+		"\twhile (1) { if (a) return a; a = a + 1; }\n"
+		"}\n";
+
+	auto result = compile_ir(source);
+	ASSERT_TRUE(result.success);
+
+	// 条件为常量的分支和return之后的语句不生成代码
+	EXPECT_EQ(result.output.find("mul"), std::string::npos);
+	EXPECT_EQ(result.output.find("else"), std::string::npos);
+	// 死循环只有循环体一个块
+	EXPECT_EQ(result.output.find("while_cond"), std::string::npos);
+	EXPECT_EQ(result.output.find("while_end"), std::string::npos);
+
+	ASSERT_EQ(result.diagnostics.size(), 1);
+	EXPECT_EQ(result.diagnostics.front().kind, Diagnostic::warning);
+	EXPECT_EQ(result.diagnostics.front().line, 8);
+	EXPECT_NE(result.diagnostics.front().message.find("never be executed"),
+			  std::string::npos);
+}
+
+TEST(LibToyccTest, DeadCodeIsChecked)
+{
+	// 静态不可达的代码不生成指令, 但其中的错误仍然报告
+	constexpr std::string_view source =
+		"int f(int a)\n"
+		"{\n"
+		"\tif (0) { undeclared = 1; }\n"
+		"\twhile (0) f(1, 2, 3);\n"
+		"\ta = 0 && nope;\n"
+		"\tif (1 || a) return a;\n"
+		"\treturn missing;\n"
+		"}\n";
+
+	auto result = compile_ir(source);
+	EXPECT_FALSE(result.success);
+	std::vector<unsigned> error_lines;
+	for (const auto& diag : result.diagnostics)
+	{
+		if (diag.kind == Diagnostic::error)
+			error_lines.push_back(diag.line);
+	}
+	EXPECT_EQ(error_lines, (std::vector<unsigned> { 3, 4, 5, 7 }));
+}
+
+TEST(LibToyccTest, RotatedLoops)
+{
+	constexpr std::string_view source =
+		"int f(int n)\n"
+		"{\n"
+		"\tint sum = 0;\n"
+		"\tfor (int i = 0; i < n; i = i + 1)\n"
+		"\t{\n"
+		"\t\tif (i == 5) continue;\n"
+		"\t\tif (sum > 100) break;\n"
+		"\t\tsum = sum + i;\n"
+		"\t}\n"
+		"\tdo sum = sum - 1; while (sum > 50);\n"
+		"\treturn sum;\n"
+		"}\n";
+
+	auto result = compile_ir(source);
+	ASSERT_TRUE(result.success);
+	EXPECT_TRUE(result.diagnostics.empty());
+
+	// guard, preheader, 底部判断条件的latch和专用的exit
+	for (auto name : { "for_ph", "for_body", "for_latch", "for_exit",
+					   "for_end", "do_body", "do_latch", "do_exit" })
+		EXPECT_NE(result.output.find(name), std::string::npos) << name;
+	// do-while没有guard
+	EXPECT_EQ(result.output.find("do_ph"), std::string::npos);
+}
+
+TEST(LibToyccTest, BreakOutsideLoop)
+{
+	constexpr std::string_view source =
+		"int f(int n)\n"
+		"{\n"
+		"\tif (n) break;\n"
+		"\treturn n;\n"
+		"}\n";
+
+	auto result = compile_ir(source);
+	EXPECT_FALSE(result.success);
+	ASSERT_FALSE(result.diagnostics.empty());
+	EXPECT_EQ(result.diagnostics.front().line, 3);
+	EXPECT_NE(result.diagnostics.front().message.find("not in loop"),
+			  std::string::npos);
+}
+
+TEST(LibToyccTest, LoopHintMetadata)
+{
+	constexpr std::string_view source =
+		"int f(int n)\n"
+		"{\n"
+		"\tint sum = 0;\n"
+		"#pragma toycc unroll(4) vectorize(enable)\n"
+		"#pragma toycc interleave(2)\n"
+		"\tfor (int i = 0; i < n; i = i + 1)\n"
+		"\t\tsum = sum + i;\n"
+		"\treturn sum;\n"
+		"}\n";
+
+	auto result = compile_ir(source);
+	ASSERT_TRUE(result.success);
+	EXPECT_TRUE(result.diagnostics.empty());
+
+	EXPECT_NE(result.output.find("!llvm.loop"), std::string::npos);
+	EXPECT_NE(result.output.find("!\"llvm.loop.unroll.count\", i32 4"),
+			  std::string::npos);
+	EXPECT_NE(result.output.find("!\"llvm.loop.vectorize.enable\", i1 true"),
+			  std::string::npos);
+	EXPECT_NE(result.output.find("!\"llvm.loop.interleave.count\", i32 2"),
+			  std::string::npos);
+}
+
+TEST(LibToyccTest, InvalidLoopHint)
+{
+	constexpr std::string_view source =
+		"int f(int n)\n"
+		"{\n"
+		"#pragma toycc pipeline(2)\n"
+		"\twhile (n > 0) n = n - 1;\n"
+		"#pragma toycc vectorize(3)\n"
+		"\twhile (n < 9) n = n + 1;\n"
+		"\treturn n;\n"
+		"}\n";
+
+	auto result = compile_ir(source);
+	EXPECT_FALSE(result.success);
+	ASSERT_EQ(result.diagnostics.size(), 2);
+	EXPECT_EQ(result.diagnostics[0].kind, Diagnostic::warning);
+	EXPECT_EQ(result.diagnostics[0].line, 3);
+	EXPECT_EQ(result.diagnostics[1].kind, Diagnostic::error);
+	EXPECT_EQ(result.diagnostics[1].line, 5);
+}
+
+TEST(LibToyccTest, MissedLoopHintIsReported)
+{
+	// 非线性的循环携带依赖无法向量化
+	constexpr std::string_view source =
+		"int f(int n, int x)\n"
+		"{\n"
+		"#pragma toycc vectorize(enable)\n"
+		"\tfor (int i = 0; i < n; i = i + 1)\n"
+		"\t\tx = x * x + i;\n"
+		"\treturn x;\n"
+		"}\n";
+
+	CompileOptions options;
+	options.opt_level = 2;
+
+	auto result = compile_ir(source, options);
+	ASSERT_TRUE(result.success);
+	ASSERT_FALSE(result.diagnostics.empty());
+	EXPECT_EQ(result.diagnostics.front().kind, Diagnostic::warning);
+	EXPECT_NE(result.diagnostics.front().message.find("loop not vectorized"),
+			  std::string::npos);
+	EXPECT_NE(result.diagnostics.front().message.find("'f'"),
+			  std::string::npos);
+}
+
+TEST(LibToyccTest, SwitchLowering)
+{
+	constexpr std::string_view source =
+		"int f(int n)\n"
+		"{\n"
+		"\tint r = 0;\n"
+		"\tswitch (n)\n"
+		"\t{\n"
+		"\tcase 0: r = 10; break;\n"
+		"\tcase 1:\n"
+		"\tcase 1 + 1: r = 20;\n"
+		"\tdefault: r = r + 1;\n"
+		"\t}\n"
+		"\treturn r;\n"
+		"}\n";
+
+	auto result = compile_ir(source);
+	ASSERT_TRUE(result.success);
+	EXPECT_TRUE(result.diagnostics.empty());
+	// 分发交给后端选择跳转表或二分查找
+	EXPECT_NE(result.output.find("switch i32"), std::string::npos);
+	EXPECT_NE(result.output.find("i32 2, label"), std::string::npos);
+	EXPECT_NE(result.output.find("switch_default"), std::string::npos);
+}
+
+TEST(LibToyccTest, DuplicateCaseValue)
+{
+	constexpr std::string_view source =
+		"int f(int n)\n"
+		"{\n"
+		"\tswitch (n)\n"
+		"\t{\n"
+		"\tcase 4: return 1;\n"
+		"\tcase 2 * 2: return 2;\n"
+		"\t}\n"
+		"\treturn 0;\n"
+		"}\n";
+
+	auto result = compile_ir(source);
+	EXPECT_FALSE(result.success);
+	ASSERT_FALSE(result.diagnostics.empty());
+	EXPECT_EQ(result.diagnostics.front().line, 6);
+	EXPECT_NE(result.diagnostics.front().message.find("Duplicate case value"),
+			  std::string::npos);
+}
+
+TEST(LibToyccTest, ComputedGotoDispatch)
+{
+	constexpr std::string_view source =
+		"int f(int n)\n"
+		"{\n"
+		"\tunsigned int dec = &&on_dec;\n"
+		"\tunsigned int done = &&on_done;\n"
+		"\tif (n <= 0) goto *done;\n"
+		"\tgoto *dec;\n"
+		"on_dec:\n"
+		"\tn = n - 1;\n"
+		"\tif (n > 0) goto *dec;\n"
+		"\tgoto *done;\n"
+		"on_done:\n"
+		"\treturn n;\n"
+		"}\n";
+
+	auto result = compile_ir(source);
+	ASSERT_TRUE(result.success);
+	EXPECT_TRUE(result.diagnostics.empty());
+	// 每个goto *都有独立的indirectbr
+	std::size_t count = 0;
+	for (auto pos = result.output.find("indirectbr");
+		 pos != std::string::npos;
+		 pos = result.output.find("indirectbr", pos + 1))
+		++count;
+	EXPECT_EQ(count, 4);
+	EXPECT_NE(result.output.find("blockaddress(@f, %on_dec)"),
+			  std::string::npos);
+}
+
+TEST(LibToyccTest, UndeclaredLabel)
+{
+	constexpr std::string_view source =
+		"int f(int n)\n"
+		"{\n"
+		"\tif (n) goto out;\n"
+		"\treturn n;\n"
+		"}\n";
+
+	auto result = compile_ir(source);
+	EXPECT_FALSE(result.success);
+	ASSERT_FALSE(result.diagnostics.empty());
+	EXPECT_EQ(result.diagnostics.front().line, 3);
+	EXPECT_NE(result.diagnostics.front().message.find("undeclared label 'out'"),
+			  std::string::npos);
+}
+
+TEST(LibToyccTest, ArrayAccessLowering)
+{
+	constexpr std::string_view source =
+		"int table[64] __attribute__((aligned(64)));\n"
+		"int sum(int rows[][4], int n)\n"
+		"{\n"
+		"\tint s = 0;\n"
+		"\tfor (int i = 0; i < n; i = i + 1)\n"
+		"\t\ts = s + rows[i][3] + table[i];\n"
+		"\treturn s;\n"
+		"}\n";
+
+	auto result = compile_ir(source);
+	ASSERT_TRUE(result.success);
+	EXPECT_TRUE(result.diagnostics.empty());
+	EXPECT_NE(result.output.find("@table = global [64 x i32] zeroinitializer, align 64"),
+			  std::string::npos);
+	EXPECT_NE(result.output.find("getelementptr inbounds [4 x i32]"),
+			  std::string::npos);
+	EXPECT_NE(result.output.find("!tbaa"), std::string::npos);
+	EXPECT_NE(result.output.find("!\"int\""), std::string::npos);
+}
+
+TEST(LibToyccTest, InvalidArrayAlignment)
+{
+	constexpr std::string_view source =
+		"int f()\n"
+		"{\n"
+		"\tint buf[8] __attribute__((aligned(24)));\n"
+		"\tbuf[0] = 1;\n"
+		"\treturn buf[0];\n"
+		"}\n";
+
+	auto result = compile_ir(source);
+	EXPECT_FALSE(result.success);
+	ASSERT_FALSE(result.diagnostics.empty());
+	EXPECT_EQ(result.diagnostics.front().line, 3);
+	EXPECT_NE(result.diagnostics.front().message.find("not a power of 2"),
+			  std::string::npos);
+}
+
+TEST(LibToyccTest, RestrictPointerLowering)
+{
+	constexpr std::string_view source =
+		"void axpy(int* restrict y, int* restrict x, int a, int n)\n"
+		"{\n"
+		"\tfor (int i = 0; i < n; i = i + 1)\n"
+		"\t\ty[i] = y[i] + a * x[i];\n"
+		"}\n"
+		"int swap(int* a, int* b)\n"
+		"{\n"
+		"\tint t = *a;\n"
+		"\t*a = *b;\n"
+		"\t*b = t;\n"
+		"\treturn *a - *b;\n"
+		"}\n";
+
+	auto result = compile_ir(source);
+	ASSERT_TRUE(result.success);
+	EXPECT_TRUE(result.diagnostics.empty());
+	EXPECT_NE(result.output.find("noalias %y"), std::string::npos);
+	EXPECT_NE(result.output.find("noalias %x"), std::string::npos);
+	EXPECT_EQ(result.output.find("noalias %a"), std::string::npos);
+	EXPECT_NE(result.output.find("!alias.scope"), std::string::npos);
+	EXPECT_NE(result.output.find("!noalias"), std::string::npos);
+	EXPECT_NE(result.output.find("!\"axpy: %y\""), std::string::npos);
+}
+
+TEST(LibToyccTest, InvalidIndirection)
+{
+	constexpr std::string_view source =
+		"int f(int n)\n"
+		"{\n"
+		"\tint* p = &n;\n"
+		"\treturn *n + *p;\n"
+		"}\n";
+
+	auto result = compile_ir(source);
+	EXPECT_FALSE(result.success);
+	ASSERT_FALSE(result.diagnostics.empty());
+	EXPECT_EQ(result.diagnostics.front().line, 4);
+	EXPECT_NE(result.diagnostics.front().message.find(
+				  "Indirection requires pointer operand"),
+			  std::string::npos);
+}
+
+TEST(LibToyccTest, VectorLowering)
+{
+	constexpr std::string_view source =
+		"int4 scale(int4 v, int k)\n"
+		"{\n"
+		"\tint4 r = v * k + __builtin_splat(1, 4);\n"
+		"\tr[0] = __builtin_reduce_add(v);\n"
+		"\treturn __builtin_shufflevector(r, v, 3, 2, 5, 4);\n"
+		"}\n"
+		"unsigned max_lane(unsigned8 a, unsigned8 b)\n"
+		"{\n"
+		"\treturn __builtin_reduce_max(__builtin_select(a < b, b, a));\n"
+		"}\n";
+
+	auto result = compile_ir(source);
+	ASSERT_TRUE(result.success);
+	EXPECT_TRUE(result.diagnostics.empty());
+	EXPECT_NE(result.output.find("define <4 x i32> @scale(<4 x i32>"),
+			  std::string::npos);
+	EXPECT_NE(result.output.find("shufflevector"), std::string::npos);
+	EXPECT_NE(result.output.find("insertelement <4 x i32>"), std::string::npos);
+	EXPECT_NE(result.output.find("@llvm.vector.reduce.add.v4i32"),
+			  std::string::npos);
+	EXPECT_NE(result.output.find("@llvm.vector.reduce.umax.v8i32"),
+			  std::string::npos);
+}
+
+TEST(LibToyccTest, VectorCondition)
+{
+	constexpr std::string_view source =
+		"int any(int4 v)\n"
+		"{\n"
+		"\tif (v)\n"
+		"\t\treturn 1;\n"
+		"\treturn 0;\n"
+		"}\n";
+
+	auto result = compile_ir(source);
+	EXPECT_FALSE(result.success);
+	ASSERT_FALSE(result.diagnostics.empty());
+	EXPECT_EQ(result.diagnostics.front().line, 3);
+	EXPECT_NE(result.diagnostics.front().message.find("Cannot convert to bool"),
+			  std::string::npos);
+}
+
+TEST(LibToyccTest, StructLowering)
+{
+	constexpr std::string_view source =
+		"struct pair { int a; int* p; int b; };\n"
+		"struct packed_pair { int a; int* p; } __attribute__((packed));\n"
+		"struct hot { int a; int* p; int b; } __attribute__((reorder));\n"
+		"int sum(struct pair* s, struct hot* h)\n"
+		"{\n"
+		"\tstruct pair local;\n"
+		"\tlocal.a = s->a;\n"
+		"\tlocal.b = h->b;\n"
+		"\treturn local.a + local.b + s->p[1];\n"
+		"}\n";
+
+	CompileOptions options;
+	options.dump_struct_layout = true;
+
+	auto result = compile_ir(source, options);
+	ASSERT_TRUE(result.success);
+	EXPECT_TRUE(result.diagnostics.empty());
+	EXPECT_NE(result.output.find("%struct.pair = type { i32, ptr, i32 }"),
+			  std::string::npos);
+	EXPECT_NE(result.output.find("%struct.packed_pair = type <{ i32, ptr }>"),
+			  std::string::npos);
+	EXPECT_NE(result.output.find("%struct.hot = type { ptr, i32, i32 }"),
+			  std::string::npos);
+	EXPECT_NE(result.output.find("alloca %struct.pair, align 8"),
+			  std::string::npos);
+	EXPECT_NE(result.struct_layout.find("struct pair: size 24, align 8\n"),
+			  std::string::npos);
+	EXPECT_NE(result.struct_layout.find("holes: 4 bytes, padding: 4 bytes"),
+			  std::string::npos);
+	EXPECT_NE(result.struct_layout.find(
+				  "struct hot: size 16, align 8, reordered\n"),
+			  std::string::npos);
+	EXPECT_NE(result.struct_layout.find(
+				  "struct packed_pair: size 12, align 1, packed\n"),
+			  std::string::npos);
+}
+
+TEST(LibToyccTest, UnknownStructMember)
+{
+	constexpr std::string_view source =
+		"struct pair { int a; int b; };\n"
+		"int get(struct pair* s)\n"
+		"{\n"
+		"\treturn s->c;\n"
+		"}\n";
+
+	auto result = compile_ir(source);
+	EXPECT_FALSE(result.success);
+	ASSERT_FALSE(result.diagnostics.empty());
+	EXPECT_EQ(result.diagnostics.front().line, 4);
+	EXPECT_NE(result.diagnostics.front().message.find(
+				  "No member named 'c' in 'struct pair'"),
+			  std::string::npos);
+}
+
+TEST(LibToyccTest, EvalFunctionFolding)
+{
+	constexpr std::string_view source =
+		"eval int fib(int n)\n"
+		"{\n"
+		"\tint a = 0;\n"
+		"\tint b = 1;\n"
+		"\tfor (int i = 0; i < n; i = i + 1) {\n"
+		"\t\tint t = a + b;\n"
+		"\t\ta = b;\n"
+		"\t\tb = t;\n"
+		"\t}\n"
+		"\treturn a;\n"
+		"}\n"
+		"eval int fact(int n)\n"
+		"{\n"
+		"\tif (n <= 1)\n"
+		"\t\treturn 1;\n"
+		"\treturn n * fact(n - 1);\n"
+		"}\n"
+		"int table_size = fib(20);\n"
+		"int fact_5 = fact(5);\n"
+		"int mixed = fib(10) + fact(5) * 2;\n"
+		"int get(int n)\n"
+		"{\n"
+		"\teval int limit = fact(5);\n"
+		"\treturn limit + fib(n);\n"
+		"}\n";
+
+	// 全局变量的初始值只能是常量, eval常量的初始值同样如此;
+	// 实参不是常量的调用在运行时进行
+	auto result = compile_ir(source);
+	ASSERT_TRUE(result.success);
+	EXPECT_TRUE(result.diagnostics.empty());
+	EXPECT_EQ(get_global_int(result.output, "table_size"), 6765);
+	EXPECT_EQ(get_global_int(result.output, "fact_5"), 120);
+	EXPECT_EQ(get_global_int(result.output, "mixed"), 295);
+}
+
+TEST(LibToyccTest, EvalStepLimit)
+{
+	constexpr std::string_view source =
+		"eval int spin(int n)\n"
+		"{\n"
+		"\twhile (n > 0) n = n;\n"
+		"\treturn n;\n"
+		"}\n"
+		"int value = spin(1);\n";
+
+	CompileOptions options;
+	options.eval_step_limit = 1000;
+
+	auto result = compile_ir(source, options);
+	EXPECT_FALSE(result.success);
+	ASSERT_EQ(result.diagnostics.size(), 2);
+	EXPECT_EQ(result.diagnostics[0].kind, Diagnostic::error);
+	EXPECT_EQ(result.diagnostics[0].line, 6);
+	EXPECT_EQ(result.diagnostics[1].kind, Diagnostic::note);
+	EXPECT_EQ(result.diagnostics[1].line, 3);
+	EXPECT_NE(result.diagnostics[1].message.find(
+				  "exceeded the limit of 1000 steps"),
+			  std::string::npos);
+}
+
+TEST(LibToyccTest, EvalFoldBudget)
+{
+	constexpr std::string_view source =
+		"eval int count(int n)\n"
+		"{\n"
+		"\tint i = 0;\n"
+		"\twhile (i < n) i = i + 1;\n"
+		"\treturn i;\n"
+		"}\n"
+		"int total = count(10000);\n"
+		"int run()\n"
+		"{\n"
+		"\treturn count(20000) + count(20000);\n"
+		"}\n";
+
+	// 常量上下文使用完整的上限; 普通代码中的折叠超出较小的上限时在运行时调用,
+	// 相同实参的失败只报告一次
+	auto result = compile_ir(source);
+	ASSERT_TRUE(result.success);
+	EXPECT_EQ(get_global_int(result.output, "total"), 10000);
+	ASSERT_EQ(result.diagnostics.size(), 1);
+	EXPECT_EQ(result.diagnostics[0].kind, Diagnostic::remark);
+	EXPECT_EQ(result.diagnostics[0].line, 10);
+	EXPECT_NE(result.diagnostics[0].message.find("is not folded"),
+			  std::string::npos);
+}
@@ -0,0 +1,202 @@
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <llvm/CodeGen/CommandFlags.h>
+#include <llvm/MC/TargetRegistry.h>
+#include <llvm/Support/raw_ostream.h>
+#include <llvm/Target/TargetMachine.h>
+#include <llvm/TargetParser/Host.h>
+#include <llvm/TargetParser/Triple.h>
+#include <spdlog/sinks/null_sink.h>
+#include "driver.hpp"
+#include "codegen_context.hpp"
+#include "codegen_visitor.hpp"
+#include "conversion.hpp"
+
+using namespace toycc;
+
+namespace
+{
+
+/// 单次编译的结果
+struct CompileOutput
+{
+	bool success;
+	std::string ir;
+	std::size_t error_count;
+};
+
+auto create_target_machine() -> std::shared_ptr<llvm::TargetMachine>
+{
+	auto triple = llvm::Triple{llvm::sys::getDefaultTargetTriple()};
+	auto target_options =
+		llvm::codegen::InitTargetOptionsFromCodeGenFlags(triple);
+
+	std::string error_str;
+	auto target = llvm::TargetRegistry::lookupTarget(
+		llvm::codegen::getMArch(), triple, error_str);
+	if (!target)
+		return nullptr;
+
+	return std::shared_ptr<llvm::TargetMachine>(target->createTargetMachine(
+		triple.getTriple(), llvm::codegen::getCPUStr(),
+		llvm::codegen::getFeaturesStr(), target_options,
+		std::optional<llvm::Reloc::Model>{llvm::codegen::getRelocModel()}));
+}
+
+/// @brief 完整执行一次前端与中间代码生成, 所有状态都属于本次调用
+auto compile(const std::string& file) -> CompileOutput
+{
+	CompileOutput output { false, {}, 0 };
+
+	auto sink = std::make_shared<spdlog::sinks::null_sink_mt>();
+	auto front_logger = std::make_shared<spdlog::async_logger>(
+		"front", sink, spdlog::thread_pool(),
+		spdlog::async_overflow_policy::block);
+	auto backend_logger = std::make_shared<spdlog::async_logger>(
+		"backend", sink, spdlog::thread_pool(),
+		spdlog::async_overflow_policy::block);
+
+	llvm::SourceMgr src_mgr;
+	// 诊断信息不输出到终端
+	src_mgr.setDiagHandler([](const llvm::SMDiagnostic&, void*) {});
+
+	DriverFactory driver_factory { src_mgr, front_logger };
+	auto driver_or_error = driver_factory.produce_driver(file);
+	if (!driver_or_error)
+		return output;
+	auto driver = std::move(*driver_or_error);
+
+	auto parse_success = driver->parse();
+	auto counter = driver->get_diag_counter();
+	if (!parse_success)
+	{
+		output.error_count = counter->get(Location::dk_error);
+		return output;
+	}
+
+	auto tm = create_target_machine();
+	if (tm == nullptr)
+		return output;
+
+	auto cg_context = std::make_shared<CodeGenContext>(
+		std::make_shared<ConversionConfig>(), src_mgr, tm, backend_logger);
+	CodeGenVisitor visitor { cg_context };
+	auto ast = driver->get_ast_unique();
+	output.success = visitor.visit(ast.get());
+	output.error_count = counter->get(Location::dk_error);
+	if (!output.success)
+		return output;
+
+	auto module = visitor.get_result();
+	llvm::raw_string_ostream os { output.ir };
+	module->print(os, nullptr);
+	return output;
+}
+
+/// @brief 功能测试中的全部toycc源文件
+auto collect_sources() -> std::vector<std::string>
+{
+	std::vector<std::string> result;
+	for (const auto& entry :
+		 std::filesystem::directory_iterator { "test/func_test" })
+	{
+		auto path = entry.path() / "test.c";
+		if (std::filesystem::exists(path))
+			result.push_back(path.string());
+	}
+	std::ranges::sort(result);
+	return result;
+}
+
+}	//namespace
+
+TEST(PipelineTest, ConcurrentCompilationsMatchSerial)
+{
+	auto sources = collect_sources();
+	ASSERT_FALSE(sources.empty());
+
+	std::map<std::string, std::string> expected;
+	for (const auto& file : sources)
+	{
+		auto output = compile(file);
+		ASSERT_TRUE(output.success) << file;
+		expected[file] = std::move(output.ir);
+	}
+
+	constexpr std::size_t rounds = 4;
+	auto thread_count =
+		std::max<std::size_t>(4, std::thread::hardware_concurrency());
+
+	std::mutex mismatch_mutex;
+	std::vector<std::string> mismatches;
+	{
+		std::vector<std::jthread> threads;
+		for (std::size_t t = 0; t < thread_count; ++t)
+		{
+			threads.emplace_back([&, t] {
+				for (std::size_t r = 0; r < rounds; ++r)
+				{
+					// 每个线程从不同的位置开始, 使不同文件同时编译
+					for (std::size_t i = 0; i < sources.size(); ++i)
+					{
+						const auto& file = sources[(i + t) % sources.size()];
+						auto output = compile(file);
+						if (!output.success || output.ir != expected[file])
+						{
+							std::lock_guard lock { mismatch_mutex };
+							mismatches.push_back(file);
+						}
+					}
+				}
+			});
+		}
+	}
+
+	EXPECT_TRUE(mismatches.empty())
+		<< mismatches.size() << " concurrent compilations differ, first: "
+		<< mismatches.front();
+}
+
+TEST(PipelineTest, DiagCounterIsPerCompilation)
+{
+	auto bad_file =
+		(std::filesystem::temp_directory_path() / "toycc_pipeline_bad.c")
+			.string();
+	{
+		std::ofstream ofs { bad_file };
+		ofs << "int f()\n{\n\treturn undefined_a + undefined_b;\n}\n";
+	}
+	auto good_file = collect_sources().front();
+
+	constexpr std::size_t thread_count = 8;
+	std::vector<CompileOutput> outputs(thread_count);
+	{
+		std::vector<std::jthread> threads;
+		for (std::size_t t = 0; t < thread_count; ++t)
+		{
+			threads.emplace_back([&, t] {
+				outputs[t] = compile(t % 2 == 0 ? bad_file : good_file);
+			});
+		}
+	}
+
+	for (std::size_t t = 0; t < thread_count; ++t)
+	{
+		if (t % 2 == 0)
+		{
+			EXPECT_FALSE(outputs[t].success);
+			EXPECT_GT(outputs[t].error_count, 0);
+		}
+		else
+		{
+			EXPECT_TRUE(outputs[t].success);
+			EXPECT_EQ(outputs[t].error_count, 0);
+		}
+	}
+
+	std::filesystem::remove(bad_file);
+}